@@ -1,19 +1,29 @@
 #include "applicationcontroller.hpp"
 
 #include "benchmarks/api.hpp"
+#include "benchmarks/atomics.hpp"
 #include "benchmarks/blackscholes.hpp"
 #include "benchmarks/cfd.hpp"
+#include "benchmarks/divergence.hpp"
 #include "benchmarks/edge.hpp"
 #include "benchmarks/fft.hpp"
 #include "benchmarks/gemm.hpp"
+#include "benchmarks/histogram.hpp"
+#include "benchmarks/imagefilter.hpp"
 #include "benchmarks/kmeans.hpp"
 #include "benchmarks/memory.hpp"
+#include "benchmarks/montecarlo.hpp"
+#include "benchmarks/reduction.hpp"
+#include "benchmarks/scan.hpp"
+#include "benchmarks/sort.hpp"
 #include "benchmarks/spmv.hpp"
 #include "benchmarks/stencil.hpp"
+#include "benchmarks/stream.hpp"
 #include "benchmarks/streamcluster.hpp"
 #include "benchmarks/transpose.hpp"
 #include "benchmarks/vecop.hpp"
 
+#include <cstdlib>
 #include <iostream>
 
 using namespace std;
@@ -21,16 +31,25 @@ using namespace std;
 static const char* HELP_TEXT = "OpenCL Benchmark-Collection\n"
             "Author: Michael Eiler <eiler.mike@gmail.com>\n\n"
             "  --run-<benchmark> executes only the selected benchmarks, available benchmarks are:\n\n"
-            "    api, blackscholes, cfd, edge, fft, gemm, kmeans, memory, spmv, stencil, streamcluster, transpose, vecop\n\n"
+            "    api, atomics, blackscholes, cfd, divergence, edge, fft, gemm, histogram, imagefilter,\n"
+            "    kmeans, memory, montecarlo, reduction, scan, sort, spmv, stencil, stream,\n"
+            "    streamcluster, transpose, vecop\n\n"
             "  --opt-disable disable all optimizations (-cl-mad-enable is passed to the compiler by default)\n"
             "  --opt-speed enables additional otimizations (-cl-fast-relaxed-math and -cl-no-signed-zeros)\n"
+            "  --validate=<none|sampled|full> compares the results with a host reference, a mismatch marks the\n"
+            "    test as INVALID (default: sampled)\n"
+            "  --image=<file> input image of the edge benchmark: binary PGM/PPM or raw 32 bit floats with the size\n"
+            "    in the file name (e.g. scene_7680x4320.raw), default: data/edge/image.pgm or .ppm if present\n"
+            "  --latency-stride=<bytes> distance between the loads of the memory latency test, a multiple of 4\n"
+            "    (default: 128 and 4096, one load per cache line and one per page)\n"
             "  --save-binaries stores all compiled cl-files (programs) in the execution directory\n"
             "  --verbose / -v prints more platform and device information\n"
             "  --help / -h prints this information\n";
 
 ApplicationController::ApplicationController()
     : _tests()
-    , _runSpecificTests() {
+    , _runSpecificTests()
+    , _inputImage() {
 
 }
 
@@ -55,21 +74,33 @@ void ApplicationController::CreateTestInstance(const std::string& name) {
         auto test = make_shared<TClass>(_controller);
         test->RequestDisableOptimization(_disableOptimization);
         test->RequestOptimizationForSpeed(_optimizeForSpeed);
+        test->RequestValidationMode(_validationMode);
+        test->RequestInputImage(_inputImage);
+        test->RequestLatencyStride(_latencyStride);
         _tests.push_back(test);
     }
 }
 
 void ApplicationController::CreateAndExecuteTests() {
     CreateTestInstance<benchmarks::Api>("api");
+    CreateTestInstance<benchmarks::Atomics>("atomics");
     CreateTestInstance<benchmarks::BlackScholes>("blackscholes");
     CreateTestInstance<benchmarks::Cfd>("cfd");
+    CreateTestInstance<benchmarks::Divergence>("divergence");
     CreateTestInstance<benchmarks::Edge>("edge");
     CreateTestInstance<benchmarks::Fft>("fft");
     CreateTestInstance<benchmarks::Gemm>("gemm");
+    CreateTestInstance<benchmarks::Histogram>("histogram");
+    CreateTestInstance<benchmarks::ImageFilter>("imagefilter");
     CreateTestInstance<benchmarks::KMeans>("kmeans");
     CreateTestInstance<benchmarks::Memory>("memory");
+    CreateTestInstance<benchmarks::MonteCarlo>("montecarlo");
+    CreateTestInstance<benchmarks::Reduction>("reduction");
+    CreateTestInstance<benchmarks::Scan>("scan");
+    CreateTestInstance<benchmarks::Sort>("sort");
     CreateTestInstance<benchmarks::Spmv>("spmv");
     CreateTestInstance<benchmarks::Stencil>("stencil");
+    CreateTestInstance<benchmarks::Stream>("stream");
     CreateTestInstance<benchmarks::StreamCluster>("streamcluster");
     CreateTestInstance<benchmarks::Transpose>("transpose");
     CreateTestInstance<benchmarks::Vecop>("vecop");
@@ -96,6 +127,32 @@ int ApplicationController::Run(int argc, char** argv) {
         if (argument == "--opt-speed") {
             _optimizeForSpeed = true;
         }
+        if (argument.find("--validate=") == 0) {
+            string mode = argument.substr(11);
+            if (mode == "none") {
+                _validationMode = benchmarks::ValidationMode::None;
+            } else if (mode == "sampled") {
+                _validationMode = benchmarks::ValidationMode::Sampled;
+            } else if (mode == "full") {
+                _validationMode = benchmarks::ValidationMode::Full;
+            } else {
+                cerr << "Unknown validation mode: " << mode << endl;
+                cout << HELP_TEXT;
+                return 1;
+            }
+        }
+        if (argument.find("--image=") == 0) {
+            _inputImage = argument.substr(8);
+        }
+        if (argument.find("--latency-stride=") == 0) {
+            char* end = nullptr;
+            _latencyStride = strtoul(argument.c_str() + 17, &end, 10);
+            if (*end != '\0' || _latencyStride == 0 || _latencyStride % 4 != 0) {
+                cerr << "Invalid latency stride: " << argument.substr(17) << endl;
+                cout << HELP_TEXT;
+                return 1;
+            }
+        }
         if (argument == "--save-binaries") {
             saveBinaries = true;
         }
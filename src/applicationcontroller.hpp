@@ -22,6 +22,9 @@ private:
 
     bool _optimizeForSpeed = false;
     bool _disableOptimization = false;
+    benchmarks::ValidationMode _validationMode = benchmarks::ValidationMode::Sampled;
+    std::string _inputImage;
+    size_t _latencyStride = 0;
 
     /**
      * Create a tests if it was selected by a specific argument when
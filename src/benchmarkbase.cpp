@@ -3,11 +3,19 @@
 #include "clglobal.hpp"
 #include "computecontroller.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
 
 using namespace benchmarks;
 using namespace std;
 
+static const int64_t VALIDATION_SAMPLES = 4096;
+static const int VALIDATION_SEED = 85733;
+
 BenchmarkBase::BenchmarkBase(std::shared_ptr<ComputeController> controller)
     : _controller(controller)
     , _timer()
@@ -15,7 +23,10 @@ BenchmarkBase::BenchmarkBase(std::shared_ptr<ComputeController> controller)
     , _gpuStatistics()
     , _requestedWorkGroupSize(-1)
     , _optimizeForSpeed(false)
-    , _disableOptimization(false) {
+    , _disableOptimization(false)
+    , _validationMode(ValidationMode::Sampled)
+    , _inputImage()
+    , _latencyStride(0) {
 
 }
 
@@ -74,6 +85,67 @@ void BenchmarkBase::PerformTest(function<void(cl::Event&)> testFunction, const s
         << "), GPU: " << _gpuStatistics.Mean() << " (+/- " << _gpuStatistics.Deviation<int64_t>() << ")" << endl;
 }
 
+void BenchmarkBase::PerformMultiPassTest(function<void(vector<cl::Event>&)> testFunction, const string& testName, const int iterations) {
+    _cpuStatistics.Clear();
+    _gpuStatistics.Clear();
+
+    for (int i = 0; i < iterations; ++i) {
+        vector<cl::Event> events;
+        cl_ulong startTime, endTime;
+
+        _timer.Remember();
+
+        testFunction(events);
+
+        if (events.empty())
+            return;
+
+        events.back().wait();
+        _cpuStatistics.Add(_timer.Diff());
+
+        // the queue is in-order, so the first command starts first and the last one finishes last
+        events.front().getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+        events.back().getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+        _gpuStatistics.Add(endTime - startTime);
+    }
+
+    cout << testName << " CPU: " << _cpuStatistics.Mean() << " (+/- " << _cpuStatistics.Deviation<int64_t>() 
+        << "), GPU: " << _gpuStatistics.Mean() << " (+/- " << _gpuStatistics.Deviation<int64_t>() << ")" << endl;
+}
+
+double BenchmarkBase::DeviceCopyBandwidth(size_t bytes) {
+    static const int COPY_ITERATIONS = 10;
+
+    cl_int status = CL_SUCCESS;
+    cl::Buffer source(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
+    if (status != CL_SUCCESS)
+        return 0.0;
+    cl::Buffer target(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
+    if (status != CL_SUCCESS)
+        return 0.0;
+
+    cl::CommandQueue& queue = _controller->Queue();
+    Statistics<int64_t> statistics;
+    cl_ulong startTime, endTime;
+
+    // the first copy is not timed, it allocates the buffers on the device
+    for (int i = -1; i < COPY_ITERATIONS; ++i) {
+        cl::Event event;
+        status = queue.enqueueCopyBuffer(source, target, 0, 0, bytes, nullptr, &event);
+        if (status != CL_SUCCESS || event.wait() != CL_SUCCESS)
+            return 0.0;
+
+        if (i < 0)
+            continue;
+
+        event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+        event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+        statistics.Add(endTime - startTime);
+    }
+
+    return statistics.Min() > 0 ? 2.0 * bytes / statistics.Min() : 0.0;
+}
+
 int BenchmarkBase::RoundToPowerOf2(int i, int powerOf2) {
     int bitmask = powerOf2 - 1;  // 001000 -> 000111
     int remaining = i & bitmask;
@@ -84,6 +156,73 @@ int BenchmarkBase::RoundToMultipleOf(int i, int p) {
     return i + ((p - (i%p)) % p);
 }
 
+void BenchmarkBase::ParallelFor(int64_t count, function<void(int64_t, int64_t)> body) {
+    const int64_t threadCount = min<int64_t>(max(1u, thread::hardware_concurrency()), max<int64_t>(count, 1));
+    const int64_t chunkSize = (count + threadCount - 1) / threadCount;
+
+    vector<thread> threads;
+    for (int64_t t = 1; t < threadCount; ++t) {
+        const int64_t begin = t * chunkSize;
+        const int64_t end = min(count, begin + chunkSize);
+        if (begin < end)
+            threads.push_back(thread(body, begin, end));
+    }
+
+    // the calling thread processes the first chunk
+    body(0, min(count, chunkSize));
+
+    for (auto& worker : threads)
+        worker.join();
+}
+
+bool BenchmarkBase::Validate(const string& testName, int64_t count, function<bool(int64_t)> matches) {
+    if (_validationMode == ValidationMode::None)
+        return true;
+
+    // sampled mode: first, last and pseudo-random indices, fixed seed so that reruns check the same values
+    vector<int64_t> indices;
+    if (_validationMode == ValidationMode::Sampled && count > VALIDATION_SAMPLES) {
+        default_random_engine randomEngine(VALIDATION_SEED);
+        uniform_int_distribution<int64_t> indexDistribution(0, count - 1);
+
+        indices.push_back(0);
+        indices.push_back(count - 1);
+        while (static_cast<int64_t>(indices.size()) < VALIDATION_SAMPLES)
+            indices.push_back(indexDistribution(randomEngine));
+    }
+
+    const int64_t checked = indices.empty() ? count : static_cast<int64_t>(indices.size());
+    int64_t failures = 0;
+    int64_t firstFailure = count;
+    mutex resultMutex;
+
+    ParallelFor(checked, [&](int64_t begin, int64_t end) -> void {
+            int64_t localFailures = 0;
+            int64_t localFirstFailure = count;
+
+            for (int64_t j = begin; j < end; ++j) {
+                const int64_t i = indices.empty() ? j : indices[j];
+                if (!matches(i)) {
+                    ++localFailures;
+                    localFirstFailure = min(localFirstFailure, i);
+                }
+            }
+
+            lock_guard<mutex> lock(resultMutex);
+            failures += localFailures;
+            firstFailure = min(firstFailure, localFirstFailure);
+        });
+
+    if (failures == 0) {
+        cout << "  validation " << testName << ": passed (" << checked << " of " << count << " values checked)" << endl;
+        return true;
+    }
+
+    cout << "  INVALID " << testName << ": " << failures << " of " << checked
+        << " checked values differ from the host reference, first at index " << firstFailure << endl;
+    return false;
+}
+
 void BenchmarkBase::RequestWorkGroupSize(int workGroupSize) {
     _requestedWorkGroupSize = workGroupSize;
 }
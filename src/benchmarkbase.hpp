@@ -4,10 +4,15 @@
 #include "statistics.hpp"
 #include "timer.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
+#include <type_traits>
 #include <typeinfo>
+#include <vector>
 
 class ComputeController;
 
@@ -20,6 +25,12 @@ namespace cl {
 
 namespace benchmarks {
 
+/**
+ * Selects how results are compared with the host reference.
+ * Sampled checks a fixed set of pseudo-random indices, Full checks every value.
+ */
+enum class ValidationMode { None, Sampled, Full };
+
 /**
  * This class provides base functionallity shared by all benchmarks.
  */
@@ -38,6 +49,12 @@ protected:
     bool _optimizeForSpeed;
     bool _disableOptimization;
 
+    ValidationMode _validationMode;
+
+    std::string _inputImage;
+
+    size_t _latencyStride;
+
     template <typename TItem>
     std::string GetCompilerFlags() { return GetCompilerFlagsInternal(typeid(TItem)); }
 
@@ -59,6 +76,22 @@ protected:
      */
     void PerformTest(std::function<void(cl::Event&)> testFunction, const std::string& testName, const int iterations);
 
+    /**
+     * Like PerformTest() for tests which consist of several commands (e.g. the passes of a scan).
+     * The GPU time reaches from the start of the first to the end of the last event.
+     *
+     * @param testFunction enqueues the commands, every timed command has to add its event to the vector
+     */
+    void PerformMultiPassTest(std::function<void(std::vector<cl::Event>&)> testFunction, const std::string& testName, const int iterations);
+
+    /**
+     * Measures a device to device copy (enqueueCopyBuffer) of the given size. It serves as memory roof
+     * for bandwidth bound kernels.
+     *
+     * @return bandwidth in GB/s, counting the read and the write, 0 if the buffers can not be allocated
+     */
+    double DeviceCopyBandwidth(size_t bytes);
+
     int RoundToPowerOf2(int i, int powerOf2);
 
     /**
@@ -69,6 +102,81 @@ protected:
      * @return i + ((p - (i%p)) % p)
      */
     int RoundToMultipleOf(int i, int p);
+
+    /**
+     * Splits [0, count) into one contiguous range per hardware thread and processes them in parallel.
+     * Used for host side reference computations which would otherwise dominate the runtime.
+     *
+     * @param count number of items
+     * @param body function processing the items [begin, end)
+     */
+    static void ParallelFor(int64_t count, std::function<void(int64_t begin, int64_t end)> body);
+
+    /**
+     * @return false if the user disabled validation, host references should not be computed then
+     */
+    bool ValidationEnabled() const { return _validationMode != ValidationMode::None; }
+
+    /**
+     * Default tolerance used to compare device results with a host reference.
+     * Integer results have to match exactly.
+     */
+    template <typename TItem>
+    static double ValidationTolerance() {
+        return std::is_integral<TItem>::value ? 0.0 : (sizeof(TItem) == sizeof(float) ? 1e-4 : 1e-10);
+    }
+
+    /**
+     * Tolerance for results which went through a chain of dependent floating point operations.
+     * Every operation may add one rounding error, so the bound grows with the length of the chain.
+     *
+     * @param operations longest chain of roundings which contributes to a single result
+     */
+    template <typename TItem>
+    static double AccumulatedTolerance(int64_t operations) {
+        if (std::is_integral<TItem>::value)
+            return 0.0;
+        return std::max(ValidationTolerance<TItem>(), operations * static_cast<double>(std::numeric_limits<TItem>::epsilon()));
+    }
+
+    /**
+     * Relative comparison, absolute for values smaller than one. NaN never matches.
+     */
+    template <typename TItem>
+    static bool WithinTolerance(TItem actual, TItem expected, double tolerance) {
+        if (actual == expected)
+            return true;
+
+        const double difference = std::abs(static_cast<double>(actual) - static_cast<double>(expected));
+        return tolerance > 0.0 && difference <= tolerance * std::max(1.0, std::abs(static_cast<double>(expected)));
+    }
+
+    /**
+     * Checks the results of a test according to the selected ValidationMode and prints the outcome.
+     * A mismatch marks the test as INVALID in the output. The indices are checked in parallel,
+     * so the function has to be thread-safe.
+     *
+     * @param testName printed together with the outcome
+     * @param count number of results
+     * @param matches returns true if result i is correct
+     * @return true if all checked results are correct or validation is disabled
+     */
+    bool Validate(const std::string& testName, int64_t count, std::function<bool(int64_t i)> matches);
+
+    /**
+     * Compares device results with a host reference, see Validate().
+     *
+     * @param results values read back from the device
+     * @param reference returns the expected value of result i
+     * @param tolerance see WithinTolerance()
+     */
+    template <typename TItem, typename TReference>
+    bool ValidateResults(const std::string& testName, const TItem* results, int64_t count, TReference reference,
+                         double tolerance = ValidationTolerance<TItem>()) {
+        return Validate(testName, count, [&](int64_t i) -> bool {
+                return WithinTolerance(results[i], static_cast<TItem>(reference(i)), tolerance);
+            });
+    }
 public:
     explicit BenchmarkBase(std::shared_ptr<ComputeController> controller);
     virtual ~BenchmarkBase();
@@ -83,6 +191,21 @@ public:
      */
     void RequestOptimizationForSpeed(bool speed) { _optimizeForSpeed = speed; }
 
+    /**
+     * Selects whether and how thoroughly results are checked against a host reference.
+     */
+    void RequestValidationMode(ValidationMode mode) { _validationMode = mode; }
+
+    /**
+     * Image file used as input by the image processing benchmarks instead of their default data.
+     */
+    void RequestInputImage(const std::string& path) { _inputImage = path; }
+
+    /**
+     * Distance in bytes between two elements of the memory latency test, zero selects the default strides.
+     */
+    void RequestLatencyStride(size_t stride) { _latencyStride = stride; }
+
     /**
      * Sets the preferred work-group size for a benchmark.
      * Still depends on the actual benchmark whether it uses the suggestion.
@@ -0,0 +1,141 @@
+#include "atomics.hpp"
+
+#include <iostream>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int GLOBAL_WORK_ITEMS = 64 * 1024;
+static const int OPERATIONS_PER_WORK_ITEM = 4;
+static const int ITERATIONS = 10;
+
+// number of distinct counters, from full contention to one counter per work-item,
+// all of them divide WORK_GROUP_SIZE or are multiples of it
+static const int ADDRESSES[] = { 1, 8, 64, 256, 4096, GLOBAL_WORK_ITEMS };
+
+Atomics::Atomics(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller) {
+
+}
+
+Atomics::~Atomics() {
+
+}
+
+template <typename TItem>
+int Atomics::InitContext() {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "atomics.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    cl_int status = CL_SUCCESS;
+    _counterBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, GLOBAL_WORK_ITEMS * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+template <typename TItem>
+void Atomics::RunInternal(const string& operation) {
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::NDRange global(GLOBAL_WORK_ITEMS);
+    cl::NDRange local(WORK_GROUP_SIZE);
+    const double operationsPerLaunch = static_cast<double>(GLOBAL_WORK_ITEMS) * OPERATIONS_PER_WORK_ITEM;
+
+    vector<bool> correct;
+    vector<TItem> counters(GLOBAL_WORK_ITEMS);
+
+    for (const string memory : { "Global", "Local" }) {
+        cl_int status = CL_SUCCESS;
+        cl::Kernel kernel(*_program, (operation + memory).c_str(), &status);
+        CHECK(status);
+
+        kernel.setArg(0, *_counterBuffer);
+        kernel.setArg(2, OPERATIONS_PER_WORK_ITEM);
+
+        for (auto& addresses : ADDRESSES) {
+            // a work-group can not privatize more counters than it has work-items
+            if (memory == "Local" && addresses > WORK_GROUP_SIZE)
+                continue;
+
+            kernel.setArg(1, addresses);
+
+            const string testName = "  " + operation + memory + ", " + to_string(addresses) + " address(es)";
+
+            // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+            PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                    events.resize(1);
+                    status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+                    if (status != CL_SUCCESS)
+                        events.clear();
+                }, testName + ",", ITERATIONS);
+            CHECK(status);
+
+            const int64_t timeGPU = _gpuStatistics.Mean();
+            cout << testName << ": " << (timeGPU > 0 ? 1000.0 * operationsPerLaunch / timeGPU : 0.0) << " Mops/s" << endl;
+
+            if (!ValidationEnabled())
+                continue;
+
+            // one execution on zeroed counters, every counter is incremented by all work-items mapped to it
+            queue.enqueueFillBuffer(*_counterBuffer, static_cast<TItem>(0), 0, GLOBAL_WORK_ITEMS * sizeof(TItem));
+            status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local);
+            CHECK(status);
+            queue.enqueueReadBuffer(*_counterBuffer, CL_TRUE, 0, addresses * sizeof(TItem), &counters[0]);
+
+            const TItem expected = static_cast<TItem>((GLOBAL_WORK_ITEMS / addresses) * OPERATIONS_PER_WORK_ITEM);
+            bool countersCorrect = true;
+            for (int i = 0; i < addresses; ++i)
+                countersCorrect = countersCorrect && counters[i] == expected;
+            correct.push_back(countersCorrect);
+        }
+    }
+
+    Validate(operation, static_cast<int64_t>(correct.size()), [&](int64_t i) -> bool {
+            return correct[i];
+        });
+}
+
+void Atomics::Cleanup() {
+    _counterBuffer.reset();
+    _program.reset();
+}
+
+void Atomics::Run() {
+    cout << "Atomics (" << GLOBAL_WORK_ITEMS << " work-items, " << OPERATIONS_PER_WORK_ITEM << " operations each):" << endl;
+
+    cout << "Atomics<int>" << endl;
+    if (InitContext<cl_int>() == 0) {
+        RunInternal<cl_int>("AtomicAdd");
+        RunInternal<cl_int>("AtomicInc");
+        RunInternal<cl_int>("AtomicCmpxchg");
+    }
+    Cleanup();
+
+    if (_controller->HasExtension("cl_khr_int64_base_atomics")) {
+        cout << "Atomics<long>" << endl;
+        if (InitContext<cl_long>() == 0) {
+            RunInternal<cl_long>("AtomicAdd");
+            RunInternal<cl_long>("AtomicInc");
+            RunInternal<cl_long>("AtomicCmpxchg");
+        }
+        Cleanup();
+    }
+
+    // float additions are emulated with atomic_cmpxchg, the counts stay below 2^24 and are exact
+    cout << "Atomics<float>" << endl;
+    if (InitContext<float>() == 0)
+        RunInternal<float>("AtomicAdd");
+    Cleanup();
+
+    cout << endl;
+}
@@ -0,0 +1,56 @@
+#ifndef __BENCH_BENCHMARKS_ATOMICS_HPP
+#define __BENCH_BENCHMARKS_ATOMICS_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+
+namespace benchmarks {
+
+/**
+ * Throughput of atomic operations (add, inc and cmpxchg) on global and local memory.
+ * The contention is controlled by the number of distinct addresses the work-items update,
+ * from one address for all work-items down to one address per work-item. The local memory
+ * kernels use privatization: per work-group copies which are merged into global memory at the end.
+ */
+class Atomics : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _counterBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    /**
+     * Compiles the kernels for TItem and allocates the counters.
+     */
+    template <typename TItem>
+    int InitContext();
+
+    /**
+     * Executes the global and the local (privatized) variant of an operation for all contention levels
+     * and prints the throughput. The counters are validated after one additional execution per level.
+     *
+     * @param operation kernel name without the Global/Local suffix (e.g. AtomicAdd)
+     */
+    template <typename TItem>
+    void RunInternal(const std::string& operation);
+
+    /**
+     * Release the counters and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Atomics(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Atomics();
+
+    /**
+     * Execute the tests for int, long (if cl_khr_int64_base_atomics is supported) and float (emulated add).
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_ATOMICS_HPP
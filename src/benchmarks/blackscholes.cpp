@@ -1,9 +1,13 @@
 #include "blackscholes.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <random>
+#include <type_traits>
 
 #include "../clglobal.hpp"
 #include "../computecontroller.hpp"
@@ -12,11 +16,43 @@ using namespace benchmarks;
 using namespace std;
 
 static const int RANDOM_SEED = 85733;
-static const int SAMPLES = 256 * 256 * 1024;//64;
+static const int OPTION_COUNT = 1 << 23;        // generated options, 448 MiB of buffers in double precision
 static const int TEST_ITERATIONS = 100;
+static const string OPTION_FILE = "blackscholes/options.txt";
+
+// parameter ranges of the generated options
+static const double SPOT_MIN = 10.0, SPOT_MAX = 200.0;
+static const double MONEYNESS_MIN = 0.7, MONEYNESS_MAX = 1.3;     // strike / spot
+static const double TIME_MIN = 1.0 / 52.0, TIME_MAX = 5.0;        // one week to five years
+static const double RATE_MIN = 0.0, RATE_MAX = 0.08;
+static const double VOLATILITY_MIN = 0.1, VOLATILITY_MAX = 0.6;
+
+// single precision errors are around 1e-5 of the price (log(S / K) is amplified by 1 / (sigma * sqrt(T))),
+// -cl-mad-enable and relaxed math increase them
+static const double FLOAT_TOLERANCE = 1e-3;
+
+// host reference of blackscholes.cl in double precision
+static double ReferenceCND(double x) {
+    return 0.5 * erfc(-x * 0.70710678118654752440);
+}
+
+static void ReferencePrices(double S, double K, double T, double R, double sigma, double& call, double& put) {
+    const double sigmaSqrtT = sigma * sqrt(T);
+    const double d1 = (log(S / K) + (R + 0.5 * sigma * sigma) * T) / sigmaSqrtT;
+    const double d2 = d1 - sigmaSqrtT;
+    const double KexpMinusRT = K * exp(-R * T);
+
+    call = S * ReferenceCND(d1) - KexpMinusRT * ReferenceCND(d2);
+    put = KexpMinusRT * ReferenceCND(-d2) - S * ReferenceCND(-d1);
+}
 
 BlackScholes::BlackScholes(std::shared_ptr<ComputeController> controller)
-    : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _spot()
+    , _strike()
+    , _time()
+    , _rate()
+    , _volatility() {
 
 }
 
@@ -24,8 +60,87 @@ BlackScholes::~BlackScholes() {
 
 }
 
+void BlackScholes::LoadOptions() {
+    if (LoadOptionFile(CL_DATA_PATH_PREFIX + OPTION_FILE))
+        cout << "BlackScholes: " << _optionCount << " options from " << OPTION_FILE << endl;
+    else
+        GenerateOptions();
+
+    // the padding repeats the last option, its prices are computed but not validated or counted
+    _paddedCount = RoundToMultipleOf(_optionCount, 4);
+    _spot.resize(_paddedCount, _spot.back());
+    _strike.resize(_paddedCount, _strike.back());
+    _time.resize(_paddedCount, _time.back());
+    _rate.resize(_paddedCount, _rate.back());
+    _volatility.resize(_paddedCount, _volatility.back());
+}
+
+bool BlackScholes::LoadOptionFile(const string& path) {
+    ifstream fileStream(path, ios::in);
+    if (!fileStream.is_open())
+        return false;
+
+    int64_t count = 0;
+    fileStream >> count;
+    if (!fileStream.good() || count <= 0 || count > numeric_limits<int>::max() - 4) {
+        cerr << "BlackScholes: invalid option count in " << path << endl;
+        return false;
+    }
+
+    _spot.resize(count);
+    _strike.resize(count);
+    _time.resize(count);
+    _rate.resize(count);
+    _volatility.resize(count);
+
+    for (int64_t i = 0; i < count; ++i) {
+        double dividendRate = 0.0, dividendValue = 0.0, referenceValue = 0.0;
+        string type;
+        fileStream >> _spot[i] >> _strike[i] >> _rate[i] >> dividendRate >> _volatility[i] >> _time[i]
+            >> type >> dividendValue >> referenceValue;
+
+        if (fileStream.fail() || _spot[i] <= 0.0 || _strike[i] <= 0.0 || _time[i] <= 0.0 || _volatility[i] <= 0.0) {
+            cerr << "BlackScholes: invalid option " << i << " in " << path << endl;
+            _spot.clear();
+            _strike.clear();
+            _time.clear();
+            _rate.clear();
+            _volatility.clear();
+            return false;
+        }
+    }
+
+    _optionCount = static_cast<int>(count);
+    return true;
+}
+
+void BlackScholes::GenerateOptions() {
+    _optionCount = OPTION_COUNT;
+    _spot.resize(_optionCount);
+    _strike.resize(_optionCount);
+    _time.resize(_optionCount);
+    _rate.resize(_optionCount);
+    _volatility.resize(_optionCount);
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<double> spotDistribution(SPOT_MIN, SPOT_MAX);
+    uniform_real_distribution<double> moneynessDistribution(MONEYNESS_MIN, MONEYNESS_MAX);
+    uniform_real_distribution<double> timeDistribution(TIME_MIN, TIME_MAX);
+    uniform_real_distribution<double> rateDistribution(RATE_MIN, RATE_MAX);
+    uniform_real_distribution<double> volatilityDistribution(VOLATILITY_MIN, VOLATILITY_MAX);
+
+    for (int i = 0; i < _optionCount; ++i) {
+        _spot[i] = spotDistribution(randomEngine);
+        _strike[i] = _spot[i] * moneynessDistribution(randomEngine);
+        _time[i] = timeDistribution(randomEngine);
+        _rate[i] = rateDistribution(randomEngine);
+        _volatility[i] = volatilityDistribution(randomEngine);
+    }
+}
+
+template <typename TItem>
 int BlackScholes::InitContext() {
-    string compilerParams = GetCompilerFlags<float>();
+    string compilerParams = GetCompilerFlags<TItem>();
     _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "blackscholes.cl", compilerParams);
 
     if (_program.get() == nullptr)
@@ -37,7 +152,6 @@ int BlackScholes::InitContext() {
     _vectorizedKernel = make_shared<cl::Kernel>(*_program, "blackScholes", &status);
     CHECK_RETURN_ERROR(status);
 
-    // decide upon 2d-work-group size
     size_t scalarMaxWorkGroupSize = 0;
     status = _scalarKernel->getWorkGroupInfo(_controller->SelectedDevice(), CL_KERNEL_WORK_GROUP_SIZE, &scalarMaxWorkGroupSize);
     CHECK_RETURN_ERROR(status);
@@ -45,84 +159,127 @@ int BlackScholes::InitContext() {
     status = _vectorizedKernel->getWorkGroupInfo(_controller->SelectedDevice(), CL_KERNEL_WORK_GROUP_SIZE, &vectorizedMaxWorkGroupSize);
     CHECK_RETURN_ERROR(status);
 
-    int maxWorkGroupSize = static_cast<int>(min(scalarMaxWorkGroupSize, vectorizedMaxWorkGroupSize));
-    maxWorkGroupSize = min(_requestedWorkGroupSize, maxWorkGroupSize);
-
-    _blockSizeX = 1;
-    _blockSizeY = 1;
-
-    while ( (2 * _blockSizeX * _blockSizeY) <= maxWorkGroupSize) {
-        _blockSizeX <<= 1;
-        if ((2 * _blockSizeX * _blockSizeY) <= maxWorkGroupSize)
-            _blockSizeY <<= 1;
-    }
-    cout << "Work-Group-Size: " << _blockSizeX << "*" << _blockSizeY << endl;
+    _workGroupSize = static_cast<int>(min(scalarMaxWorkGroupSize, vectorizedMaxWorkGroupSize));
+    _workGroupSize = min(_requestedWorkGroupSize, _workGroupSize);
+    cout << "Work-Group-Size: " << _workGroupSize << endl;
 
     return 0;
 }
 
-void BlackScholes::InitData() {
-    _samples = SAMPLES / 4;
-    _samples = RoundToMultipleOf(_samples, _requestedWorkGroupSize);
-
-    int side = static_cast<int>(sqrt(_samples));
-    side = RoundToMultipleOf(side, _requestedWorkGroupSize);
-    _samples = side * side;
-    _height = _width = side;
-
-    _randBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY, _samples * sizeof(cl_float4));
-    _callPriceBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_WRITE_ONLY, _samples * sizeof(cl_float4));
-    _putPriceBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_WRITE_ONLY, _samples * sizeof(cl_float4));
+template <typename TItem>
+int BlackScholes::InitData() {
+    const size_t bytes = _paddedCount * sizeof(TItem);
+    const cl::Context& context = _controller->Context();
+    cl::CommandQueue& queue = _controller->Queue();
+    vector<TItem> converted(_paddedCount);
 
-    default_random_engine randomEngine(RANDOM_SEED);
-    uniform_real_distribution<float> valueDistribution(0.0, 1.0);
+    cl_int status = CL_SUCCESS;
+    for (auto input : { make_pair(&_spotBuffer, &_spot), make_pair(&_strikeBuffer, &_strike), make_pair(&_timeBuffer, &_time),
+            make_pair(&_rateBuffer, &_rate), make_pair(&_volatilityBuffer, &_volatility) }) {
+        *input.first = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, bytes, nullptr, &status);
+        CHECK_RETURN_ERROR(status);
 
-    vector<float> randData;
-    randData.resize(_samples * 4);
-    for (size_t i = 0; i < randData.size(); ++i) {
-        randData[i] = valueDistribution(randomEngine);
+        transform(input.second->begin(), input.second->end(), converted.begin(), [](double value) -> TItem {
+                return static_cast<TItem>(value);
+            });
+        status = queue.enqueueWriteBuffer(**input.first, CL_TRUE, 0, bytes, &converted[0]);
+        CHECK_RETURN_ERROR(status);
     }
 
-    cl::CommandQueue& queue = _controller->Queue();
-    queue.enqueueWriteBuffer(*_randBuffer, CL_TRUE, 0, _samples * sizeof(cl_float4), &randData[0]);
-    queue.finish();
+    _callPriceBuffer = make_shared<cl::Buffer>(context, CL_MEM_WRITE_ONLY, bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _putPriceBuffer = make_shared<cl::Buffer>(context, CL_MEM_WRITE_ONLY, bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
 }
 
 void BlackScholes::SetKernelArguments() {
-    cl_int scalarRowStride = 4 * _width;
-    _scalarKernel->setArg(0, *_randBuffer);
-    _scalarKernel->setArg(1, scalarRowStride);
-    _scalarKernel->setArg(2, *_callPriceBuffer);
-    _scalarKernel->setArg(3, *_putPriceBuffer);
-
-    _vectorizedKernel->setArg(0, *_randBuffer);
-    _vectorizedKernel->setArg(1, _width);
-    _vectorizedKernel->setArg(2, *_callPriceBuffer);
-    _vectorizedKernel->setArg(3, *_putPriceBuffer);
+    for (cl::Kernel* kernel : { _scalarKernel.get(), _vectorizedKernel.get() }) {
+        kernel->setArg(0, *_spotBuffer);
+        kernel->setArg(1, *_strikeBuffer);
+        kernel->setArg(2, *_timeBuffer);
+        kernel->setArg(3, *_rateBuffer);
+        kernel->setArg(4, *_volatilityBuffer);
+        kernel->setArg(5, *_callPriceBuffer);
+        kernel->setArg(6, *_putPriceBuffer);
+    }
+
+    _scalarKernel->setArg(7, _paddedCount);
+    _vectorizedKernel->setArg(7, _paddedCount / 4);
 }
 
+template <typename TItem>
 void BlackScholes::ExecuteKernels() {
     cl::CommandQueue& queue = _controller->Queue();
-    cl::NDRange localWorkSize(_blockSizeX, _blockSizeY);
-    cl::NDRange globalWorkSizeScalar(4 * _width, _height);
-    cl::NDRange globalWorkSizeVectorized(_width, _height);
+    cl::NDRange localWorkSize(_workGroupSize);
+    cl::NDRange globalWorkSizeScalar(RoundToMultipleOf(_paddedCount, _workGroupSize));
+    cl::NDRange globalWorkSizeVectorized(RoundToMultipleOf(_paddedCount / 4, _workGroupSize));
+    const string precision = is_same<TItem, float>::value ? "<float>" : "<double>";
     cl_int status = CL_SUCCESS;
 
-    string testName = "BlackScholes (scalar),     ";
-    PerformTest([&](cl::Event& event) -> void {
-            status = queue.enqueueNDRangeKernel(*_scalarKernel, cl::NullRange, globalWorkSizeScalar, localWorkSize, nullptr, &event);
-            CHECK(status);
-        }, testName, TEST_ITERATIONS);
-
-    testName = "BlackScholes (vectorized), ";
-    PerformTest([&](cl::Event& event) -> void {
-            status = queue.enqueueNDRangeKernel(*_vectorizedKernel, cl::NullRange, globalWorkSizeVectorized, localWorkSize, nullptr, &event);
-            CHECK(status);
-        }, testName, TEST_ITERATIONS);
+    for (bool vectorized : { false, true }) {
+        const string testName = "BlackScholes" + precision + (vectorized ? " (vectorized)" : " (scalar)");
+
+        // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                events.resize(1);
+                status = queue.enqueueNDRangeKernel(vectorized ? *_vectorizedKernel : *_scalarKernel, cl::NullRange,
+                    vectorized ? globalWorkSizeVectorized : globalWorkSizeScalar, localWorkSize, nullptr, &events[0]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            }, testName + ", ", TEST_ITERATIONS);
+        CHECK(status);
+
+        const double time = _gpuStatistics.Mean();
+        cout << "  " << testName << ", " << _optionCount << " options: "
+            << (time > 0.0 ? 1000.0 * _optionCount / time : 0.0) << " Moptions/s" << endl;
+
+        ValidatePrices<TItem>(testName);
+    }
+}
+
+template <typename TItem>
+void BlackScholes::ValidatePrices(const string& testName) {
+    if (!ValidationEnabled())
+        return;
+
+    vector<TItem> callPrices(_paddedCount), putPrices(_paddedCount);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueReadBuffer(*_callPriceBuffer, CL_TRUE, 0, _paddedCount * sizeof(TItem), &callPrices[0]);
+    status |= queue.enqueueReadBuffer(*_putPriceBuffer, CL_TRUE, 0, _paddedCount * sizeof(TItem), &putPrices[0]);
+    CHECK(status);
+
+    // the reference uses the inputs as they were converted for the device
+    auto reference = [&](int64_t i, bool callPrice) -> double {
+        double call, put;
+        ReferencePrices(static_cast<TItem>(_spot[i]), static_cast<TItem>(_strike[i]), static_cast<TItem>(_time[i]),
+            static_cast<TItem>(_rate[i]), static_cast<TItem>(_volatility[i]), call, put);
+        return callPrice ? call : put;
+    };
+    const double tolerance = is_same<TItem, float>::value ? FLOAT_TOLERANCE : ValidationTolerance<TItem>();
+
+    ValidateResults(testName + " call", &callPrices[0], _optionCount, [&](int64_t i) -> double {
+            return reference(i, true);
+        }, tolerance);
+    ValidateResults(testName + " put", &putPrices[0], _optionCount, [&](int64_t i) -> double {
+            return reference(i, false);
+        }, tolerance);
+
+    // make sure the next kernel does not pass because of the previous results
+    status = queue.enqueueFillBuffer(*_callPriceBuffer, static_cast<TItem>(0), 0, _paddedCount * sizeof(TItem));
+    status |= queue.enqueueFillBuffer(*_putPriceBuffer, static_cast<TItem>(0), 0, _paddedCount * sizeof(TItem));
+    status |= queue.finish();
+    CHECK(status);
 }
 
 void BlackScholes::Cleanup() {
-    _randBuffer.reset();
+    _spotBuffer.reset();
+    _strikeBuffer.reset();
+    _timeBuffer.reset();
+    _rateBuffer.reset();
+    _volatilityBuffer.reset();
     _callPriceBuffer.reset();
     _putPriceBuffer.reset();
     _scalarKernel.reset();
@@ -130,18 +287,28 @@ void BlackScholes::Cleanup() {
     _program.reset();
 }
 
+template <typename TItem>
 void BlackScholes::RunInternal() {
-    RequestWorkGroupSize(256); // 256 is the default in amd samples code
-
-    if (InitContext() == 0) {
-        InitData();
+    if (InitContext<TItem>() == 0 && InitData<TItem>() == 0) {
         SetKernelArguments();
-        ExecuteKernels();
-        Cleanup();
+        ExecuteKernels<TItem>();
     }
+    Cleanup();
 }
 
 void BlackScholes::Run() {
-    RunInternal();
+    RequestWorkGroupSize(256); // 256 is the default in amd samples code
+    LoadOptions();
+
+    RunInternal<float>();
+    if (_controller->SupportsDoublePrecision())
+        RunInternal<double>();
+
+    _spot.clear();
+    _strike.clear();
+    _time.clear();
+    _rate.clear();
+    _volatility.clear();
+
     cout << endl;
 }
@@ -4,6 +4,7 @@
 #include "../benchmarkbase.hpp"
 
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace benchmarks {
@@ -11,33 +12,67 @@ namespace benchmarks {
 /**
  * This benchmark executes a kernel simulation parts of financial market.
  * For more information read: https://en.wikipedia.org/wiki/Black%E2%80%93Scholes_model
+ *
+ * The options are read from data/blackscholes/options.txt (PARSEC blackscholes format) if the file exists,
+ * otherwise they are generated with realistic parameter ranges. They are priced in single and
+ * double precision and compared with a host reference.
  */
 class BlackScholes : public BenchmarkBase {
 private:
-    std::shared_ptr<cl::Buffer> _randBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _spotBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _strikeBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _timeBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _rateBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _volatilityBuffer = nullptr;
     std::shared_ptr<cl::Buffer> _callPriceBuffer = nullptr;
     std::shared_ptr<cl::Buffer> _putPriceBuffer = nullptr;
     std::shared_ptr<cl::Kernel> _scalarKernel = nullptr;
     std::shared_ptr<cl::Kernel> _vectorizedKernel = nullptr;
     std::shared_ptr<cl::Program> _program = nullptr;
 
-    int _blockSizeX = 1;
-    int _blockSizeY = 1;
-    int _samples = -1;
-    int _height = -1;
-    int _width = -1;
+    // options as structure of arrays, padded to a multiple of 4 for the vectorized kernel
+    std::vector<double> _spot;
+    std::vector<double> _strike;
+    std::vector<double> _time;
+    std::vector<double> _rate;
+    std::vector<double> _volatility;
+
+    int _optionCount = 0;
+    int _paddedCount = 0;
+    int _workGroupSize = 1;
+
+    /**
+     * Read the options from the input file or generate them.
+     * Sets _optionCount and _paddedCount.
+     */
+    void LoadOptions();
+
+    /**
+     * Parse a file in the format of the PARSEC blackscholes inputs: the number of options followed by one line per option
+     * (spot price, strike price, rate, dividend, volatility, time, type, dividend value, reference value).
+     * Dividends and the option type are ignored, call and put prices are computed for every option.
+     *
+     * @return false if the file does not exist or can not be parsed
+     */
+    bool LoadOptionFile(const std::string& path);
 
     /**
-     * Compile kernels, initialize buffers, calculate work-group sizes.
-     * Sets _blockSizeX, blockSizeY.
+     * Generate options with realistic parameter ranges (moneyness, maturities from weeks to years, ...).
      */
+    void GenerateOptions();
+
+    /**
+     * Compile kernels and calculate the work-group size.
+     * Sets _workGroupSize.
+     */
+    template <typename TItem>
     int InitContext();
 
     /**
-     * Create all buffers. Initialize _randBuffer with random values and copy it to the device.
-     * Also sets _samples, _height and _width;
+     * Create all buffers and copy the options converted to TItem to the device.
      */
-    void InitData();
+    template <typename TItem>
+    int InitData();
 
     /**
      * Set the kernel arguments using the buffers and constants calculate so far.
@@ -49,17 +84,24 @@ private:
      * Executed multiple times.
      * Also prints statistics
      */
+    template <typename TItem>
     void ExecuteKernels();
 
+    /**
+     * Read the call and put prices and compare them with a host reference.
+     */
+    template <typename TItem>
+    void ValidatePrices(const std::string& testName);
+
     /**
      * Cleanup all buffers, kernels and the program instance.
      */
     void Cleanup();
 
     /**
-     * Set the correct work group size.
      * Call all functions declared above in correct order.
      */
+    template <typename TItem>
     void RunInternal();
 
 public:
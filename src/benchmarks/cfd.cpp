@@ -1,8 +1,11 @@
 #include "cfd.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <queue>
 #include <random>
 #include <sstream>
 
@@ -26,6 +29,19 @@ static const int VAR_MOMENTUM = 1;
 static const int VAR_DENSITY_ENERGY = (VAR_MOMENTUM + DIMENSION);
 static const int NVAR = (VAR_DENSITY_ENERGY + 1);
 
+static const int CURVE_BITS = 10; // bits per dimension used to quantize coordinates for morton/hilbert curves
+
+static const int RANDOM_SEED = 85733;
+static const int SYNTHETIC_MESH_SIZES[] = { 10000, 100000, 1000000, 10000000 };
+static const int SYNTHETIC_WORK_GROUP_SIZE = 192;
+static const int TETRAHEDRA_PER_CELL = 6;
+static const float VERTEX_JITTER = 0.2f;   // relative to the cell size
+
+// axis permutations defining the six tetrahedra of a cell (kuhn triangulation)
+static const int CELL_PERMUTATIONS[TETRAHEDRA_PER_CELL][DIMENSION] = {
+    { 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+};
+
 
 struct Point {
     float x;
@@ -34,7 +50,8 @@ struct Point {
 };
 
 Cfd::Cfd(std::shared_ptr<ComputeController> controller)
-    : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _centroids() {
 
 }
 
@@ -46,6 +63,9 @@ bool Cfd::LoadInputData() {
     ifstream fileStream(CL_DATA_PATH_PREFIX + CFD_DATASET, ios::in);
     string inputData = "";
 
+    if (!fileStream)
+        return false;
+
     fileStream.seekg(0, ios::end);
     inputData.resize(static_cast<size_t>(fileStream.tellg()));
     fileStream.seekg(0, ios::beg);
@@ -105,7 +125,153 @@ bool Cfd::LoadInputData() {
         return false;
     }
 
-    // fill in padding
+    FillPadding();
+    return true;
+}
+
+static int PermutationIndex(int a, int b, int c) {
+    for (int p = 0; p < TETRAHEDRA_PER_CELL; ++p) {
+        if (CELL_PERMUTATIONS[p][0] == a && CELL_PERMUTATIONS[p][1] == b && CELL_PERMUTATIONS[p][2] == c)
+            return p;
+    }
+    return -1;
+}
+
+bool Cfd::GenerateInputData(int elementCount) {
+    const int cells = max(1, static_cast<int>(round(cbrt(static_cast<double>(elementCount) / TETRAHEDRA_PER_CELL))));
+    const int vertices = cells + 1;
+    const float cellSize = 1.0f / cells;
+
+    _pointCount = TETRAHEDRA_PER_CELL * cells * cells * cells;
+    _pointCountPadded = _pointCount + (_requestedWorkGroupSize - (_pointCount % _requestedWorkGroupSize)) % _requestedWorkGroupSize;
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<float> jitterDistribution(-VERTEX_JITTER, VERTEX_JITTER);
+
+    // vertex positions, only interior vertices are moved so that boundary faces stay planar
+    vector<float> positions(static_cast<size_t>(vertices) * vertices * vertices * DIMENSION);
+    for (int z = 0; z < vertices; ++z) {
+        for (int y = 0; y < vertices; ++y) {
+            for (int x = 0; x < vertices; ++x) {
+                int grid[DIMENSION] = { x, y, z };
+                size_t index = ((static_cast<size_t>(z) * vertices + y) * vertices + x) * DIMENSION;
+                for (int k = 0; k < DIMENSION; ++k) {
+                    bool interior = grid[k] > 0 && grid[k] < cells;
+                    positions[index + k] = (grid[k] + (interior ? jitterDistribution(randomEngine) : 0.0f)) * cellSize;
+                }
+            }
+        }
+    }
+
+    // permutations of the axes which belong to the neighbors on the faces opposite of vertex 0..3
+    int neighborPermutations[TETRAHEDRA_PER_CELL][NNB];
+    for (int p = 0; p < TETRAHEDRA_PER_CELL; ++p) {
+        const int *axes = CELL_PERMUTATIONS[p];
+        neighborPermutations[p][0] = PermutationIndex(axes[1], axes[2], axes[0]);   // cell + e[axes[0]]
+        neighborPermutations[p][1] = PermutationIndex(axes[1], axes[0], axes[2]);   // same cell
+        neighborPermutations[p][2] = PermutationIndex(axes[0], axes[2], axes[1]);   // same cell
+        neighborPermutations[p][3] = PermutationIndex(axes[2], axes[0], axes[1]);   // cell - e[axes[2]]
+    }
+
+    // random element numbering, real meshes are not stored in a cache friendly order either
+    vector<int> newIndices(_pointCount);
+    for (int i = 0; i < _pointCount; ++i)
+        newIndices[i] = i;
+    shuffle(newIndices.begin(), newIndices.end(), randomEngine);
+
+    _areas = new float[_pointCountPadded];
+    _surroundingElementsCounters = new int[_pointCountPadded * NNB];
+    _normalVectors = new float[_pointCountPadded * DIMENSION * NNB];
+    _centroids.resize(static_cast<size_t>(_pointCount) * DIMENSION);
+
+    for (int z = 0; z < cells; ++z) {
+        for (int y = 0; y < cells; ++y) {
+            for (int x = 0; x < cells; ++x) {
+                for (int p = 0; p < TETRAHEDRA_PER_CELL; ++p) {
+                    const int *axes = CELL_PERMUTATIONS[p];
+                    int cell[DIMENSION] = { x, y, z };
+                    int element = newIndices[((z * cells + y) * cells + x) * TETRAHEDRA_PER_CELL + p];
+
+                    // corners: v0 = cell, v1 = v0 + e[axes[0]], v2 = v1 + e[axes[1]], v3 = cell + (1, 1, 1)
+                    int corners[NNB][DIMENSION];
+                    for (int k = 0; k < DIMENSION; ++k) {
+                        corners[0][k] = cell[k];
+                        corners[3][k] = cell[k] + 1;
+                    }
+                    for (int k = 0; k < DIMENSION; ++k) {
+                        corners[1][k] = corners[0][k] + (k == axes[0] ? 1 : 0);
+                        corners[2][k] = corners[1][k] + (k == axes[1] ? 1 : 0);
+                    }
+
+                    Point v[NNB];
+                    for (int c = 0; c < NNB; ++c) {
+                        size_t index = ((static_cast<size_t>(corners[c][2]) * vertices + corners[c][1]) * vertices + corners[c][0]) * DIMENSION;
+                        v[c].x = positions[index];
+                        v[c].y = positions[index + 1];
+                        v[c].z = positions[index + 2];
+                    }
+
+                    _centroids[element * DIMENSION] = (v[0].x + v[1].x + v[2].x + v[3].x) * 0.25f;
+                    _centroids[element * DIMENSION + 1] = (v[0].y + v[1].y + v[2].y + v[3].y) * 0.25f;
+                    _centroids[element * DIMENSION + 2] = (v[0].z + v[1].z + v[2].z + v[3].z) * 0.25f;
+
+                    // the benchmark calls the element volume "area"
+                    Point a = { v[1].x - v[0].x, v[1].y - v[0].y, v[1].z - v[0].z };
+                    Point b = { v[2].x - v[0].x, v[2].y - v[0].y, v[2].z - v[0].z };
+                    Point c = { v[3].x - v[0].x, v[3].y - v[0].y, v[3].z - v[0].z };
+                    _areas[element] = fabs(a.x * (b.y * c.z - b.z * c.y) - a.y * (b.x * c.z - b.z * c.x) + a.z * (b.x * c.y - b.y * c.x)) / 6.0f;
+
+                    for (int j = 0; j < NNB; ++j) {
+                        // neighbor across the face opposite of vertex j
+                        int neighborCell[DIMENSION] = { x, y, z };
+                        int neighbor = -2;
+                        bool outside = false;
+                        if (j == 0) {
+                            neighborCell[axes[0]]++;
+                            outside = neighborCell[axes[0]] >= cells;
+                        } else if (j == 3) {
+                            neighborCell[axes[2]]--;
+                            outside = neighborCell[axes[2]] < 0;
+                        }
+
+                        if (!outside) {
+                            neighbor = newIndices[((neighborCell[2] * cells + neighborCell[1]) * cells + neighborCell[0]) * TETRAHEDRA_PER_CELL + neighborPermutations[p][j]];
+                        } else if (j == 3 && axes[2] == 2 && abs(2 * x + 1 - cells) < cells / 2 && abs(2 * y + 1 - cells) < cells / 2) {
+                            neighbor = -1; // wing boundary
+                        }
+                        _surroundingElementsCounters[j * _pointCountPadded + element] = neighbor;
+
+                        // area weighted face normal, the kernel expects it to point into the element
+                        const Point& f0 = v[(j + 1) % NNB];
+                        const Point& f1 = v[(j + 2) % NNB];
+                        const Point& f2 = v[(j + 3) % NNB];
+                        Point e0 = { f1.x - f0.x, f1.y - f0.y, f1.z - f0.z };
+                        Point e1 = { f2.x - f0.x, f2.y - f0.y, f2.z - f0.z };
+                        Point normal = { 0.5f * (e0.y * e1.z - e0.z * e1.y), 0.5f * (e0.z * e1.x - e0.x * e1.z), 0.5f * (e0.x * e1.y - e0.y * e1.x) };
+
+                        float orientation = normal.x * (v[j].x - f0.x) + normal.y * (v[j].y - f0.y) + normal.z * (v[j].z - f0.z);
+                        float sign = orientation > 0.0f ? 1.0f : -1.0f;
+
+                        _normalVectors[(0 * NNB + j) * _pointCountPadded + element] = sign * normal.x;
+                        _normalVectors[(1 * NNB + j) * _pointCountPadded + element] = sign * normal.y;
+                        _normalVectors[(2 * NNB + j) * _pointCountPadded + element] = sign * normal.z;
+                    }
+                }
+            }
+        }
+    }
+
+    FillPadding();
+    return true;
+}
+
+bool Cfd::InitInputData(int syntheticElementCount) {
+    if (syntheticElementCount > 0)
+        return GenerateInputData(syntheticElementCount);
+    return LoadInputData();
+}
+
+void Cfd::FillPadding() {
     for (int i = _pointCount; i < _pointCountPadded; ++i) {
         _areas[i] = _areas[_pointCount - 1];
         for (int j = 0; j < NNB; ++j) {
@@ -115,8 +281,229 @@ bool Cfd::LoadInputData() {
             }
         }
     }
+}
 
-    return true;
+int Cfd::ComputeDistances(int source, vector<int>& distances) {
+    distances.assign(_pointCount, -1);
+
+    std::queue<int> elements;
+    elements.push(source);
+    distances[source] = 0;
+    int farthest = source;
+
+    while (!elements.empty()) {
+        int element = elements.front();
+        elements.pop();
+        farthest = element;
+
+        for (int j = 0; j < NNB; ++j) {
+            int neighbor = _surroundingElementsCounters[j * _pointCountPadded + element];
+            if (neighbor < 0 || neighbor >= _pointCount || distances[neighbor] >= 0)
+                continue;
+
+            distances[neighbor] = distances[element] + 1;
+            elements.push(neighbor);
+        }
+    }
+
+    return farthest;
+}
+
+void Cfd::ComputeReverseCuthillMcKeeOrder(vector<int>& order) {
+    vector<int> degrees(_pointCount, 0);
+    for (int i = 0; i < _pointCount; ++i) {
+        for (int j = 0; j < NNB; ++j) {
+            int neighbor = _surroundingElementsCounters[j * _pointCountPadded + i];
+            if (neighbor >= 0 && neighbor < _pointCount)
+                degrees[i]++;
+        }
+    }
+
+    // components are started at elements with the lowest degree, the first one at a pseudo-peripheral element
+    vector<int> candidates(_pointCount);
+    for (int i = 0; i < _pointCount; ++i)
+        candidates[i] = i;
+    stable_sort(candidates.begin(), candidates.end(), [&](int a, int b) { return degrees[a] < degrees[b]; });
+
+    vector<int> distances;
+    vector<bool> visited(_pointCount, false);
+    vector<int> neighbors;
+    order.clear();
+    order.reserve(_pointCount);
+
+    for (auto candidate : candidates) {
+        if (visited[candidate])
+            continue;
+
+        int start = order.empty() ? ComputeDistances(candidate, distances) : candidate;
+        size_t head = order.size();
+        order.push_back(start);
+        visited[start] = true;
+
+        // the order vector itself serves as bfs queue
+        while (head < order.size()) {
+            int element = order[head++];
+
+            neighbors.clear();
+            for (int j = 0; j < NNB; ++j) {
+                int neighbor = _surroundingElementsCounters[j * _pointCountPadded + element];
+                if (neighbor >= 0 && neighbor < _pointCount && !visited[neighbor]) {
+                    visited[neighbor] = true;
+                    neighbors.push_back(neighbor);
+                }
+            }
+
+            sort(neighbors.begin(), neighbors.end(), [&](int a, int b) { return degrees[a] < degrees[b]; });
+            order.insert(order.end(), neighbors.begin(), neighbors.end());
+        }
+    }
+
+    reverse(order.begin(), order.end());
+}
+
+void Cfd::ComputeSpaceFillingCurveOrder(vector<int>& order, bool hilbert) {
+    vector<int> coordinates[DIMENSION];
+    const uint32_t maxCoordinate = (1u << CURVE_BITS) - 1;
+
+    if (_centroids.size() == static_cast<size_t>(_pointCount) * DIMENSION) {
+        // quantize centroids to CURVE_BITS bits within the bounding box
+        for (int k = 0; k < DIMENSION; ++k) {
+            float minimum = _centroids[k], maximum = _centroids[k];
+            for (int i = 0; i < _pointCount; ++i) {
+                minimum = min(minimum, _centroids[i * DIMENSION + k]);
+                maximum = max(maximum, _centroids[i * DIMENSION + k]);
+            }
+
+            float scale = maximum > minimum ? maxCoordinate / (maximum - minimum) : 0.0f;
+            coordinates[k].resize(_pointCount);
+            for (int i = 0; i < _pointCount; ++i)
+                coordinates[k][i] = min(static_cast<int>((_centroids[i * DIMENSION + k] - minimum) * scale), static_cast<int>(maxCoordinate));
+        }
+    } else {
+        // landmark embedding: distances to three elements which are far apart from each other
+        vector<int> distances;
+
+        int landmark = ComputeDistances(0, distances);
+        landmark = ComputeDistances(landmark, coordinates[0]);
+        ComputeDistances(landmark, coordinates[1]);
+
+        int maxMinDistance = -1;
+        for (int i = 0; i < _pointCount; ++i) {
+            int minDistance = min(coordinates[0][i], coordinates[1][i]);
+            if (minDistance > maxMinDistance) {
+                maxMinDistance = minDistance;
+                landmark = i;
+            }
+        }
+        ComputeDistances(landmark, coordinates[2]);
+
+        // quantize coordinates to CURVE_BITS bits, unreachable elements are moved to the end of the curve
+        for (int k = 0; k < DIMENSION; ++k) {
+            int maxDistance = *max_element(coordinates[k].begin(), coordinates[k].end());
+            for (auto& coordinate : coordinates[k]) {
+                if (coordinate < 0)
+                    coordinate = maxDistance + 1;
+                coordinate = static_cast<int>(static_cast<int64_t>(coordinate) * maxCoordinate / (maxDistance + 1));
+            }
+        }
+    }
+
+    vector<pair<uint32_t, int>> keys(_pointCount);
+    for (int i = 0; i < _pointCount; ++i) {
+        uint32_t x[DIMENSION];
+        for (int k = 0; k < DIMENSION; ++k)
+            x[k] = static_cast<uint32_t>(coordinates[k][i]);
+
+        if (hilbert) {
+            // convert axes to the transposed hilbert index (John Skilling, "Programming the Hilbert curve", 2004)
+            for (uint32_t q = 1u << (CURVE_BITS - 1); q > 1; q >>= 1) {
+                uint32_t p = q - 1;
+                for (int k = 0; k < DIMENSION; ++k) {
+                    if (x[k] & q) {
+                        x[0] ^= p;
+                    } else {
+                        uint32_t t = (x[0] ^ x[k]) & p;
+                        x[0] ^= t;
+                        x[k] ^= t;
+                    }
+                }
+            }
+
+            for (int k = 1; k < DIMENSION; ++k)
+                x[k] ^= x[k - 1];
+
+            uint32_t t = 0;
+            for (uint32_t q = 1u << (CURVE_BITS - 1); q > 1; q >>= 1) {
+                if (x[DIMENSION - 1] & q)
+                    t ^= q - 1;
+            }
+            for (int k = 0; k < DIMENSION; ++k)
+                x[k] ^= t;
+        }
+
+        // interleave bits, the first dimension is the most significant one
+        uint32_t key = 0;
+        for (int b = CURVE_BITS - 1; b >= 0; --b) {
+            for (int k = 0; k < DIMENSION; ++k)
+                key = (key << 1) | ((x[k] >> b) & 1u);
+        }
+
+        keys[i] = make_pair(key, i);
+    }
+
+    sort(keys.begin(), keys.end());
+
+    order.resize(_pointCount);
+    for (int i = 0; i < _pointCount; ++i)
+        order[i] = keys[i].second;
+}
+
+void Cfd::ReorderMesh(MeshOrdering ordering) {
+    if (ordering == MeshOrdering::Original)
+        return;
+
+    _timer.Remember();
+
+    vector<int> order;
+    if (ordering == MeshOrdering::ReverseCuthillMcKee)
+        ComputeReverseCuthillMcKeeOrder(order);
+    else
+        ComputeSpaceFillingCurveOrder(order, ordering == MeshOrdering::Hilbert);
+
+    vector<int> newIndices(_pointCount);
+    for (int i = 0; i < _pointCount; ++i)
+        newIndices[order[i]] = i;
+
+    vector<float> areas(_areas, _areas + _pointCountPadded);
+    vector<int> surroundingElementsCounters(_surroundingElementsCounters, _surroundingElementsCounters + _pointCountPadded * NNB);
+    vector<float> normalVectors(_normalVectors, _normalVectors + _pointCountPadded * NNB * DIMENSION);
+
+    for (int i = 0; i < _pointCount; ++i) {
+        int source = order[i];
+        _areas[i] = areas[source];
+
+        for (int j = 0; j < NNB; ++j) {
+            // boundary markers (negative values) are kept
+            int neighbor = surroundingElementsCounters[j * _pointCountPadded + source];
+            _surroundingElementsCounters[j * _pointCountPadded + i] = (neighbor >= 0 && neighbor < _pointCount) ? newIndices[neighbor] : neighbor;
+
+            for (int k = 0; k < DIMENSION; ++k) {
+                _normalVectors[(k * NNB + j) * _pointCountPadded + i] = normalVectors[(k * NNB + j) * _pointCountPadded + source];
+            }
+        }
+    }
+
+    if (!_centroids.empty()) {
+        vector<float> centroids(_centroids);
+        for (int i = 0; i < _pointCount; ++i) {
+            for (int k = 0; k < DIMENSION; ++k)
+                _centroids[i * DIMENSION + k] = centroids[order[i] * DIMENSION + k];
+        }
+    }
+
+    FillPadding();
+
+    cout << "Reordering, CPU: " << _timer.Diff() << endl;
 }
 
 void Cfd::InitFarFieldData() {
@@ -268,7 +655,7 @@ void Cfd::SetKernelArguments() {
     _timeStepKernel->setArg(5, *_fluxesBuffer);
 }
 
-void Cfd::RunInternal() {
+int64_t Cfd::RunInternal() {
     cl::CommandQueue& queue = _controller->Queue();
     cl::Event event;
     cl::NDRange local(_requestedWorkGroupSize);
@@ -292,7 +679,9 @@ void Cfd::RunInternal() {
         // compute step factors
         _timer.Remember();
         status = queue.enqueueNDRangeKernel(*_computeStepFactorKernel, cl::NullRange, global, local, nullptr, &event);
-        WAIT_AND_CHECK(event, status);
+        if (status != CL_SUCCESS)
+            break;
+        event.wait();
         timeComputeStepFactorCPU += _timer.Diff();
 
         event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
@@ -302,7 +691,9 @@ void Cfd::RunInternal() {
         for (int j = 0; j < RK; ++j) {
             _timer.Remember();
             status = queue.enqueueNDRangeKernel(*_computeFluxKernel, cl::NullRange, global, local, nullptr, &event);
-            WAIT_AND_CHECK(event, status);
+            if (status != CL_SUCCESS)
+                break;
+            event.wait();
             timeComputeFluxCPU += _timer.Diff();
 
             event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
@@ -312,13 +703,23 @@ void Cfd::RunInternal() {
             _timeStepKernel->setArg(0, j);
             _timer.Remember();
             status = queue.enqueueNDRangeKernel(*_timeStepKernel, cl::NullRange, global, local, nullptr, &event);
-            WAIT_AND_CHECK(event, status);
+            if (status != CL_SUCCESS)
+                break;
+            event.wait();
             timeTimeStepCPU += _timer.Diff();
 
             event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
             event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
             timeTimeStepGPU += (endTime - startTime);
         }
+
+        if (status != CL_SUCCESS)
+            break;
+    }
+
+    if (status != CL_SUCCESS) {
+        cerr << "Error " << status << " in " << __FILE__ << " on line: " << __LINE__ << endl;
+        return -1;
     }
 
     cout << "ComputeStepFactor, CPU: " << timeComputeStepFactorCPU << ", GPU: " << timeComputeStepFactorGPU << endl;
@@ -327,6 +728,11 @@ void Cfd::RunInternal() {
     cout << "Total,             CPU: " << (timeTimeStepCPU + timeComputeFluxCPU + timeComputeStepFactorCPU)
         << ", GPU: " << (timeTimeStepGPU + timeComputeFluxGPU + timeComputeStepFactorGPU) << endl;
 
+    // elements per nanosecond * 1000 = million elements per second
+    double fluxThroughput = static_cast<double>(_pointCount) * RK * ALGORITHM_ITERATIONS * 1000.0 / static_cast<double>(timeComputeFluxGPU);
+    cout << "ComputeFlux throughput: " << fluxThroughput << " MElements/s" << endl;
+
+    return timeComputeFluxGPU;
 }
 
 void Cfd::Cleanup() {
@@ -340,6 +746,7 @@ void Cfd::Cleanup() {
     _areas = nullptr;
     _surroundingElementsCounters = nullptr;
     _normalVectors = nullptr;
+    vector<float>().swap(_centroids);
 
     _ff_variableBuffer.reset();
     _ff_fluxXBuffer.reset();
@@ -364,24 +771,66 @@ void Cfd::Cleanup() {
 }
 
 
+void Cfd::RunAllOrderings(int syntheticElementCount) {
+    struct {
+        MeshOrdering ordering;
+        const char *name;
+    } orderings[] = {
+        { MeshOrdering::Original, "Original" },
+        { MeshOrdering::ReverseCuthillMcKee, "ReverseCuthillMcKee" },
+        { MeshOrdering::Morton, "Morton" },
+        { MeshOrdering::Hilbert, "Hilbert" }
+    };
+
+    int64_t originalFluxTime = -1;
+    for (auto& ordering : orderings) {
+        cout << "MeshOrdering: " << ordering.name << endl;
+
+        InitFarFieldData();
+        if (InitInputData(syntheticElementCount) && InitKernelsAndBuffers() == 0) {
+            ReorderMesh(ordering.ordering);
+            InitDeviceMemory();
+            SetKernelArguments();
+
+            int64_t fluxTime = RunInternal();
+            if (ordering.ordering == MeshOrdering::Original)
+                originalFluxTime = fluxTime;
+            else if (originalFluxTime > 0 && fluxTime > 0)
+                cout << "ComputeFlux speedup vs. original ordering: " << static_cast<double>(originalFluxTime) / fluxTime << endl;
+        } else {
+            cerr << "Failed to initialize input data" << endl;
+            Cleanup();
+            return;
+        }
+        Cleanup();
+    }
+}
+
 void Cfd::Run() {
     cout << "Computational Fluid Dynamics Test:" << endl;
 
     int workGroupSizes[] = { 32, 64, 128, 192, 256, 512 };
 
-    for (auto& workGroupSize : workGroupSizes) {
-        RequestWorkGroupSize(workGroupSize);
+    ifstream dataset(CL_DATA_PATH_PREFIX + CFD_DATASET, ios::in);
+    if (dataset) {
+        dataset.close();
 
-        cout << "WorkGroupSize: " << workGroupSize << endl;
+        for (auto& workGroupSize : workGroupSizes) {
+            RequestWorkGroupSize(workGroupSize);
 
-        InitFarFieldData();
-        if (LoadInputData() && InitKernelsAndBuffers() == 0) {
-            InitDeviceMemory();
-            SetKernelArguments();
-            RunInternal();
+            cout << "WorkGroupSize: " << workGroupSize << endl;
+            RunAllOrderings(0);
         }
-        Cleanup();
+    } else {
+        cout << "Dataset " << CFD_DATASET << " not found, only synthetic meshes are used." << endl;
+    }
+
+    // weak scaling with generated meshes
+    RequestWorkGroupSize(SYNTHETIC_WORK_GROUP_SIZE);
+    for (auto& elementCount : SYNTHETIC_MESH_SIZES) {
+        cout << "Synthetic mesh, ~" << elementCount << " elements, WorkGroupSize: " << SYNTHETIC_WORK_GROUP_SIZE << endl;
+        RunAllOrderings(elementCount);
     }
 
     cout << endl;
-}
\ No newline at end of file
+}
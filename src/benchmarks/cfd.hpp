@@ -4,6 +4,7 @@
 #include "../benchmarkbase.hpp"
 
 #include <memory>
+#include <vector>
 
 namespace benchmarks {
 
@@ -12,6 +13,16 @@ namespace benchmarks {
  */
 class Cfd : public BenchmarkBase {
 private:
+    /**
+     * Element numberings which can be applied to the mesh before it is copied to the device.
+     */
+    enum class MeshOrdering {
+        Original,
+        ReverseCuthillMcKee,
+        Morton,
+        Hilbert
+    };
+
     std::shared_ptr<cl::Program> _program = nullptr;
     std::shared_ptr<cl::Kernel> _memsetKernel = nullptr;
     std::shared_ptr<cl::Kernel> _initializeVariablesKernel = nullptr;
@@ -39,6 +50,11 @@ private:
     int *_surroundingElementsCounters = nullptr;
     float *_normalVectors = nullptr;
 
+    /**
+     * Element centroids (x, y, z per element), only known for generated meshes.
+     */
+    std::vector<float> _centroids;
+
     void InitFarFieldData();
 
     /**
@@ -46,6 +62,61 @@ private:
      */
     bool LoadInputData();
 
+    /**
+     * Generate a tetrahedral mesh with the same layout as the one produced by LoadInputData.
+     * The unit cube is split into cells, every cell into six tetrahedra. Interior vertices are
+     * jittered and the elements are numbered randomly, both with a fixed seed.
+     * Faces on the bottom plane below the center of the cube are wing boundaries (-1),
+     * all other outer faces are far field boundaries (-2).
+     *
+     * @param elementCount approximate number of elements to generate
+     */
+    bool GenerateInputData(int elementCount);
+
+    /**
+     * Load the dataset or generate a synthetic mesh.
+     *
+     * @param syntheticElementCount approximate size of the synthetic mesh, zero to load the dataset
+     */
+    bool InitInputData(int syntheticElementCount);
+
+    /**
+     * Copy the values of the last element into the padding elements.
+     */
+    void FillPadding();
+
+    /**
+     * Breadth-first search over the element graph.
+     *
+     * @param source element to start from
+     * @param distances hop count to every element, -1 for elements which are not reachable
+     * @return the element with the largest distance
+     */
+    int ComputeDistances(int source, std::vector<int>& distances);
+
+    /**
+     * Reverse Cuthill-McKee ordering of the element graph.
+     *
+     * @param order receives the old element index for every new position
+     */
+    void ComputeReverseCuthillMcKeeOrder(std::vector<int>& order);
+
+    /**
+     * Orders the elements along a Morton (Z-order) or Hilbert curve.
+     * The mesh files do not contain element centroids, in that case the elements are embedded
+     * into 3D space using their graph distances to three far apart elements.
+     *
+     * @param order receives the old element index for every new position
+     * @param hilbert use a hilbert curve instead of the morton curve
+     */
+    void ComputeSpaceFillingCurveOrder(std::vector<int>& order, bool hilbert);
+
+    /**
+     * Renumber all elements. Permutes _areas, _surroundingElementsCounters and
+     * _normalVectors consistently and remaps the neighbor indices.
+     */
+    void ReorderMesh(MeshOrdering ordering);
+
     /**
      * Initializes all buffers and compiles the kernel.
      */
@@ -64,14 +135,23 @@ private:
     /**
      * Execute _computeStepFactorKernel, _compueFluxKernel and _timeStepKernel
      * to simulate fluid dyanmics. Also does some statistical output.
+     *
+     * @return accumulated device time of _computeFluxKernel, -1 on failure
      */
-    void RunInternal();
+    int64_t RunInternal();
 
     /**
      * Cleanup buffers, kernels and program instance.
      */
     void Cleanup();
 
+    /**
+     * Execute the simulation once for every mesh ordering.
+     *
+     * @param syntheticElementCount approximate size of the synthetic mesh, zero to use the dataset
+     */
+    void RunAllOrderings(int syntheticElementCount);
+
 public:
     explicit Cfd(std::shared_ptr<ComputeController> controller);
 
@@ -0,0 +1,223 @@
+#include "divergence.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int ELEMENTS = 1 << 22;
+static const int WORK = 64;                 // length of the dependency chain of each path
+static const int CLUSTER_SIZE = 1024;       // larger than the SIMD width and the work-group size of all devices
+static const int PERCENTS[] = { 0, 1, 5, 10, 25, 50, 75, 90, 95, 99, 100 };
+static const int ITERATIONS = 10;
+static const int RANDOM_SEED = 85733;
+
+// same paths as in divergence.cl
+static float PathTaken(float x) {
+    for (int i = 0; i < WORK; ++i)
+        x = x * 0.75f + 0.125f;
+    return x;
+}
+
+static float PathNotTaken(float x) {
+    for (int i = 0; i < WORK; ++i)
+        x = x * -0.5f + 0.75f;
+    return x;
+}
+
+Divergence::Divergence(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _values()
+    , _flags()
+    , _results() {
+
+}
+
+Divergence::~Divergence() {
+
+}
+
+int Divergence::InitContext() {
+    string compilerParams = GetCompilerFlags<float>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "divergence.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    _values.resize(ELEMENTS);
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<float> valueDistribution(0.0f, 1.0f);
+    for (auto& value : _values)
+        value = valueDistribution(randomEngine);
+
+    cl_int status = CL_SUCCESS;
+    _valueBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        ELEMENTS * sizeof(float), &_values[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _flagBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY, ELEMENTS * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _indexBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, ELEMENTS * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _counterBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, 2 * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _outputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, ELEMENTS * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+double Divergence::GenerateFlags(int percent, bool clustered) {
+    _flags.resize(ELEMENTS);
+
+    default_random_engine randomEngine(RANDOM_SEED + percent);
+    uniform_int_distribution<int> percentDistribution(0, 99);
+
+    int64_t taken = 0;
+    for (int i = 0; i < ELEMENTS; ++i) {
+        if (!clustered || i % CLUSTER_SIZE == 0)
+            _flags[i] = percentDistribution(randomEngine) < percent ? 1 : 0;
+        else
+            _flags[i] = _flags[i - 1];
+        taken += _flags[i];
+    }
+
+    return static_cast<double>(taken) / ELEMENTS;
+}
+
+void Divergence::RunInternal(bool clustered) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const cl::NDRange global(RoundToMultipleOf(ELEMENTS, WORK_GROUP_SIZE));
+    const cl::NDRange local(WORK_GROUP_SIZE);
+    const string pattern = clustered ? "clustered (" + to_string(CLUSTER_SIZE) + " elements)" : "random";
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel branchyKernel(*_program, "DivergenceBranchy", &status);
+    CHECK(status);
+    cl::Kernel predicatedKernel(*_program, "DivergencePredicated", &status);
+    CHECK(status);
+    cl::Kernel partitionKernel(*_program, "PartitionByBranch", &status);
+    CHECK(status);
+    cl::Kernel sortedKernel(*_program, "DivergenceSorted", &status);
+    CHECK(status);
+
+    for (cl::Kernel* kernel : { &branchyKernel, &predicatedKernel }) {
+        kernel->setArg(0, *_valueBuffer);
+        kernel->setArg(1, *_flagBuffer);
+        kernel->setArg(2, *_outputBuffer);
+        kernel->setArg(3, ELEMENTS);
+        kernel->setArg(4, WORK);
+    }
+
+    partitionKernel.setArg(0, *_flagBuffer);
+    partitionKernel.setArg(1, *_indexBuffer);
+    partitionKernel.setArg(2, *_counterBuffer);
+    partitionKernel.setArg(3, ELEMENTS);
+
+    sortedKernel.setArg(0, *_valueBuffer);
+    sortedKernel.setArg(1, *_indexBuffer);
+    sortedKernel.setArg(2, *_counterBuffer);
+    sortedKernel.setArg(3, *_outputBuffer);
+    sortedKernel.setArg(4, ELEMENTS);
+    sortedKernel.setArg(5, WORK);
+
+    const string variants[] = { "branchy", "predicated", "sorted" };
+    const int variantCount = 3;
+
+    vector<double> fractions;
+    vector<int64_t> times[variantCount];
+
+    for (const int percent : PERCENTS) {
+        fractions.push_back(GenerateFlags(percent, clustered));
+        status = queue.enqueueWriteBuffer(*_flagBuffer, CL_TRUE, 0, ELEMENTS * sizeof(cl_int), &_flags[0]);
+        CHECK(status);
+
+        for (int v = 0; v < variantCount; ++v) {
+            // results of the previous kernel must not pass the validation
+            status = queue.enqueueFillBuffer(*_outputBuffer, -1.0f, 0, ELEMENTS * sizeof(float));
+            CHECK(status);
+
+            const string testName = "  " + variants[v] + ", " + pattern + ", " + to_string(percent) + "% taken,";
+            // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+            PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                    if (v == 2) {
+                        events.resize(3);
+                        status = queue.enqueueFillBuffer(*_counterBuffer, 0, 0, 2 * sizeof(cl_int), nullptr, &events[0]);
+                        if (status == CL_SUCCESS)
+                            status = queue.enqueueNDRangeKernel(partitionKernel, cl::NullRange, global, local, nullptr, &events[1]);
+                        if (status == CL_SUCCESS)
+                            status = queue.enqueueNDRangeKernel(sortedKernel, cl::NullRange, global, local, nullptr, &events[2]);
+                    } else {
+                        events.resize(1);
+                        status = queue.enqueueNDRangeKernel(v == 0 ? branchyKernel : predicatedKernel, cl::NullRange, global, local,
+                            nullptr, &events[0]);
+                    }
+                    if (status != CL_SUCCESS)
+                        events.clear();
+                }, testName, ITERATIONS);
+            CHECK(status);
+
+            times[v].push_back(_gpuStatistics.Mean());
+            ValidateOutput(variants[v] + ", " + pattern + ", " + to_string(percent) + "%");
+        }
+    }
+
+    // without divergence (0% or 100% taken) the branchy kernel executes exactly one path per element
+    const double baseline = (times[0].front() + times[0].back()) / 2.0;
+
+    cout << "  " << pattern << ": Melements/s (efficiency relative to the branchy kernel without divergence)" << endl;
+    for (size_t p = 0; p < fractions.size(); ++p) {
+        cout << "    " << PERCENTS[p] << "% taken (actual " << 100.0 * fractions[p] << "%):";
+        for (int v = 0; v < variantCount; ++v) {
+            const int64_t time = times[v][p];
+            cout << " " << variants[v] << " " << (time > 0 ? 1000.0 * ELEMENTS / time : 0.0)
+                << " (" << (time > 0 ? 100.0 * baseline / time : 0.0) << "%)" << (v + 1 < variantCount ? "," : "");
+        }
+        cout << endl;
+    }
+}
+
+void Divergence::ValidateOutput(const string& testName) {
+    if (!ValidationEnabled())
+        return;
+
+    _results.resize(ELEMENTS);
+    cl_int status = _controller->Queue().enqueueReadBuffer(*_outputBuffer, CL_TRUE, 0, ELEMENTS * sizeof(float), &_results[0]);
+    CHECK(status);
+
+    ValidateResults(testName, &_results[0], ELEMENTS, [&](int64_t i) -> float {
+            return _flags[i] ? PathTaken(_values[i]) : PathNotTaken(_values[i]);
+        });
+}
+
+void Divergence::Cleanup() {
+    _values.clear();
+    _flags.clear();
+    _results.clear();
+    _valueBuffer.reset();
+    _flagBuffer.reset();
+    _indexBuffer.reset();
+    _counterBuffer.reset();
+    _outputBuffer.reset();
+    _program.reset();
+}
+
+void Divergence::Run() {
+    cout << "Divergence (" << ELEMENTS << " elements, " << WORK << " operations per path):" << endl;
+
+    if (InitContext() == 0) {
+        RunInternal(false);
+        RunInternal(true);
+    }
+    Cleanup();
+
+    cout << endl;
+}
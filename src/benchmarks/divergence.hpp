@@ -0,0 +1,76 @@
+#ifndef __BENCH_BENCHMARKS_DIVERGENCE_HPP
+#define __BENCH_BENCHMARKS_DIVERGENCE_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Measures the cost of control flow divergence. Every element takes one of two paths of equal cost,
+ * the input controls the fraction of taken branches (0 to 100%) and their coherence: random flags diverge
+ * within almost every SIMD unit, clustered flags only at the borders of the clusters.
+ * The branches are executed as if/else (branchy), predicated (both paths and a select) and sorted
+ * (the elements are partitioned by their branch first). The efficiency is reported relative to the
+ * branchy kernel without divergence (0% and 100% taken).
+ */
+class Divergence : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _valueBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _flagBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _indexBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _counterBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _outputBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    std::vector<float> _values;
+    std::vector<int> _flags;
+    std::vector<float> _results;
+
+    /**
+     * Compiles the kernels, generates the input values and allocates the buffers.
+     */
+    int InitContext();
+
+    /**
+     * Generates the branch flags on the host.
+     *
+     * @param percent probability of a taken branch
+     * @param clustered all elements of a cluster take the same branch if set, otherwise every element is drawn independently
+     * @return actual fraction of taken branches
+     */
+    double GenerateFlags(int percent, bool clustered);
+
+    /**
+     * Executes all kernels for all fractions of taken branches and prints the throughput and efficiency.
+     */
+    void RunInternal(bool clustered);
+
+    /**
+     * Compares the output buffer with a host reference of both paths.
+     */
+    void ValidateOutput(const std::string& testName);
+
+    /**
+     * Release the buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Divergence(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Divergence();
+
+    /**
+     * Execute the tests for random and clustered branches.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_DIVERGENCE_HPP
@@ -1,6 +1,11 @@
 #include "edge.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
 #include <iostream>
+#include <limits>
 #include <random>
 #include <vector>
 
@@ -10,15 +15,20 @@
 using namespace benchmarks;
 using namespace std;
 
-static const bool USE_STATIC_IMAGE = false;
-static const int WIDTH = 8192;
-static const int HEIGHT = 8192;
+static const int RANDOM_WIDTH = 8192;
+static const int RANDOM_HEIGHT = 8192;
 static const int RANDOM_SEED = 85733;
 static const int TEST_ITERATIONS = 50;
+static const float MIN_PITCH_FACTOR = 0.2f;    // same as in edge.cl
+
+// probed in this order (relative to CL_DATA_PATH_PREFIX) if no image was passed with --image
+static const char* DEFAULT_IMAGES[] = { "edge/image.pgm", "edge/image.ppm" };
 
 
 Edge::Edge(std::shared_ptr<ComputeController> controller)
-    : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _image()
+    , _imageData() {
 
 }
 
@@ -36,42 +46,87 @@ int Edge::InitContext() {
     _optimizedEdgeKernel = make_shared<cl::Kernel>(*_program, "find_edge_pixels_optimized", &status);
     CHECK_RETURN_ERROR(status);
 
-    _imageBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, WIDTH * HEIGHT * sizeof(float));
-    _edgeSteepnessBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, (WIDTH - 2) * (HEIGHT - 2) * sizeof(int));
+    const size_t pixels = static_cast<size_t>(_width) * _height;
+    _imageBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, pixels * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _edgeSteepnessBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, static_cast<size_t>(_width - 2) * (_height - 2) * sizeof(int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
 
     _edgeKernel->setArg(0, *_imageBuffer);
     _edgeKernel->setArg(1, *_edgeSteepnessBuffer);
-    _edgeKernel->setArg(2, WIDTH);
-    _edgeKernel->setArg(3, HEIGHT);
+    _edgeKernel->setArg(2, _width);
+    _edgeKernel->setArg(3, _height);
 
     _optimizedEdgeKernel->setArg(0, *_imageBuffer);
     _optimizedEdgeKernel->setArg(1, *_edgeSteepnessBuffer);
-    _optimizedEdgeKernel->setArg(2, WIDTH);
-    _optimizedEdgeKernel->setArg(3, HEIGHT);
+    _optimizedEdgeKernel->setArg(2, _width);
+    _optimizedEdgeKernel->setArg(3, _height);
+
+    // raw images are memory mapped, the pages are read directly into the buffer
+    cl::CommandQueue& queue = _controller->Queue();
+    status = queue.enqueueWriteBuffer(*_imageBuffer, CL_TRUE, 0, pixels * sizeof(float), _pixels);
+    CHECK_RETURN_ERROR(status);
 
     return 0;
 }
 
-void Edge::InitData() {
-    vector<float> imageData;
-    imageData.resize(WIDTH * HEIGHT);
+int Edge::InitData() {
+    bool loaded = false;
+    if (!_inputImage.empty()) {
+        loaded = _image.Load(_inputImage);
+        if (!loaded) {
+            cerr << "Failed to load the input image: " << _inputImage << endl;
+            return -1;
+        }
+    } else {
+        for (const char* path : DEFAULT_IMAGES) {
+            if ((loaded = _image.Load(CL_DATA_PATH_PREFIX + path)))
+                break;
+        }
+    }
 
-    default_random_engine randomEngine(RANDOM_SEED);
-    uniform_real_distribution<float> valueDistribution(0.0, 100.0);
+    if (loaded) {
+        _width = _image.Width();
+        _height = _image.Height();
+        _pixels = _image.Pixels();
+        cout << "EdgeDetection: " << _width << "x" << _height << " input image" << endl;
+    } else {
+        // random pixels have no spatial correlation, the branches diverge much more than on real scenes
+        _width = RANDOM_WIDTH;
+        _height = RANDOM_HEIGHT;
+        _imageData.resize(static_cast<size_t>(_width) * _height);
+
+        default_random_engine randomEngine(RANDOM_SEED);
+        uniform_real_distribution<float> valueDistribution(0.0, 100.0);
+
+        for (size_t i = 0; i < _imageData.size(); ++i) {
+            _imageData[i] = valueDistribution(randomEngine);
+        }
+        _pixels = &_imageData[0];
+        cout << "EdgeDetection: no input image found, using " << _width << "x" << _height << " random pixels" << endl;
+    }
 
-    for (size_t i = 0; i < imageData.size(); ++i) {
-        imageData[i] = USE_STATIC_IMAGE ? 1.0f : valueDistribution(randomEngine);
+    if (_width < 3 || _height < 3) {
+        cerr << "The input image is too small for the edge detection" << endl;
+        return -1;
     }
 
-    cl::CommandQueue& queue = _controller->Queue();
-    queue.enqueueWriteBuffer(*_imageBuffer, CL_TRUE, 0, sizeof(float) * imageData.size(), &imageData[0]);
-    queue.finish();
+    // the kernels address pixels and buffer positions with unsigned int
+    if (static_cast<uint64_t>(_width) * _height > numeric_limits<uint32_t>::max()) {
+        cerr << "The input image is too large for the edge detection (at most " << numeric_limits<uint32_t>::max()
+            << " pixels)" << endl;
+        return -1;
+    }
+
+    return 0;
 }
 
 void Edge::ExecuteKernel() {
     cl::CommandQueue& queue = _controller->Queue();
     cl::NDRange local(_requestedWorkGroupSize);
-    cl::NDRange global(RoundToMultipleOf((WIDTH-2)*(HEIGHT-2), _requestedWorkGroupSize));
+    const size_t pixels = static_cast<size_t>(_width - 2) * (_height - 2);
+    const size_t groupSize = _requestedWorkGroupSize;
+    cl::NDRange global((pixels + groupSize - 1) / groupSize * groupSize);
 
     string testName = "EdgeDetection: ";
 
@@ -79,6 +134,7 @@ void Edge::ExecuteKernel() {
             cl_int status = queue.enqueueNDRangeKernel(*_edgeKernel, cl::NullRange, global, local, nullptr, &event);
             WAIT_AND_CHECK(event, status);
         }, testName, TEST_ITERATIONS);
+    ValidateSteepness("EdgeDetection");
 
     testName = "EdgeDetection (optimized): ";
 
@@ -86,9 +142,48 @@ void Edge::ExecuteKernel() {
             cl_int status = queue.enqueueNDRangeKernel(*_optimizedEdgeKernel, cl::NullRange, global, local, nullptr, &event);
             WAIT_AND_CHECK(event, status);
         }, testName, TEST_ITERATIONS);
+    ValidateSteepness("EdgeDetection (optimized)");
+}
+
+void Edge::ValidateSteepness(const string& testName) {
+    if (!ValidationEnabled())
+        return;
+
+    const size_t pixels = static_cast<size_t>(_width - 2) * (_height - 2);
+    vector<int> steepness(pixels);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueReadBuffer(*_edgeSteepnessBuffer, CL_TRUE, 0, pixels * sizeof(int), &steepness[0]);
+    CHECK(status);
+
+    // the steepness is truncated to an integer, single precision divisions on the device
+    // may end up on the other side of the rounding boundary
+    Validate(testName, static_cast<int64_t>(pixels), [&](int64_t i) -> bool {
+            const int64_t bufferPos = (i / (_width - 2) + 1) * _width + 1 + i % (_width - 2);
+            const float pixelValue = _pixels[bufferPos];
+            const int64_t neighbours[] = { bufferPos - _width, bufferPos + _width, bufferPos - 1, bufferPos + 1 };
+
+            int expected = 0;
+            for (int64_t neighbour : neighbours) {
+                if (_pixels[neighbour] == 0.0f)
+                    return true;    // converting the infinite relation to int is undefined
+
+                const float relation = pixelValue / _pixels[neighbour];
+                expected = max(expected, static_cast<int>(max(fabs(relation - 1.0f) - MIN_PITCH_FACTOR, 0.0f) * 10));
+            }
+            return abs(steepness[i] - expected) <= 1;
+        });
+
+    // the next kernel has to overwrite every pixel
+    status = queue.enqueueFillBuffer(*_edgeSteepnessBuffer, -1, 0, pixels * sizeof(int));
+    status |= queue.finish();
+    CHECK(status);
 }
 
 void Edge::Cleanup() {
+    _image.Release();
+    _imageData.clear();
+    _pixels = nullptr;
     _imageBuffer.reset();
     _edgeSteepnessBuffer.reset();
     _edgeKernel.reset();
@@ -98,12 +193,11 @@ void Edge::Cleanup() {
 
 
 void Edge::Run() {
-    if (InitContext() == 0) {
-        InitData();
+    if (InitData() == 0 && InitContext() == 0) {
         RequestWorkGroupSize(128);
         ExecuteKernel();
-        Cleanup();
     }
+    Cleanup();
 
     cout << endl;
 }
\ No newline at end of file
@@ -2,8 +2,11 @@
 #define __BENCH_BENCHMARKS_EDGE_HPP
 
 #include "../benchmarkbase.hpp"
+#include "../imageloader.hpp"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace benchmarks {
 
@@ -20,25 +23,34 @@ private:
 	std::shared_ptr<cl::Kernel> _optimizedEdgeKernel = nullptr;
 	std::shared_ptr<cl::Program> _program = nullptr;
 
+	ImageLoader _image;
+	std::vector<float> _imageData;
+	const float* _pixels = nullptr;
+	int _width = 0;
+	int _height = 0;
+
 	/**
-	 * Compiles the kernel, initialize buffers and sets the kernel arguments.
+	 * Compiles the kernel, initialize buffers for the size of the loaded image and sets the kernel arguments.
 	 */
 	int InitContext();
 
 	/**
-	 * Generates an input image.
-	 *
-	 * If USE_STATIC_IMAGE is set to true it is simply filled with one color,
-	 * otherwise (default) the image data is random.
-	 * Use this flag to analyze dynamic branchbehavior.
+	 * Loads the input image: the file passed with --image, otherwise the first existing default image
+	 * in data/edge/ (image.pgm, image.ppm). Real scenes have large uniform areas and a realistic branch
+	 * behavior, if there is no image an 8192x8192 image with random data is generated instead.
 	 */
-	void InitData();
+	int InitData();
 
 	/**
 	 * Execute the kernel multiple times and generate statistics.
 	 */
 	void ExecuteKernel();
 
+	/**
+	 * Compare the steepness of all pixels with a host reference.
+	 */
+	void ValidateSteepness(const std::string& testName);
+
 	/**
 	 * Release all resoruces such as buffers, kernels and the program instance.
 	 */
@@ -49,6 +61,9 @@ public:
 
     virtual ~Edge();
 
+    Edge(const Edge&) = delete;
+    Edge& operator=(const Edge&) = delete;
+
     /**
      * Execute the benchmark.
      */
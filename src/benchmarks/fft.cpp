@@ -1,7 +1,12 @@
 #include "fft.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <functional>
 #include <iostream>
 #include <random>
+#include <utility>
 #include <vector>
 
 #include "../clglobal.hpp"
@@ -13,6 +18,19 @@ using namespace std;
 // totalBufferSize must be devidable by 512 * sizeof(ComplexValue<TItem>) * 2
 static const int TOTAL_BUFFER_SIZE = 256 * 1024 * 1024;
 static const int PASSES = 10;
+static const int RANDOM_SEED = 85733;
+static const int STOCKHAM_ELEMENTS = 1 << 24;          // complex values per buffer for the 1D batches
+static const int STOCKHAM_1D_SIZES[] = { 64, 256, 1024, 4096, 16384, 65536, 1 << 20, 1 << 24 };
+static const int STOCKHAM_2D_SIZES[] = { 1024, 4096 };
+static const int STOCKHAM_3D_SIZES[] = { 64, 256 };
+static const int REAL_SIZES[] = { 1024, 65536, 1 << 20, 1 << 24 };
+static const int STOCKHAM_PASSES = 10;
+static const int STOCKHAM_LOCAL_MAX = 4096;             // upper bound of the single kernel transform size
+static const int STOCKHAM_WORK_GROUP_SIZE = 128;
+static const int STOCKHAM_TRANSPOSE_TILE = 16;          // same as TRANSPOSE_TILE in fftstockham.cl
+static const int VALIDATION_ELEMENTS = 1 << 20;        // upper bound of the values checked against the host reference
+static const int NAIVE_DFT_LIMIT = 256;                 // longer transforms use the radix-2 reference
+static const int BUTTERFLY_OPERATIONS = 5;             // floating point operations per value and radix-2 stage
 
 template <typename TItem>
 struct ComplexValue {
@@ -20,6 +38,38 @@ struct ComplexValue {
     TItem y;
 };
 
+/**
+ * Relative L2 and relative max error of device results against a reference.
+ * NaNs propagate into both norms.
+ */
+class ErrorNorms {
+private:
+    double _errorSum;
+    double _referenceSum;
+    double _maxError;
+    double _maxReference;
+
+public:
+    ErrorNorms() : _errorSum(0.0), _referenceSum(0.0), _maxError(0.0), _maxReference(0.0) { }
+
+    void Add(complex<double> value, complex<double> expected) {
+        const double error = abs(value - expected);
+        _errorSum += error * error;
+        _referenceSum += norm(expected);
+        if (!(error <= _maxError))
+            _maxError = error;
+        _maxReference = max(_maxReference, abs(expected));
+    }
+
+    double RelativeL2() const { return _referenceSum > 0.0 ? sqrt(_errorSum / _referenceSum) : sqrt(_errorSum); }
+
+    double RelativeMax() const { return _maxReference > 0.0 ? _maxError / _maxReference : _maxError; }
+};
+
+static ostream& operator<<(ostream& stream, const ErrorNorms& errors) {
+    return stream << "relative L2: " << errors.RelativeL2() << ", max: " << errors.RelativeMax();
+}
+
 template <typename TItem>
 int Fft::InitContext() {
     string compilerParams = GetCompilerFlags<TItem>();
@@ -30,8 +80,6 @@ int Fft::InitContext() {
         return -1;
 
     cl_int status = 0;
-    _checkKernel = make_shared<cl::Kernel>(*_program, "chk1D_512", &status);
-    CHECK_RETURN_ERROR(status);
     _forwardKernel = make_shared<cl::Kernel>(*_program, "fft1D_512", &status);
     CHECK_RETURN_ERROR(status);
     _inverseKernel = make_shared<cl::Kernel>(*_program, "ifft1D_512", &status);
@@ -46,56 +94,47 @@ void Fft::InitData() {
     if (sizeof(TItem) == 8)
         BUFFER_SIZE *= 2; // we want the same number of elements in both cases -> float vs double!
 
-    // 512 values in a block, every block is stored twice -> once for processing, once for validation
+    // 512 values in a block
     _blockSize = 512;
-    _blocksToProcessHalf = BUFFER_SIZE / (_blockSize * sizeof(ComplexValue<TItem>) * 2);
-    _blocksToProcess = _blocksToProcessHalf * 2;
-    _numberOfFFTValuesHalf = _blocksToProcessHalf * _blockSize;
+    _blocksToProcess = BUFFER_SIZE / (_blockSize * sizeof(ComplexValue<TItem>));
+    const int numberOfFFTValues = _blocksToProcess * _blockSize;
 
     // allocate buffer on host for input data
     vector<ComplexValue<TItem>> source;
-    source.resize(_numberOfFFTValuesHalf * 2);
+    source.resize(numberOfFFTValues);
 
     // init source memory on host
-    random_device randomDevice;
-    default_random_engine engine(randomDevice());
+    default_random_engine engine(RANDOM_SEED);
     std::uniform_real_distribution<double> dist(0, 1);
 
-    for (int i = 0; i < _numberOfFFTValuesHalf; ++i) {
-        source[i].x = static_cast<TItem>(dist(engine) * 2 - 1);      // the values we process
+    for (int i = 0; i < numberOfFFTValues; ++i) {
+        source[i].x = static_cast<TItem>(dist(engine) * 2 - 1);
         source[i].y = static_cast<TItem>(dist(engine) * 2 - 1);
-        source[i + _numberOfFFTValuesHalf].x = source[i].x;    // backup for validation (?)
-        source[i + _numberOfFFTValuesHalf].y = source[i].y;
-        // originally I thought these values are used as reference for the check kernel, but fft implementation from SHOC transforms all values
-        // therefore to stay consistent we do the same thing...
-        // (see FFT.cpp in SHOC where they pass n_ffts instead of half_n_ffts to the transform function)
-        // --> do not use the fft.cl implementation for productive code, not sure if the result is correct
     }
 
+    // the first blocks are checked against the host reference
+    _validationInput.resize(min(numberOfFFTValues, VALIDATION_ELEMENTS));
+    for (size_t i = 0; i < _validationInput.size(); ++i)
+        _validationInput[i] = complex<double>(source[i].x, source[i].y);
+
     // allocate device memory
     _processBufferDevice = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, BUFFER_SIZE);
-    _validationBufferDevice = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, sizeof(cl_int));
 
     // copy data to device
     cl::CommandQueue& queue = _controller->Queue();
-    cl_int defaultValidationResult = 0;
-    queue.enqueueWriteBuffer(*_validationBufferDevice, CL_TRUE, 0, sizeof(defaultValidationResult), &defaultValidationResult); // set check flag to zero
     queue.enqueueWriteBuffer(*_processBufferDevice, CL_TRUE, 0, BUFFER_SIZE, &source[0]); // copy source data
     queue.finish();
 
     // set kernel arguments
     _forwardKernel->setArg(0, *_processBufferDevice);
     _inverseKernel->setArg(0, *_processBufferDevice);
-    _checkKernel->setArg(0, *_processBufferDevice);
-    _checkKernel->setArg(1, _numberOfFFTValuesHalf);
-    _checkKernel->setArg(2, *_validationBufferDevice);
 }
 
+template <typename TItem>
 void Fft::ExecuteKernels() {
     cl::CommandQueue& queue = _controller->Queue();
     cl::NDRange localWorkSize(64);
     cl::NDRange globalWorkSizeTransform(64 * _blocksToProcess);
-    cl::NDRange globalWorkSizeCheck(64 * _blocksToProcessHalf);
     cl_long endTime, startTime;
     cl_int status = CL_SUCCESS;
     cl::Event event;
@@ -103,6 +142,24 @@ void Fft::ExecuteKernels() {
     int64_t totalTimeCPU = 0;
     int64_t totalTimeGPU = 0;
 
+    // untimed forward and inverse transform for the validation
+    const size_t validationSize = _validationInput.size() * sizeof(ComplexValue<TItem>);
+    vector<ComplexValue<TItem>> forward(_validationInput.size());
+    vector<ComplexValue<TItem>> roundTrip(_validationInput.size());
+
+    status = queue.enqueueNDRangeKernel(*_forwardKernel, cl::NullRange, globalWorkSizeTransform, localWorkSize, nullptr, &event);
+    WAIT_AND_CHECK(event, status);
+    if (ValidationEnabled()) {
+        status = queue.enqueueReadBuffer(*_processBufferDevice, CL_TRUE, 0, validationSize, &forward[0]);
+        CHECK(status);
+    }
+    status = queue.enqueueNDRangeKernel(*_inverseKernel, cl::NullRange, globalWorkSizeTransform, localWorkSize, nullptr, &event);
+    WAIT_AND_CHECK(event, status);
+    if (ValidationEnabled()) {
+        status = queue.enqueueReadBuffer(*_processBufferDevice, CL_TRUE, 0, validationSize, &roundTrip[0]);
+        CHECK(status);
+    }
+
     for (int i = 0; i < PASSES; ++i) {
         // forward
         _timer.Remember();
@@ -123,39 +180,574 @@ void Fft::ExecuteKernels() {
         event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
         event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
         totalTimeGPU += (endTime - startTime);
+    }
 
-        // check
-        cl_int result = 0;
-        status = queue.enqueueNDRangeKernel(*_checkKernel, cl::NullRange, globalWorkSizeCheck, localWorkSize, nullptr, &event);
-        WAIT_AND_CHECK(event, status);
+    cout << "CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
 
-        status = queue.enqueueReadBuffer(*_validationBufferDevice, CL_TRUE, 0, sizeof(result), &result, nullptr, &event);
-        WAIT_AND_CHECK(event, status);
+    if (!ValidationEnabled())
+        return;
+
+    // the host reference runs after the timed passes, it would compete with cpu devices otherwise
+    vector<complex<double>> expected = _validationInput;
+    ReferenceTransform(expected, vector<int>{ _blockSize }, -1.0);
 
-        if (result != 0) {
-            cerr << "FFT/IFFT result invalid" << endl;
+    // ifft1D_512 is scaled, the round trip has to return the input
+    ErrorNorms forwardErrors, roundTripErrors;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        forwardErrors.Add(complex<double>(forward[i].x, forward[i].y), expected[i]);
+        roundTripErrors.Add(complex<double>(roundTrip[i].x, roundTrip[i].y), _validationInput[i]);
+    }
+
+    cout << "  forward " << forwardErrors << "; round trip " << roundTripErrors << endl;
+    ValidateErrors<TItem>("forward", forwardErrors.RelativeL2(), forwardErrors.RelativeMax(), _blockSize, 1);
+    ValidateErrors<TItem>("round trip", roundTripErrors.RelativeL2(), roundTripErrors.RelativeMax(), _blockSize, 2);
+}
+
+void Fft::ReferenceDft1D(complex<double>* data, int n, int stride, double sign) {
+    vector<complex<double>> input(n);
+    vector<complex<double>> roots(n);
+    for (int i = 0; i < n; ++i) {
+        input[i] = data[i * stride];
+        roots[i] = polar(1.0, sign * 2 * M_PI * i / n);
+    }
+
+    for (int k = 0; k < n; ++k) {
+        complex<double> sum = 0.0;
+        for (int j = 0; j < n; ++j)
+            sum += input[j] * roots[(static_cast<int64_t>(j) * k) % n];
+        data[k * stride] = sum;
+    }
+}
+
+void Fft::ReferenceFft1D(complex<double>* data, int n, int stride, double sign, bool parallel) {
+    auto run = [parallel](int64_t count, function<void(int64_t, int64_t)> body) {
+        if (parallel)
+            ParallelFor(count, body);
+        else
+            body(0, count);
+    };
+
+    int log2n = 0;
+    while ((1 << log2n) < n)
+        ++log2n;
+
+    // bit reversal permutation, every pair is swapped by its smaller index
+    run(n, [&](int64_t begin, int64_t end) {
+            for (int64_t i = begin; i < end; ++i) {
+                int64_t j = 0;
+                for (int bit = 0; bit < log2n; ++bit)
+                    j |= ((i >> bit) & 1) << (log2n - 1 - bit);
+                if (i < j)
+                    swap(data[i * stride], data[j * stride]);
+            }
+        });
+
+    vector<complex<double>> twiddles(n / 2);
+    run(n / 2, [&](int64_t begin, int64_t end) {
+            for (int64_t k = begin; k < end; ++k)
+                twiddles[k] = polar(1.0, sign * 2 * M_PI * k / n);
+        });
+
+    for (int length = 2; length <= n; length <<= 1) {
+        const int half = length / 2;
+        const int step = n / length;
+        run(n / 2, [&](int64_t begin, int64_t end) {
+                for (int64_t b = begin; b < end; ++b) {
+                    const int64_t i = (b / half) * length + (b % half);
+                    complex<double> u = data[i * stride];
+                    complex<double> v = data[(i + half) * stride] * twiddles[(b % half) * step];
+                    data[i * stride] = u + v;
+                    data[(i + half) * stride] = u - v;
+                }
+            });
+    }
+}
+
+void Fft::ReferenceTransform(vector<complex<double>>& data, const vector<int>& dims, double sign) {
+    const int64_t total = static_cast<int64_t>(data.size());
+    int64_t stride = 1;
+
+    for (int n : dims) {
+        const int64_t lines = total / n;
+
+        if (lines == 1 && n > NAIVE_DFT_LIMIT) {
+            ReferenceFft1D(&data[0], n, 1, sign, true);
+        } else {
+            ParallelFor(lines, [&](int64_t begin, int64_t end) {
+                    for (int64_t line = begin; line < end; ++line) {
+                        complex<double>* first = &data[(line / stride) * n * stride + (line % stride)];
+                        if (n <= NAIVE_DFT_LIMIT)
+                            ReferenceDft1D(first, n, static_cast<int>(stride), sign);
+                        else
+                            ReferenceFft1D(first, n, static_cast<int>(stride), sign, false);
+                    }
+                });
         }
+
+        stride *= n;
     }
+}
 
-    cout << "CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
+template <typename TItem>
+bool Fft::ValidateErrors(const string& testName, double relativeL2, double relativeMax, int64_t n, int passes) {
+    int stages = 0;
+    while ((static_cast<int64_t>(1) << stages) < n)
+        ++stages;
+
+    // NaN never passes the comparison
+    const double tolerance = AccumulatedTolerance<TItem>(static_cast<int64_t>(BUTTERFLY_OPERATIONS) * stages * passes);
+    const double norms[] = { relativeL2, relativeMax };
+    return Validate(testName, 2, [&](int64_t i) -> bool { return norms[i] <= tolerance; });
+}
+
+template <typename TItem>
+int Fft::InitStockham() {
+    // two complex buffers of the local transform have to fit into local memory
+    cl_ulong localMemorySize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_LOCAL_MEM_SIZE, &localMemorySize);
+    _localFftMax = STOCKHAM_LOCAL_MAX;
+    while (_localFftMax > 1 && static_cast<cl_ulong>(_localFftMax) * 2 * sizeof(ComplexValue<TItem>) > localMemorySize)
+        _localFftMax /= 2;
+
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DLOCAL_FFT_MAX=" + to_string(_localFftMax);
+    _stockhamProgram = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "fftstockham.cl", compilerParams);
+
+    if (_stockhamProgram.get() == nullptr)
+        return -1;
+
+    cl_int status = 0;
+    _radix2Kernel = make_shared<cl::Kernel>(*_stockhamProgram, "StockhamRadix2", &status);
+    CHECK_RETURN_ERROR(status);
+    _radix4Kernel = make_shared<cl::Kernel>(*_stockhamProgram, "StockhamRadix4", &status);
+    CHECK_RETURN_ERROR(status);
+    _radix8Kernel = make_shared<cl::Kernel>(*_stockhamProgram, "StockhamRadix8", &status);
+    CHECK_RETURN_ERROR(status);
+    _localFftKernel = make_shared<cl::Kernel>(*_stockhamProgram, "StockhamLocal", &status);
+    CHECK_RETURN_ERROR(status);
+    _transposeKernel = make_shared<cl::Kernel>(*_stockhamProgram, "TransposeComplex", &status);
+    CHECK_RETURN_ERROR(status);
+    _realPostKernel = make_shared<cl::Kernel>(*_stockhamProgram, "RealPostProcess", &status);
+    CHECK_RETURN_ERROR(status);
+    _realPreKernel = make_shared<cl::Kernel>(*_stockhamProgram, "RealPreProcess", &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+vector<int> Fft::CreatePlan(int n) {
+    int log2n = 0;
+    while ((1 << log2n) < n)
+        ++log2n;
+
+    // as many radix 8 passes as possible, the remainder is handled by a radix 4 or 2 pass
+    vector<int> radices;
+    while (log2n > 0) {
+        if (log2n % 3 == 0 || log2n > 4) {
+            radices.push_back(8);
+            log2n -= 3;
+        } else if (log2n % 2 == 0) {
+            radices.push_back(4);
+            log2n -= 2;
+        } else {
+            radices.push_back(2);
+            log2n -= 1;
+        }
+    }
+    return radices;
+}
+
+template <typename TItem>
+int Fft::EnqueueFft1D(shared_ptr<cl::Buffer>& current, shared_ptr<cl::Buffer>& other, int n, int batch, int sign, vector<cl::Event>& events) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const TItem signValue = static_cast<TItem>(sign);
+    cl_int status = CL_SUCCESS;
+
+    if (n <= _localFftMax) {
+        const int localSize = min(max(n / 8, 1), STOCKHAM_WORK_GROUP_SIZE);
+        _localFftKernel->setArg(0, *current);
+        _localFftKernel->setArg(1, *other);
+        _localFftKernel->setArg(2, n);
+        _localFftKernel->setArg(3, signValue);
+
+        events.push_back(cl::Event());
+        status = queue.enqueueNDRangeKernel(*_localFftKernel, cl::NullRange, cl::NDRange(localSize * batch), cl::NDRange(localSize), nullptr, &events.back());
+        swap(current, other);
+        return status;
+    }
+
+    int ns = 1;
+    for (int radix : CreatePlan(n)) {
+        auto kernel = radix == 8 ? _radix8Kernel : (radix == 4 ? _radix4Kernel : _radix2Kernel);
+        const int butterflies = n / radix;
+
+        kernel->setArg(0, *current);
+        kernel->setArg(1, *other);
+        kernel->setArg(2, n);
+        kernel->setArg(3, ns);
+        kernel->setArg(4, signValue);
+
+        events.push_back(cl::Event());
+        status = queue.enqueueNDRangeKernel(*kernel, cl::NullRange, cl::NDRange(RoundToMultipleOf(butterflies, STOCKHAM_WORK_GROUP_SIZE), batch),
+            cl::NDRange(STOCKHAM_WORK_GROUP_SIZE, 1), nullptr, &events.back());
+        if (status != CL_SUCCESS)
+            return status;
+
+        swap(current, other);
+        ns *= radix;
+    }
+
+    return status;
+}
+
+int Fft::EnqueueTranspose(shared_ptr<cl::Buffer>& current, shared_ptr<cl::Buffer>& other, int rows, int cols, vector<cl::Event>& events) {
+    cl::CommandQueue& queue = _controller->Queue();
+
+    _transposeKernel->setArg(0, *current);
+    _transposeKernel->setArg(1, *other);
+    _transposeKernel->setArg(2, rows);
+    _transposeKernel->setArg(3, cols);
+
+    events.push_back(cl::Event());
+    cl_int status = queue.enqueueNDRangeKernel(*_transposeKernel, cl::NullRange,
+        cl::NDRange(RoundToMultipleOf(cols, STOCKHAM_TRANSPOSE_TILE), RoundToMultipleOf(rows, STOCKHAM_TRANSPOSE_TILE)),
+        cl::NDRange(STOCKHAM_TRANSPOSE_TILE, STOCKHAM_TRANSPOSE_TILE), nullptr, &events.back());
+    swap(current, other);
+    return status;
+}
+
+template <typename TItem>
+int Fft::EnqueueFft(shared_ptr<cl::Buffer>& current, shared_ptr<cl::Buffer>& other, const vector<int>& dims, int batch, int sign, vector<cl::Event>& events) {
+    int total = batch;
+    for (int n : dims)
+        total *= n;
+
+    if (dims.size() == 1)
+        return EnqueueFft1D<TItem>(current, other, dims[0], batch, sign, events);
+
+    // [z][y][x] -> [x][z][y] -> [y][x][z] -> [z][y][x]
+    cl_int status = CL_SUCCESS;
+    for (int n : dims) {
+        status = EnqueueFft1D<TItem>(current, other, n, total / n, sign, events);
+        if (status != CL_SUCCESS)
+            return status;
+
+        status = EnqueueTranspose(current, other, total / n, n, events);
+        if (status != CL_SUCCESS)
+            return status;
+    }
+
+    return status;
+}
+
+template <typename TItem>
+void Fft::RunStockham(const vector<int>& dims, int batch) {
+    cl::CommandQueue& queue = _controller->Queue();
+
+    int n = 1;
+    string shape = "";
+    for (int dim : dims) {
+        n *= dim;
+        shape += (shape.empty() ? "" : "x") + to_string(dim);
+    }
+    const int total = n * batch;
+    const size_t bufferSize = static_cast<size_t>(total) * sizeof(ComplexValue<TItem>);
+
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    if (bufferSize > maxAllocationSize) {
+        cout << "  " << shape << " exceeds the maximum allocation size, skipped" << endl;
+        return;
+    }
+
+    vector<ComplexValue<TItem>> input(total);
+    default_random_engine engine(RANDOM_SEED);
+    uniform_real_distribution<double> dist(-1, 1);
+    for (auto& value : input) {
+        value.x = static_cast<TItem>(dist(engine));
+        value.y = static_cast<TItem>(dist(engine));
+    }
+
+    _stockhamBufferA = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    _stockhamBufferB = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    vector<cl::Event> events;
+    cl_long startTime, endTime;
+    int64_t totalTimeCPU = 0;
+    int64_t totalTimeGPU = 0;
+    shared_ptr<cl::Buffer> result = nullptr;
+    shared_ptr<cl::Buffer> scratch = nullptr;
+
+    // the first pass is not timed
+    for (int pass = 0; pass <= STOCKHAM_PASSES; ++pass) {
+        result = _stockhamBufferA;
+        scratch = _stockhamBufferB;
+
+        // transforms are not scaled, every pass starts with the original input to keep the values bounded
+        cl_int status = queue.enqueueWriteBuffer(*result, CL_TRUE, 0, bufferSize, &input[0]);
+        CHECK(status);
+
+        events.clear();
+        _timer.Remember();
+        status = EnqueueFft<TItem>(result, scratch, dims, batch, -1, events);
+        CHECK(status);
+        status = queue.finish();
+        CHECK(status);
+
+        if (pass == 0)
+            continue;
+
+        totalTimeCPU += _timer.Diff();
+        for (auto& event : events) {
+            event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+            event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+            totalTimeGPU += (endTime - startTime);
+        }
+    }
+
+    totalTimeCPU /= STOCKHAM_PASSES;
+    totalTimeGPU /= STOCKHAM_PASSES;
+
+    const size_t kernelCount = events.size();
+    double flops = 5.0 * n * log2(static_cast<double>(n)) * batch;
+    cout << "  " << shape << " (batch " << batch << ", " << kernelCount << " kernels) CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU;
+    if (totalTimeGPU > 0)
+        cout << ", " << flops / totalTimeGPU << " GFLOP/s";
+    cout << endl;
+
+    if (!ValidationEnabled())
+        return;
+
+    // read the forward result of the first transforms and transform it back (unscaled, the round trip yields n * x)
+    const int checkedTransforms = max(1, min(batch, VALIDATION_ELEMENTS / n));
+    const size_t checkedSize = static_cast<size_t>(checkedTransforms) * n;
+    vector<ComplexValue<TItem>> forward(checkedSize);
+    vector<ComplexValue<TItem>> roundTrip(checkedSize);
+    cl_int status = queue.enqueueReadBuffer(*result, CL_TRUE, 0, checkedSize * sizeof(ComplexValue<TItem>), &forward[0]);
+    CHECK(status);
+    events.clear();
+    status = EnqueueFft<TItem>(result, scratch, dims, batch, 1, events);
+    CHECK(status);
+    status = queue.enqueueReadBuffer(*result, CL_TRUE, 0, checkedSize * sizeof(ComplexValue<TItem>), &roundTrip[0]);
+    CHECK(status);
+
+    // the host reference runs after the timed passes, it would compete with cpu devices otherwise
+    vector<complex<double>> expected(checkedSize);
+    for (size_t i = 0; i < checkedSize; ++i)
+        expected[i] = complex<double>(input[i].x, input[i].y);
+    ReferenceTransform(expected, dims, -1.0);
+
+    ErrorNorms forwardErrors, roundTripErrors;
+    for (size_t i = 0; i < checkedSize; ++i) {
+        forwardErrors.Add(complex<double>(forward[i].x, forward[i].y), expected[i]);
+        roundTripErrors.Add(complex<double>(roundTrip[i].x, roundTrip[i].y), complex<double>(input[i].x, input[i].y) * static_cast<double>(n));
+    }
+
+    cout << "    forward " << forwardErrors << "; round trip " << roundTripErrors << endl;
+    ValidateErrors<TItem>(shape + " forward", forwardErrors.RelativeL2(), forwardErrors.RelativeMax(), n, 1);
+    ValidateErrors<TItem>(shape + " round trip", roundTripErrors.RelativeL2(), roundTripErrors.RelativeMax(), n, 2);
+}
+
+template <typename TItem>
+void Fft::RunReal(int n, int batch) {
+    cl::CommandQueue& queue = _controller->Queue();
+
+    const int m = n / 2;
+    const size_t complexSize = static_cast<size_t>(n) * batch * sizeof(ComplexValue<TItem>);
+    const size_t realSize = static_cast<size_t>(n) * batch * sizeof(TItem);
+    const size_t spectrumSize = static_cast<size_t>(m + 1) * batch * sizeof(ComplexValue<TItem>);
+
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    if (complexSize > maxAllocationSize) {
+        cout << "  " << n << " exceeds the maximum allocation size, skipped" << endl;
+        return;
+    }
+
+    vector<TItem> input(static_cast<size_t>(n) * batch);
+    vector<ComplexValue<TItem>> complexInput(input.size());
+    default_random_engine engine(RANDOM_SEED);
+    uniform_real_distribution<double> dist(-1, 1);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = static_cast<TItem>(dist(engine));
+        complexInput[i].x = input[i];
+        complexInput[i].y = 0;
+    }
+
+    _stockhamBufferA = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, complexSize);
+    _stockhamBufferB = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, complexSize);
+    _realSpectrumBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, spectrumSize);
+
+    cl::NDRange localWorkSize(STOCKHAM_WORK_GROUP_SIZE, 1);
+    cl::NDRange globalWorkSizePost(RoundToMultipleOf(m + 1, STOCKHAM_WORK_GROUP_SIZE), batch);
+    cl::NDRange globalWorkSizePre(RoundToMultipleOf(m, STOCKHAM_WORK_GROUP_SIZE), batch);
+    shared_ptr<cl::Buffer> result = nullptr;
+
+    // uploads the input, runs the transform STOCKHAM_PASSES + 1 times (the first one is not timed)
+    // and returns the average gpu time, -1 on error
+    auto timeTransform = [&](cl::Buffer& target, const void* data, size_t size, function<cl_int(vector<cl::Event>&)> enqueue) -> int64_t {
+        vector<cl::Event> events;
+        cl_long startTime, endTime;
+        int64_t timeGPU = 0;
+
+        for (int pass = 0; pass <= STOCKHAM_PASSES; ++pass) {
+            cl_int status = queue.enqueueWriteBuffer(target, CL_TRUE, 0, size, data);
+            events.clear();
+            if (status == CL_SUCCESS)
+                status = enqueue(events);
+            if (status == CL_SUCCESS)
+                status = queue.finish();
+            if (status != CL_SUCCESS) {
+                cerr << "fft: real transform failed, error code: " << status << endl;
+                return -1;
+            }
+
+            for (auto& event : events) {
+                event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+                event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+                timeGPU += pass > 0 ? (endTime - startTime) : 0;
+            }
+        }
+
+        return timeGPU / STOCKHAM_PASSES;
+    };
+
+    // complex transform of the same logical length
+    int64_t complexTimeGPU = timeTransform(*_stockhamBufferA, &complexInput[0], complexSize, [&](vector<cl::Event>& events) -> cl_int {
+            auto current = _stockhamBufferA;
+            auto other = _stockhamBufferB;
+            return EnqueueFft1D<TItem>(current, other, n, batch, -1, events);
+        });
+
+    // real-to-complex, the real input is interpreted as m complex values
+    int64_t forwardTimeGPU = timeTransform(*_stockhamBufferA, &input[0], realSize, [&](vector<cl::Event>& events) -> cl_int {
+            auto current = _stockhamBufferA;
+            auto other = _stockhamBufferB;
+            cl_int status = EnqueueFft1D<TItem>(current, other, m, batch, -1, events);
+            if (status != CL_SUCCESS)
+                return status;
+
+            _realPostKernel->setArg(0, *current);
+            _realPostKernel->setArg(1, *_realSpectrumBuffer);
+            _realPostKernel->setArg(2, m);
+            events.push_back(cl::Event());
+            return queue.enqueueNDRangeKernel(*_realPostKernel, cl::NullRange, globalWorkSizePost, localWorkSize, nullptr, &events.back());
+        });
+
+    vector<ComplexValue<TItem>> spectrum(static_cast<size_t>(m + 1) * batch);
+    vector<TItem> output(input.size());
+    cl_int status = queue.enqueueReadBuffer(*_realSpectrumBuffer, CL_TRUE, 0, spectrumSize, &spectrum[0]);
+    CHECK(status);
+
+    // complex-to-real on the spectrum computed above
+    int64_t inverseTimeGPU = timeTransform(*_realSpectrumBuffer, &spectrum[0], spectrumSize, [&](vector<cl::Event>& events) -> cl_int {
+            auto current = _stockhamBufferA;
+            auto other = _stockhamBufferB;
+            _realPreKernel->setArg(0, *_realSpectrumBuffer);
+            _realPreKernel->setArg(1, *current);
+            _realPreKernel->setArg(2, m);
+            events.push_back(cl::Event());
+            cl_int status = queue.enqueueNDRangeKernel(*_realPreKernel, cl::NullRange, globalWorkSizePre, localWorkSize, nullptr, &events.back());
+            if (status != CL_SUCCESS)
+                return status;
+
+            status = EnqueueFft1D<TItem>(current, other, m, batch, 1, events);
+            result = current;
+            return status;
+        });
+
+    if (complexTimeGPU < 0 || forwardTimeGPU < 0 || inverseTimeGPU < 0)
+        return;
+
+    cout << "  " << n << " (batch " << batch << ") complex GPU: " << complexTimeGPU
+        << ", R2C GPU: " << forwardTimeGPU << ", C2R GPU: " << inverseTimeGPU << endl;
+    if (forwardTimeGPU > 0 && inverseTimeGPU > 0) {
+        cout << "    R2C speedup vs. complex: " << static_cast<double>(complexTimeGPU) / forwardTimeGPU
+            << ", C2R speedup vs. complex: " << static_cast<double>(complexTimeGPU) / inverseTimeGPU << endl;
+    }
+
+    if (!ValidationEnabled())
+        return;
+
+    status = queue.enqueueReadBuffer(*result, CL_TRUE, 0, realSize, &output[0]);
+    CHECK(status);
+
+    // host reference of the first transforms, computed after the timed passes
+    const int checkedTransforms = max(1, min(batch, VALIDATION_ELEMENTS / n));
+    vector<complex<double>> expected(static_cast<size_t>(checkedTransforms) * n);
+    for (size_t i = 0; i < expected.size(); ++i)
+        expected[i] = complex<double>(input[i], 0.0);
+    ReferenceTransform(expected, vector<int>{ n }, -1.0);
+
+    // check the first transforms of the batch: spectrum against the host reference, round trip against n * x
+    ErrorNorms forwardErrors, roundTripErrors;
+    for (int t = 0; t < checkedTransforms; ++t) {
+        for (int k = 0; k <= m; ++k) {
+            const auto& value = spectrum[t * (m + 1) + k];
+            forwardErrors.Add(complex<double>(value.x, value.y), expected[t * n + k]);
+        }
+
+        for (int i = 0; i < n; ++i)
+            roundTripErrors.Add(complex<double>(output[t * n + i], 0.0), complex<double>(input[t * n + i], 0.0) * static_cast<double>(n));
+    }
+
+    cout << "    R2C " << forwardErrors << "; round trip " << roundTripErrors << endl;
+    ValidateErrors<TItem>(to_string(n) + " R2C", forwardErrors.RelativeL2(), forwardErrors.RelativeMax(), n, 1);
+    ValidateErrors<TItem>(to_string(n) + " R2C/C2R round trip", roundTripErrors.RelativeL2(), roundTripErrors.RelativeMax(), n, 2);
+}
+
+template <typename TItem>
+void Fft::RunStockhamSuite() {
+    if (InitStockham<TItem>() != 0)
+        return;
+
+    cout << "Stockham 1D (local transforms up to " << _localFftMax << ")" << endl;
+    for (int n : STOCKHAM_1D_SIZES)
+        RunStockham<TItem>(vector<int>{ n }, max(1, STOCKHAM_ELEMENTS / n));
+
+    cout << "Stockham 2D" << endl;
+    for (int n : STOCKHAM_2D_SIZES)
+        RunStockham<TItem>(vector<int>{ n, n }, 1);
+
+    cout << "Stockham 3D" << endl;
+    for (int n : STOCKHAM_3D_SIZES)
+        RunStockham<TItem>(vector<int>{ n, n, n }, 1);
+
+    cout << "Real input (R2C/C2R) vs. complex transform of equal length" << endl;
+    for (int n : REAL_SIZES)
+        RunReal<TItem>(n, max(1, STOCKHAM_ELEMENTS / n));
 }
 
 void Fft::Cleanup() {
     _processBufferDevice.reset();
-    _validationBufferDevice.reset();
-    _checkKernel.reset();
+    _validationInput.clear();
     _forwardKernel.reset();
     _inverseKernel.reset();
     _program.reset();
+
+    _stockhamBufferA.reset();
+    _stockhamBufferB.reset();
+    _radix2Kernel.reset();
+    _radix4Kernel.reset();
+    _radix8Kernel.reset();
+    _localFftKernel.reset();
+    _transposeKernel.reset();
+    _realSpectrumBuffer.reset();
+    _realPostKernel.reset();
+    _realPreKernel.reset();
+    _stockhamProgram.reset();
 }
 
 template <typename TItem>
 void Fft::RunInternal() {
     if (InitContext<TItem>() == 0) {
         InitData<TItem>();
-        ExecuteKernels();
+        ExecuteKernels<TItem>();
         Cleanup();
     }
+
+    RunStockhamSuite<TItem>();
+    Cleanup();
 }
 
 void Fft::Run() {
@@ -3,7 +3,10 @@
 
 #include "../benchmarkbase.hpp"
 
+#include <complex>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace benchmarks {
 
@@ -13,17 +16,29 @@ namespace benchmarks {
 class Fft : public BenchmarkBase {
 private:
 	std::shared_ptr<cl::Buffer> _processBufferDevice = nullptr;
-	std::shared_ptr<cl::Buffer> _validationBufferDevice = nullptr;
-	std::shared_ptr<cl::Kernel> _checkKernel = nullptr;
 	std::shared_ptr<cl::Kernel> _forwardKernel = nullptr;
 	std::shared_ptr<cl::Kernel> _inverseKernel = nullptr;
 	std::shared_ptr<cl::Program> _program = nullptr;
 
 	int _totalBufferSize = -1;
 	int _blockSize = -1;
-	int _blocksToProcessHalf = -1;
 	int _blocksToProcess = -1;
-	int _numberOfFFTValuesHalf = -1;
+
+	std::vector<std::complex<double>> _validationInput;
+
+	std::shared_ptr<cl::Buffer> _stockhamBufferA = nullptr;
+	std::shared_ptr<cl::Buffer> _stockhamBufferB = nullptr;
+	std::shared_ptr<cl::Kernel> _radix2Kernel = nullptr;
+	std::shared_ptr<cl::Kernel> _radix4Kernel = nullptr;
+	std::shared_ptr<cl::Kernel> _radix8Kernel = nullptr;
+	std::shared_ptr<cl::Kernel> _localFftKernel = nullptr;
+	std::shared_ptr<cl::Kernel> _transposeKernel = nullptr;
+	std::shared_ptr<cl::Buffer> _realSpectrumBuffer = nullptr;
+	std::shared_ptr<cl::Kernel> _realPostKernel = nullptr;
+	std::shared_ptr<cl::Kernel> _realPreKernel = nullptr;
+	std::shared_ptr<cl::Program> _stockhamProgram = nullptr;
+
+	int _localFftMax = 0;
 
 	/**
 	 * Initialize program instance and kernels.
@@ -38,10 +53,41 @@ private:
 	void InitData();
 
 	/**
-	 * Execute all kernels. FFT -> Inverse FFT and CHECK
+	 * Execute all kernels. FFT -> Inverse FFT, the first transforms are checked against the host reference.
 	 */
+	template <typename TItem>
 	void ExecuteKernels();
 
+	/**
+	 * Naive O(n^2) DFT of the elements data[0], data[stride], ..., data[(n - 1) * stride].
+	 */
+	static void ReferenceDft1D(std::complex<double>* data, int n, int stride, double sign);
+
+	/**
+	 * Iterative radix-2 FFT of the elements data[0], data[stride], ..., data[(n - 1) * stride].
+	 *
+	 * @param parallel distribute the butterflies of every stage over all hardware threads
+	 */
+	static void ReferenceFft1D(std::complex<double>* data, int n, int stride, double sign, bool parallel);
+
+	/**
+	 * Unscaled host transform in double precision used as reference (dims[0] is the contiguous dimension,
+	 * data may contain a batch of transforms). Short lines use the naive DFT, long lines the radix-2 FFT.
+	 * Independent lines are distributed over all hardware threads.
+	 *
+	 * @param sign -1 for the forward and +1 for the inverse transform
+	 */
+	static void ReferenceTransform(std::vector<std::complex<double>>& data, const std::vector<int>& dims, double sign);
+
+	/**
+	 * Marks a transform INVALID if its relative L2 or max error exceeds the rounding error
+	 * accumulated over the butterfly stages of an n-point transform.
+	 *
+	 * @param passes number of transforms the values went through, 2 for a round trip
+	 */
+	template <typename TItem>
+	bool ValidateErrors(const std::string& testName, double relativeL2, double relativeMax, int64_t n, int passes);
+
 	/**
 	 * Release all resources.
 	 */
@@ -53,9 +99,64 @@ private:
     template <typename TItem>
     void RunInternal();
 
+	/**
+	 * Compile fftstockham.cl. Transforms up to the largest power of two fitting twice
+	 * into local memory are computed by a single kernel.
+	 */
+	template <typename TItem>
+	int InitStockham();
+
+	/**
+	 * Split a power-of-two size into a sequence of radix 8, 4 and 2 passes.
+	 */
+	std::vector<int> CreatePlan(int n);
+
+	/**
+	 * Enqueue a batch of 1D transforms of length n. current contains the input and will contain the output,
+	 * the buffers are swapped for every pass. Events of all enqueued kernels are appended to events.
+	 *
+	 * @param sign -1 for the forward and +1 for the unscaled inverse transform
+	 */
+	template <typename TItem>
+	int EnqueueFft1D(std::shared_ptr<cl::Buffer>& current, std::shared_ptr<cl::Buffer>& other, int n, int batch, int sign, std::vector<cl::Event>& events);
+
+	/**
+	 * Enqueue the transposition of a rows x cols matrix from current to other and swap the buffers.
+	 */
+	int EnqueueTranspose(std::shared_ptr<cl::Buffer>& current, std::shared_ptr<cl::Buffer>& other, int rows, int cols, std::vector<cl::Event>& events);
+
+	/**
+	 * Enqueue a multi-dimensional transform (dims[0] is the contiguous dimension).
+	 * Every dimension is transformed as a batch of 1D transforms along the contiguous dimension,
+	 * followed by a transposition which rotates the next dimension into the contiguous position.
+	 * A batch of 1D transforms is a single dimension with batch > 1.
+	 */
+	template <typename TItem>
+	int EnqueueFft(std::shared_ptr<cl::Buffer>& current, std::shared_ptr<cl::Buffer>& other, const std::vector<int>& dims, int batch, int sign, std::vector<cl::Event>& events);
+
+	/**
+	 * Validate, time and report GFLOP/s (5 N log2(N) per transform) for the given shape.
+	 */
+	template <typename TItem>
+	void RunStockham(const std::vector<int>& dims, int batch);
+
+	/**
+	 * Real-to-complex and complex-to-real transforms of length n (packed into complex transforms of length n / 2),
+	 * compared with the complex transform of the same length.
+	 */
+	template <typename TItem>
+	void RunReal(int n, int batch);
+
+	/**
+	 * Execute all 1D, 2D and 3D shapes with the Stockham kernels.
+	 */
+	template <typename TItem>
+	void RunStockhamSuite();
+
 public:
     explicit Fft(std::shared_ptr<ComputeController> controller)
-        : BenchmarkBase(controller) {
+        : BenchmarkBase(controller)
+        , _validationInput() {
 
     }
 
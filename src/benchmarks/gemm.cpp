@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <random>
+#include <type_traits>
+#include <vector>
 
 #include "../clglobal.hpp"
 #include "../computecontroller.hpp"
@@ -14,6 +16,17 @@ static const float  BETA = 1.0f;
 static const int    MATRIX_SIZE = 1024;
 static const int    PASSES = 10;
 
+// the integer kernels overflow, the reference accumulates in unsigned arithmetic to get the same wrap around
+template <typename TItem, bool = is_integral<TItem>::value>
+struct Accumulator {
+    typedef double Type;
+};
+
+template <typename TItem>
+struct Accumulator<TItem, true> {
+    typedef typename make_unsigned<TItem>::type Type;
+};
+
 template <typename TItem>
 int Gemm::InitContext() {
     string compilerParams = GetCompilerFlags<TItem>();
@@ -135,6 +148,55 @@ void Gemm::ExecuteKernels() {
     cout << "CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
 }
 
+template <typename TItem>
+void Gemm::ValidateKernels() {
+    typedef typename Accumulator<TItem>::Type TAccumulator;
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::Event event;
+    cl::NDRange localWorkSize(16, 4);
+    cl::NDRange globalWorkSize( MATRIX_SIZE / 4, MATRIX_SIZE / 4 );
+    cl_int status = CL_SUCCESS;
+
+    vector<TItem> A(MATRIX_SIZE * MATRIX_SIZE), B(MATRIX_SIZE * MATRIX_SIZE), initialC(MATRIX_SIZE * MATRIX_SIZE), C(MATRIX_SIZE * MATRIX_SIZE);
+    status = queue.enqueueReadBuffer(*_sourceMatrixA, CL_TRUE, 0, _bufferSize, &A[0]);
+    status |= queue.enqueueReadBuffer(*_sourceMatrixB, CL_TRUE, 0, _bufferSize, &B[0]);
+    status |= queue.enqueueReadBuffer(*_sourceMatrixC, CL_TRUE, 0, _bufferSize, &initialC[0]);
+    CHECK(status);
+
+    // both kernels accumulate into C, so every validation run starts with the initial matrix
+    const TAccumulator alpha = static_cast<TAccumulator>(static_cast<TItem>(ALPHA));
+    const TAccumulator beta = static_cast<TAccumulator>(static_cast<TItem>(BETA));
+    const bool transposed[] = { false, true };
+
+    for (const bool transposeB : transposed) {
+        status = queue.enqueueCopyBuffer(*_sourceMatrixA, *_deviceMatrixA, 0, 0, _bufferSize);
+        status |= queue.enqueueCopyBuffer(*_sourceMatrixB, *_deviceMatrixB, 0, 0, _bufferSize);
+        status |= queue.enqueueCopyBuffer(*_sourceMatrixC, *_deviceMatrixC, 0, 0, _bufferSize);
+        status |= queue.finish();
+        CHECK(status);
+
+        status = queue.enqueueNDRangeKernel(transposeB ? *_ntKernel : *_nnKernel, cl::NullRange, globalWorkSize, localWorkSize, nullptr, &event);
+        WAIT_AND_CHECK(event, status);
+
+        status = queue.enqueueReadBuffer(*_deviceMatrixC, CL_TRUE, 0, _bufferSize, &C[0]);
+        CHECK(status);
+
+        // C(row, column) = alpha * sum_k A(row, k) * B(k, column) + beta * C(row, column)
+        ValidateResults(transposeB ? "sgemmNT" : "sgemmNN", &C[0], MATRIX_SIZE * MATRIX_SIZE, [&](int64_t i) -> TItem {
+                const int row = static_cast<int>(i % MATRIX_SIZE);
+                const int column = static_cast<int>(i / MATRIX_SIZE);
+
+                TAccumulator sum = 0;
+                for (int k = 0; k < MATRIX_SIZE; ++k) {
+                    const TItem b = transposeB ? B[column + k * MATRIX_SIZE] : B[k + column * MATRIX_SIZE];
+                    sum += static_cast<TAccumulator>(A[row + k * MATRIX_SIZE]) * static_cast<TAccumulator>(b);
+                }
+                return static_cast<TItem>(alpha * sum + beta * static_cast<TAccumulator>(initialC[i]));
+            });
+    }
+}
+
 void Gemm::Cleanup() {
     _deviceMatrixA.reset();
     _deviceMatrixB.reset();
@@ -153,6 +215,8 @@ void Gemm::RunInternal() {
         SetKernelArguments<TItem>();
         InitData<TItem>();
         ExecuteKernels();
+        if (ValidationEnabled())
+            ValidateKernels<TItem>();
         Cleanup();
     }
 }
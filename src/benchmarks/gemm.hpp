@@ -53,6 +53,13 @@ private:
      */
     void ExecuteKernels();
 
+    /**
+     * Executes both kernels once more on a cleared C matrix and compares the
+     * result with a host reference (C is stored in column-major order).
+     */
+    template <typename TItem>
+    void ValidateKernels();
+
     /**
      * Frees all buffers, kernels and the program instance.
      */
@@ -0,0 +1,285 @@
+#include "histogram.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int ELEMENTS = 1 << 24;
+static const int KEY_BITS = 16;
+static const int BIN_COUNTS[] = { 256, 1024, 4096, 16384, 65536 };
+static const int MAX_BINS = 65536;
+static const int PRIVATE_BINS = 256;                // size of the private sub-histograms, divides all bin counts
+static const int MAX_PRIVATE_CHUNKS = 16;           // every chunk reads the whole input, limits the private variant to 4096 bins
+static const int WORK_GROUPS_PER_COMPUTE_UNIT = 4;
+static const int ITERATIONS = 10;
+static const int RANDOM_SEED = 85733;
+
+// the edge detection skips the border, the inner pixels match ELEMENTS
+static const int EDGE_WIDTH = 4096 + 2;
+static const int EDGE_HEIGHT = 4096 + 2;
+
+Histogram::Histogram(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _values() {
+
+}
+
+Histogram::~Histogram() {
+
+}
+
+int Histogram::InitContext() {
+    // there is no VTYPE for unsigned values, GetCompilerFlags only adds the optimization flags
+    string compilerParams = GetCompilerFlags<cl_uint>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+    compilerParams += " -DPRIVATE_BINS=" + to_string(PRIVATE_BINS);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "histogram.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    cl_uint computeUnits = 0;
+    cl_ulong localMemorySize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_COMPUTE_UNITS, &computeUnits);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_LOCAL_MEM_SIZE, &localMemorySize);
+
+    // enough work-groups to fill the device, every one of them writes a partial histogram
+    _workGroups = max(1, static_cast<int>(computeUnits) * WORK_GROUPS_PER_COMPUTE_UNIT);
+
+    // largest power of two number of bins that fits into local memory, the bin counts are powers of two as well
+    _maxLocalBins = 1;
+    while (_maxLocalBins < MAX_BINS && 2 * _maxLocalBins * sizeof(cl_uint) <= localMemorySize)
+        _maxLocalBins *= 2;
+
+    cl_int status = CL_SUCCESS;
+    _valueBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, ELEMENTS * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _histogramBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, MAX_BINS * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _partialsBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE,
+        static_cast<size_t>(_workGroups) * MAX_BINS * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+void Histogram::GenerateUniformInput() {
+    _values.resize(ELEMENTS);
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_int_distribution<uint32_t> keyDistribution(0, (1u << KEY_BITS) - 1);
+
+    for (auto& value : _values)
+        value = keyDistribution(randomEngine);
+
+    UploadInput();
+}
+
+void Histogram::GenerateSkewedInput() {
+    _values.resize(ELEMENTS);
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<double> distribution(0.0, 1.0);
+
+    // u^8 < 2^-8 for u < 0.5
+    for (auto& value : _values)
+        value = static_cast<uint32_t>(pow(distribution(randomEngine), 8.0) * (1u << KEY_BITS));
+
+    UploadInput();
+}
+
+int Histogram::GenerateSteepnessInput() {
+    auto edgeProgram = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "edge.cl", GetCompilerFlags<float>());
+
+    if (edgeProgram.get() == nullptr)
+        return -1;
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel edgeKernel(*edgeProgram, "find_edge_pixels_optimized", &status);
+    CHECK_RETURN_ERROR(status);
+
+    // same image as the edge benchmark
+    vector<float> image(EDGE_WIDTH * EDGE_HEIGHT);
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<float> valueDistribution(0.0, 100.0);
+    for (auto& pixel : image)
+        pixel = valueDistribution(randomEngine);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::Buffer imageBuffer(_controller->Context(), CL_MEM_READ_ONLY, image.size() * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    status = queue.enqueueWriteBuffer(imageBuffer, CL_TRUE, 0, image.size() * sizeof(float), &image[0]);
+    CHECK_RETURN_ERROR(status);
+
+    // the steepness is written as int and read as uint, undefined conversions of infinite relations
+    // (division by a zero pixel) saturate in the last bin like all other large values
+    edgeKernel.setArg(0, imageBuffer);
+    edgeKernel.setArg(1, *_valueBuffer);
+    edgeKernel.setArg(2, EDGE_WIDTH);
+    edgeKernel.setArg(3, EDGE_HEIGHT);
+
+    status = queue.enqueueNDRangeKernel(edgeKernel, cl::NullRange, cl::NDRange(RoundToMultipleOf(ELEMENTS, WORK_GROUP_SIZE)),
+        cl::NDRange(WORK_GROUP_SIZE));
+    CHECK_RETURN_ERROR(status);
+
+    _values.resize(ELEMENTS);
+    status = queue.enqueueReadBuffer(*_valueBuffer, CL_TRUE, 0, ELEMENTS * sizeof(cl_uint), &_values[0]);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+void Histogram::UploadInput() {
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueWriteBuffer(*_valueBuffer, CL_TRUE, 0, ELEMENTS * sizeof(cl_uint), &_values[0]);
+    CHECK(status);
+}
+
+void Histogram::RunInternal(const string& inputName, int valueBits) {
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel globalKernel(*_program, "HistogramGlobal", &status);
+    CHECK(status);
+    cl::Kernel localKernel(*_program, "HistogramLocal", &status);
+    CHECK(status);
+    cl::Kernel privateKernel(*_program, "HistogramPrivate", &status);
+    CHECK(status);
+    cl::Kernel mergeKernel(*_program, "HistogramMerge", &status);
+    CHECK(status);
+
+    vector<cl_uint> histogram(MAX_BINS);
+    vector<cl_uint> reference;
+
+    for (const int bins : BIN_COUNTS) {
+        int binBits = 0;
+        while ((1 << binBits) < bins)
+            ++binBits;
+        const int shift = max(valueBits - binBits, 0);
+
+        if (ValidationEnabled()) {
+            reference.assign(bins, 0);
+            for (const uint32_t value : _values)
+                ++reference[min(value >> shift, static_cast<uint32_t>(bins - 1))];
+        }
+
+        for (cl::Kernel* kernel : { &globalKernel, &localKernel, &privateKernel }) {
+            kernel->setArg(0, *_valueBuffer);
+            kernel->setArg(1, ELEMENTS);
+            kernel->setArg(2, shift);
+            kernel->setArg(3, bins);
+        }
+        globalKernel.setArg(4, *_histogramBuffer);
+
+        const int localChunkBins = min(bins, _maxLocalBins);
+        localKernel.setArg(4, cl::Local(localChunkBins * sizeof(cl_uint)));
+        localKernel.setArg(5, localChunkBins);
+        localKernel.setArg(6, *_partialsBuffer);
+
+        privateKernel.setArg(4, *_partialsBuffer);
+
+        mergeKernel.setArg(0, *_partialsBuffer);
+        mergeKernel.setArg(1, _workGroups);
+        mergeKernel.setArg(2, bins);
+        mergeKernel.setArg(3, *_histogramBuffer);
+
+        const cl::NDRange mergeGlobal(RoundToMultipleOf(bins, WORK_GROUP_SIZE));
+
+        // a failed launch clears the events, PerformMultiPassTest stops and the error is reported here
+        auto measure = [&](const string& strategy, function<void(vector<cl::Event>&)> passes) -> void {
+            const string testName = "  " + inputName + ", " + to_string(bins) + " bins, " + strategy;
+            PerformMultiPassTest(passes, testName + ",", ITERATIONS);
+            CHECK(status);
+
+            const int64_t timeGPU = _gpuStatistics.Mean();
+            cout << testName << ": " << (timeGPU > 0 ? 1000.0 * ELEMENTS / timeGPU : 0.0) << " Melements/s" << endl;
+
+            if (!ValidationEnabled())
+                return;
+
+            status = queue.enqueueReadBuffer(*_histogramBuffer, CL_TRUE, 0, bins * sizeof(cl_uint), &histogram[0]);
+            CHECK(status);
+            ValidateResults(testName, &histogram[0], bins, [&](int64_t i) -> cl_uint {
+                    return reference[i];
+                });
+        };
+
+        measure("global atomics", [&](vector<cl::Event>& events) -> void {
+                events.resize(2);
+                status = queue.enqueueFillBuffer(*_histogramBuffer, static_cast<cl_uint>(0), 0, bins * sizeof(cl_uint), nullptr, &events[0]);
+                if (status == CL_SUCCESS) {
+                    status = queue.enqueueNDRangeKernel(globalKernel, cl::NullRange, cl::NDRange(_workGroups * WORK_GROUP_SIZE), local,
+                        nullptr, &events[1]);
+                }
+                if (status != CL_SUCCESS)
+                    events.clear();
+            });
+
+        // bin counts beyond local memory are split into chunks, every chunk is an additional pass over the input
+        const int localChunks = bins / localChunkBins;
+        measure("local privatization (" + to_string(localChunks) + " chunk(s))", [&](vector<cl::Event>& events) -> void {
+                events.resize(2);
+                status = queue.enqueueNDRangeKernel(localKernel, cl::NullRange, cl::NDRange(_workGroups * WORK_GROUP_SIZE, localChunks),
+                    cl::NDRange(WORK_GROUP_SIZE, 1), nullptr, &events[0]);
+                if (status == CL_SUCCESS)
+                    status = queue.enqueueNDRangeKernel(mergeKernel, cl::NullRange, mergeGlobal, local, nullptr, &events[1]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            });
+
+        const int privateChunks = bins / PRIVATE_BINS;
+        if (privateChunks > MAX_PRIVATE_CHUNKS) {
+            cout << "  " << inputName << ", " << bins << " bins, private sub-histograms: skipped (more than "
+                << MAX_PRIVATE_CHUNKS << " passes over the input)" << endl;
+            continue;
+        }
+
+        measure("private sub-histograms (" + to_string(privateChunks) + " chunk(s))", [&](vector<cl::Event>& events) -> void {
+                events.resize(2);
+                status = queue.enqueueNDRangeKernel(privateKernel, cl::NullRange, cl::NDRange(_workGroups * WORK_GROUP_SIZE, privateChunks),
+                    cl::NDRange(WORK_GROUP_SIZE, 1), nullptr, &events[0]);
+                if (status == CL_SUCCESS)
+                    status = queue.enqueueNDRangeKernel(mergeKernel, cl::NullRange, mergeGlobal, local, nullptr, &events[1]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            });
+    }
+}
+
+void Histogram::Cleanup() {
+    _values.clear();
+    _valueBuffer.reset();
+    _histogramBuffer.reset();
+    _partialsBuffer.reset();
+    _program.reset();
+}
+
+void Histogram::Run() {
+    cout << "Histogram (" << ELEMENTS << " elements):" << endl;
+
+    if (InitContext() == 0) {
+        GenerateUniformInput();
+        RunInternal("uniform", KEY_BITS);
+
+        GenerateSkewedInput();
+        RunInternal("skewed", KEY_BITS);
+
+        // the steepness values are small, they are used as bin indices directly
+        if (GenerateSteepnessInput() == 0)
+            RunInternal("edge steepness", 0);
+    }
+    Cleanup();
+
+    cout << endl;
+}
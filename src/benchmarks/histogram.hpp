@@ -0,0 +1,85 @@
+#ifndef __BENCH_BENCHMARKS_HISTOGRAM_HPP
+#define __BENCH_BENCHMARKS_HISTOGRAM_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Histograms with 256 to 64K bins, computed with three strategies:
+ * atomic increments on the global histogram, per work-group histograms in local memory with a merge pass
+ * and per work-item sub-histograms in private memory. The inputs are uniformly distributed keys,
+ * skewed keys (high contention on the lowest bins) and the steepness output of the edge detection kernel.
+ */
+class Histogram : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _valueBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _histogramBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _partialsBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    std::vector<uint32_t> _values;
+
+    int _workGroups = 0;
+    int _maxLocalBins = 0;
+
+    /**
+     * Compiles the kernels and allocates the input, the histogram and the per work-group partial histograms.
+     */
+    int InitContext();
+
+    /**
+     * Uniformly distributed 16 bit keys.
+     */
+    void GenerateUniformInput();
+
+    /**
+     * 16 bit keys with a power law distribution, half of them fall into the lowest 1/256 of the key range.
+     */
+    void GenerateSkewedInput();
+
+    /**
+     * Runs the edge detection kernel (edge.cl) on a random image and uses the steepness of the pixels as input.
+     */
+    int GenerateSteepnessInput();
+
+    /**
+     * Copies _values to the device.
+     */
+    void UploadInput();
+
+    /**
+     * Executes all strategies for all bin counts and prints the throughput, the results are validated
+     * against a histogram computed on the host.
+     *
+     * @param inputName name of the input distribution
+     * @param valueBits significant bits of the input values, the most significant ones select the bin.
+     *                  0 uses the values as bin indices, values beyond the last bin are counted in the last bin.
+     */
+    void RunInternal(const std::string& inputName, int valueBits);
+
+    /**
+     * Release the buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Histogram(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Histogram();
+
+    /**
+     * Execute the tests for uniform, skewed and edge steepness input.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_HISTOGRAM_HPP
@@ -0,0 +1,602 @@
+#include "imagefilter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int BLOCK_X = 16;
+static const int BLOCK_Y = 16;
+static const int MAX_RADIUS = 4;
+static const int GAUSSIAN_RADIUS = 4;
+static const float GAUSSIAN_SIGMA = 2.0f;
+static const int CONVOLUTION_SIZES[] = { 3, 5, 7, 9 };
+static const int PATTERN_BLOCK_SIZE = 64;       // edge length of the blocks in the test image
+static const float LOW_THRESHOLD = 0.1f;        // Canny thresholds of the gradient magnitude
+static const float HIGH_THRESHOLD = 0.3f;
+static const int ITERATIONS = 10;
+static const int RANDOM_SEED = 85733;
+
+static const struct {
+    const char* name;
+    int width;
+    int height;
+} RESOLUTIONS[] = { { "1080p", 1920, 1080 }, { "4K", 3840, 2160 }, { "8K", 7680, 4320 } };
+
+// same values as in imagefilter.cl
+static const cl_uchar DIRECTION_HORIZONTAL = 0;
+static const cl_uchar DIRECTION_DIAGONAL = 1;
+static const cl_uchar DIRECTION_VERTICAL = 2;
+static const cl_uchar DIRECTION_ANTIDIAGONAL = 3;
+static const float TAN_22_5 = 0.41421356f;
+static const float TAN_67_5 = 2.41421356f;
+static const cl_uchar CLASS_NONE = 0;
+static const cl_uchar CLASS_WEAK = 1;
+static const cl_uchar CLASS_STRONG = 2;
+
+// origin and region of image reads
+#ifdef USE_CL2_HEADERS
+typedef cl::array<cl::size_type, 3> ImageRegion;
+#else
+typedef cl::size_t<3> ImageRegion;
+#endif
+
+// same operation order as the SOBEL macro in imagefilter.cl
+template <typename TFetch>
+static void Sobel(TFetch fetch, float& gx, float& gy) {
+    gx = (fetch(1, -1) + 2.0f * fetch(1, 0) + fetch(1, 1)) - (fetch(-1, -1) + 2.0f * fetch(-1, 0) + fetch(-1, 1));
+    gy = (fetch(-1, 1) + 2.0f * fetch(0, 1) + fetch(1, 1)) - (fetch(-1, -1) + 2.0f * fetch(0, -1) + fetch(1, -1));
+}
+
+static cl_uchar GradientDirection(float gx, float gy) {
+    const float ax = fabs(gx);
+    const float ay = fabs(gy);
+    if (ay <= TAN_22_5 * ax)
+        return DIRECTION_HORIZONTAL;
+    if (ay >= TAN_67_5 * ax)
+        return DIRECTION_VERTICAL;
+    return (gx > 0.0f) == (gy > 0.0f) ? DIRECTION_DIAGONAL : DIRECTION_ANTIDIAGONAL;
+}
+
+ImageFilter::ImageFilter(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _imageData()
+    , _gaussianWeights()
+    , _filterWeights()
+    , _results() {
+
+}
+
+ImageFilter::~ImageFilter() {
+
+}
+
+int ImageFilter::InitContext() {
+    string compilerParams = GetCompilerFlags<float>();
+    compilerParams += " -DBLOCK_X=" + to_string(BLOCK_X);
+    compilerParams += " -DBLOCK_Y=" + to_string(BLOCK_Y);
+    compilerParams += " -DMAX_RADIUS=" + to_string(MAX_RADIUS);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "imagefilter.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    cl_bool imageSupport = CL_FALSE;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_IMAGE_SUPPORT, &imageSupport);
+    _imagesSupported = imageSupport == CL_TRUE;
+    if (!_imagesSupported)
+        cout << "  the device does not support images, only the tiled buffer variants are executed" << endl;
+
+    _gaussianWeights.resize(2 * GAUSSIAN_RADIUS + 1);
+    float sum = 0.0f;
+    for (int d = -GAUSSIAN_RADIUS; d <= GAUSSIAN_RADIUS; ++d)
+        sum += _gaussianWeights[d + GAUSSIAN_RADIUS] = exp(-(d * d) / (2.0f * GAUSSIAN_SIGMA * GAUSSIAN_SIGMA));
+    for (auto& weight : _gaussianWeights)
+        weight /= sum;
+
+    cl_int status = CL_SUCCESS;
+    _gaussianBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        _gaussianWeights.size() * sizeof(float), &_gaussianWeights[0], &status);
+    CHECK_RETURN_ERROR(status);
+
+    const int maxFilterSize = (2 * MAX_RADIUS + 1) * (2 * MAX_RADIUS + 1);
+    _filterBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY, maxFilterSize * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+int ImageFilter::InitData(int width, int height) {
+    _width = width;
+    _height = height;
+    const size_t pixels = static_cast<size_t>(width) * height;
+
+    // blocks of two intensities on a horizontal gradient, the block borders are the edges
+    _imageData.resize(pixels);
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<float> noiseDistribution(-0.05f, 0.05f);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const bool bright = ((x / PATTERN_BLOCK_SIZE + y / PATTERN_BLOCK_SIZE) & 1) != 0;
+            _imageData[y * width + x] = (bright ? 0.7f : 0.2f) + 0.1f * x / width + noiseDistribution(randomEngine);
+        }
+    }
+
+    cl_int status = CL_SUCCESS;
+    _inputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        pixels * sizeof(float), &_imageData[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _tempBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, pixels * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _outputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, pixels * sizeof(float), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _directionBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, pixels * sizeof(cl_uchar), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _classBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, pixels * sizeof(cl_uchar), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    if (!_imagesSupported)
+        return 0;
+
+    size_t maxImageWidth = 0;
+    size_t maxImageHeight = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_IMAGE2D_MAX_WIDTH, &maxImageWidth);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_IMAGE2D_MAX_HEIGHT, &maxImageHeight);
+    if (static_cast<size_t>(width) > maxImageWidth || static_cast<size_t>(height) > maxImageHeight) {
+        cout << "  images of " << width << "x" << height << " pixels are not supported, only the tiled buffer variants are executed" << endl;
+        return 0;
+    }
+
+    // CL_R is not a mandatory format in OpenCL 1.2, the image variants are skipped if it is missing
+    const cl::ImageFormat format(CL_R, CL_FLOAT);
+    _inputImage = make_shared<cl::Image2D>(_controller->Context(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, format,
+        width, height, 0, &_imageData[0], &status);
+    if (status == CL_SUCCESS)
+        _tempImage = make_shared<cl::Image2D>(_controller->Context(), CL_MEM_READ_WRITE, format, width, height, 0, nullptr, &status);
+    if (status == CL_SUCCESS)
+        _outputImage = make_shared<cl::Image2D>(_controller->Context(), CL_MEM_READ_WRITE, format, width, height, 0, nullptr, &status);
+
+    if (status != CL_SUCCESS) {
+        cout << "  failed to create CL_R/CL_FLOAT images (error " << status << "), only the tiled buffer variants are executed" << endl;
+        _inputImage.reset();
+        _tempImage.reset();
+        _outputImage.reset();
+    }
+
+    return 0;
+}
+
+void ImageFilter::PerformFilterTest(const string& testName, function<void(vector<cl::Event>&)> passes) {
+    bool enqueued = true;
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            passes(events);
+            enqueued = !events.empty();
+        }, testName + ",", ITERATIONS);
+    if (!enqueued)
+        return;
+
+    const int64_t timeGPU = _gpuStatistics.Mean();
+    const double pixels = static_cast<double>(_width) * _height;
+    cout << testName << ": " << (timeGPU > 0 ? 1000.0 * pixels / timeGPU : 0.0) << " megapixels/s" << endl;
+}
+
+void ImageFilter::ValidateOutput(const string& testName, bool image, function<float(int64_t i)> reference) {
+    if (!ValidationEnabled())
+        return;
+
+    const int64_t pixels = static_cast<int64_t>(_width) * _height;
+    _results.resize(pixels);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = CL_SUCCESS;
+    if (image) {
+        ImageRegion origin;
+        ImageRegion region;
+        origin[0] = origin[1] = origin[2] = 0;
+        region[0] = _width;
+        region[1] = _height;
+        region[2] = 1;
+        status = queue.enqueueReadImage(*_outputImage, CL_TRUE, origin, region, 0, 0, &_results[0]);
+    } else {
+        status = queue.enqueueReadBuffer(*_outputBuffer, CL_TRUE, 0, pixels * sizeof(float), &_results[0]);
+    }
+    CHECK(status);
+
+    ValidateResults(testName, &_results[0], pixels, reference);
+}
+
+float ImageFilter::Pixel(const vector<float>& image, int x, int y) const {
+    return image[min(max(y, 0), _height - 1) * _width + min(max(x, 0), _width - 1)];
+}
+
+void ImageFilter::GaussianReference(vector<float>& blurred) const {
+    const int64_t pixels = static_cast<int64_t>(_width) * _height;
+    vector<float> rows(pixels);
+    blurred.resize(pixels);
+
+    ParallelFor(pixels, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t i = begin; i < end; ++i) {
+                const int x = static_cast<int>(i % _width);
+                const int y = static_cast<int>(i / _width);
+                float result = 0.0f;
+                for (int d = -GAUSSIAN_RADIUS; d <= GAUSSIAN_RADIUS; ++d)
+                    result += _gaussianWeights[d + GAUSSIAN_RADIUS] * Pixel(_imageData, x + d, y);
+                rows[i] = result;
+            }
+        });
+
+    ParallelFor(pixels, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t i = begin; i < end; ++i) {
+                const int x = static_cast<int>(i % _width);
+                const int y = static_cast<int>(i / _width);
+                float result = 0.0f;
+                for (int d = -GAUSSIAN_RADIUS; d <= GAUSSIAN_RADIUS; ++d)
+                    result += _gaussianWeights[d + GAUSSIAN_RADIUS] * Pixel(rows, x, y + d);
+                blurred[i] = result;
+            }
+        });
+}
+
+void ImageFilter::RunSobel() {
+    cl::CommandQueue& queue = _controller->Queue();
+    const cl::NDRange global(RoundToMultipleOf(_width, BLOCK_X), RoundToMultipleOf(_height, BLOCK_Y));
+    const cl::NDRange local(BLOCK_X, BLOCK_Y);
+    const string resolution = to_string(_width) + "x" + to_string(_height);
+
+    auto reference = [&](int64_t i) -> float {
+        const int x = static_cast<int>(i % _width);
+        const int y = static_cast<int>(i / _width);
+        float gx, gy;
+        Sobel([&](int dx, int dy) -> float { return Pixel(_imageData, x + dx, y + dy); }, gx, gy);
+        return sqrt(gx * gx + gy * gy);
+    };
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel tiledKernel(*_program, "SobelTiled", &status);
+    CHECK(status);
+    tiledKernel.setArg(0, *_inputBuffer);
+    tiledKernel.setArg(1, *_outputBuffer);
+    tiledKernel.setArg(2, _width);
+    tiledKernel.setArg(3, _height);
+
+    PerformFilterTest("  Sobel (tiled), " + resolution, [&](vector<cl::Event>& events) -> void {
+            events.resize(1);
+            status = queue.enqueueNDRangeKernel(tiledKernel, cl::NullRange, global, local, nullptr, &events[0]);
+            if (status != CL_SUCCESS)
+                events.clear();
+        });
+    CHECK(status);
+    ValidateOutput("Sobel (tiled)", false, reference);
+
+    if (_inputImage.get() == nullptr)
+        return;
+
+    cl::Kernel imageKernel(*_program, "SobelImage", &status);
+    CHECK(status);
+    imageKernel.setArg(0, *_inputImage);
+    imageKernel.setArg(1, *_outputImage);
+    imageKernel.setArg(2, _width);
+    imageKernel.setArg(3, _height);
+
+    PerformFilterTest("  Sobel (image), " + resolution, [&](vector<cl::Event>& events) -> void {
+            events.resize(1);
+            status = queue.enqueueNDRangeKernel(imageKernel, cl::NullRange, global, local, nullptr, &events[0]);
+            if (status != CL_SUCCESS)
+                events.clear();
+        });
+    CHECK(status);
+    ValidateOutput("Sobel (image)", true, reference);
+}
+
+void ImageFilter::RunGaussian() {
+    cl::CommandQueue& queue = _controller->Queue();
+    const cl::NDRange global(RoundToMultipleOf(_width, BLOCK_X), RoundToMultipleOf(_height, BLOCK_Y));
+    const cl::NDRange local(BLOCK_X, BLOCK_Y);
+    const string resolution = to_string(_width) + "x" + to_string(_height);
+
+    vector<float> blurred;
+    if (ValidationEnabled())
+        GaussianReference(blurred);
+
+    auto reference = [&](int64_t i) -> float {
+        return blurred[i];
+    };
+
+    const string variants[] = { "Tiled", "Image" };
+    for (const string& variant : variants) {
+        const bool image = variant == "Image";
+        if (image && _inputImage.get() == nullptr)
+            continue;
+
+        cl_int status = CL_SUCCESS;
+        cl::Kernel rowsKernel(*_program, ("GaussianRows" + variant).c_str(), &status);
+        CHECK(status);
+        cl::Kernel columnsKernel(*_program, ("GaussianColumns" + variant).c_str(), &status);
+        CHECK(status);
+
+        if (image) {
+            rowsKernel.setArg(0, *_inputImage);
+            rowsKernel.setArg(1, *_tempImage);
+            columnsKernel.setArg(0, *_tempImage);
+            columnsKernel.setArg(1, *_outputImage);
+        } else {
+            rowsKernel.setArg(0, *_inputBuffer);
+            rowsKernel.setArg(1, *_tempBuffer);
+            columnsKernel.setArg(0, *_tempBuffer);
+            columnsKernel.setArg(1, *_outputBuffer);
+        }
+
+        for (cl::Kernel* kernel : { &rowsKernel, &columnsKernel }) {
+            kernel->setArg(2, *_gaussianBuffer);
+            kernel->setArg(3, GAUSSIAN_RADIUS);
+            kernel->setArg(4, _width);
+            kernel->setArg(5, _height);
+        }
+
+        const string testName = "Gaussian " + to_string(2 * GAUSSIAN_RADIUS + 1) + "x" + to_string(2 * GAUSSIAN_RADIUS + 1)
+            + " separable (" + (image ? "image" : "tiled") + ")";
+        PerformFilterTest("  " + testName + ", " + resolution, [&](vector<cl::Event>& events) -> void {
+                events.resize(2);
+                status = queue.enqueueNDRangeKernel(rowsKernel, cl::NullRange, global, local, nullptr, &events[0]);
+                if (status == CL_SUCCESS)
+                    status = queue.enqueueNDRangeKernel(columnsKernel, cl::NullRange, global, local, nullptr, &events[1]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            });
+        CHECK(status);
+        ValidateOutput(testName, image, reference);
+    }
+}
+
+void ImageFilter::RunConvolution() {
+    cl::CommandQueue& queue = _controller->Queue();
+    const cl::NDRange global(RoundToMultipleOf(_width, BLOCK_X), RoundToMultipleOf(_height, BLOCK_Y));
+    const cl::NDRange local(BLOCK_X, BLOCK_Y);
+    const string resolution = to_string(_width) + "x" + to_string(_height);
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    uniform_real_distribution<float> weightDistribution(0.0f, 1.0f);
+
+    for (const int size : CONVOLUTION_SIZES) {
+        const int radius = size / 2;
+
+        // random weights, normalized to keep the brightness
+        _filterWeights.resize(size * size);
+        float sum = 0.0f;
+        for (auto& weight : _filterWeights)
+            sum += weight = weightDistribution(randomEngine);
+        for (auto& weight : _filterWeights)
+            weight /= sum;
+
+        cl_int status = queue.enqueueWriteBuffer(*_filterBuffer, CL_TRUE, 0, _filterWeights.size() * sizeof(float), &_filterWeights[0]);
+        CHECK(status);
+
+        auto reference = [&](int64_t i) -> float {
+            const int x = static_cast<int>(i % _width);
+            const int y = static_cast<int>(i / _width);
+            float result = 0.0f;
+            for (int dy = -radius; dy <= radius; ++dy)
+                for (int dx = -radius; dx <= radius; ++dx)
+                    result += _filterWeights[(dy + radius) * size + dx + radius] * Pixel(_imageData, x + dx, y + dy);
+            return result;
+        };
+
+        const string variants[] = { "Tiled", "Image" };
+        for (const string& variant : variants) {
+            const bool image = variant == "Image";
+            if (image && _inputImage.get() == nullptr)
+                continue;
+
+            cl::Kernel kernel(*_program, ("Convolution" + variant).c_str(), &status);
+            CHECK(status);
+
+            if (image) {
+                kernel.setArg(0, *_inputImage);
+                kernel.setArg(1, *_outputImage);
+            } else {
+                kernel.setArg(0, *_inputBuffer);
+                kernel.setArg(1, *_outputBuffer);
+            }
+            kernel.setArg(2, *_filterBuffer);
+            kernel.setArg(3, radius);
+            kernel.setArg(4, _width);
+            kernel.setArg(5, _height);
+
+            const string testName = "Convolution " + to_string(size) + "x" + to_string(size) + " (" + (image ? "image" : "tiled") + ")";
+            PerformFilterTest("  " + testName + ", " + resolution, [&](vector<cl::Event>& events) -> void {
+                    events.resize(1);
+                    status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+                    if (status != CL_SUCCESS)
+                        events.clear();
+                });
+            CHECK(status);
+            ValidateOutput(testName, image, reference);
+        }
+    }
+}
+
+void ImageFilter::RunCanny() {
+    cl::CommandQueue& queue = _controller->Queue();
+    const cl::NDRange global(RoundToMultipleOf(_width, BLOCK_X), RoundToMultipleOf(_height, BLOCK_Y));
+    const cl::NDRange local(BLOCK_X, BLOCK_Y);
+    const string resolution = to_string(_width) + "x" + to_string(_height);
+    const int64_t pixels = static_cast<int64_t>(_width) * _height;
+
+    vector<float> blurred;
+    if (ValidationEnabled())
+        GaussianReference(blurred);
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel suppressKernel(*_program, "CannySuppress", &status);
+    CHECK(status);
+    cl::Kernel hysteresisKernel(*_program, "CannyHysteresis", &status);
+    CHECK(status);
+
+    suppressKernel.setArg(0, *_tempBuffer);
+    suppressKernel.setArg(1, *_directionBuffer);
+    suppressKernel.setArg(2, *_classBuffer);
+    suppressKernel.setArg(3, LOW_THRESHOLD);
+    suppressKernel.setArg(4, HIGH_THRESHOLD);
+    suppressKernel.setArg(5, _width);
+    suppressKernel.setArg(6, _height);
+
+    hysteresisKernel.setArg(0, *_classBuffer);
+    hysteresisKernel.setArg(1, *_outputBuffer);
+    hysteresisKernel.setArg(2, _width);
+    hysteresisKernel.setArg(3, _height);
+
+    const string variants[] = { "Tiled", "Image" };
+    for (const string& variant : variants) {
+        const bool image = variant == "Image";
+        if (image && _inputImage.get() == nullptr)
+            continue;
+
+        cl::Kernel rowsKernel(*_program, ("GaussianRows" + variant).c_str(), &status);
+        CHECK(status);
+        cl::Kernel columnsKernel(*_program, ("GaussianColumns" + variant).c_str(), &status);
+        CHECK(status);
+        cl::Kernel gradientKernel(*_program, ("CannyGradient" + variant).c_str(), &status);
+        CHECK(status);
+
+        // the blurred image ends up in the output image or buffer, the magnitude in the temporary buffer
+        if (image) {
+            rowsKernel.setArg(0, *_inputImage);
+            rowsKernel.setArg(1, *_tempImage);
+            columnsKernel.setArg(0, *_tempImage);
+            columnsKernel.setArg(1, *_outputImage);
+            gradientKernel.setArg(0, *_outputImage);
+        } else {
+            rowsKernel.setArg(0, *_inputBuffer);
+            rowsKernel.setArg(1, *_tempBuffer);
+            columnsKernel.setArg(0, *_tempBuffer);
+            columnsKernel.setArg(1, *_outputBuffer);
+            gradientKernel.setArg(0, *_outputBuffer);
+        }
+
+        for (cl::Kernel* kernel : { &rowsKernel, &columnsKernel }) {
+            kernel->setArg(2, *_gaussianBuffer);
+            kernel->setArg(3, GAUSSIAN_RADIUS);
+            kernel->setArg(4, _width);
+            kernel->setArg(5, _height);
+        }
+        gradientKernel.setArg(1, *_tempBuffer);
+        gradientKernel.setArg(2, *_directionBuffer);
+        gradientKernel.setArg(3, _width);
+        gradientKernel.setArg(4, _height);
+
+        const string testName = string("Canny (") + (image ? "image" : "tiled") + ")";
+        PerformFilterTest("  " + testName + ", " + resolution, [&](vector<cl::Event>& events) -> void {
+                cl::Kernel* kernels[] = { &rowsKernel, &columnsKernel, &gradientKernel, &suppressKernel, &hysteresisKernel };
+                events.resize(5);
+                status = CL_SUCCESS;
+                for (int pass = 0; pass < 5 && status == CL_SUCCESS; ++pass)
+                    status = queue.enqueueNDRangeKernel(*kernels[pass], cl::NullRange, global, local, nullptr, &events[pass]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            });
+        CHECK(status);
+
+        if (!ValidationEnabled())
+            continue;
+
+        // the gradient is compared with a tolerance, the classification is checked exactly on the gradient
+        // of the device: rounding differences must not flip pixels at the thresholds or the maxima
+        vector<float> magnitude(pixels);
+        vector<cl_uchar> direction(pixels);
+        status = queue.enqueueReadBuffer(*_tempBuffer, CL_TRUE, 0, pixels * sizeof(float), &magnitude[0]);
+        status |= queue.enqueueReadBuffer(*_directionBuffer, CL_TRUE, 0, pixels * sizeof(cl_uchar), &direction[0]);
+        CHECK(status);
+
+        ValidateResults(testName + " gradient", &magnitude[0], pixels, [&](int64_t i) -> float {
+                const int x = static_cast<int>(i % _width);
+                const int y = static_cast<int>(i / _width);
+                float gx, gy;
+                Sobel([&](int dx, int dy) -> float { return Pixel(blurred, x + dx, y + dy); }, gx, gy);
+                return sqrt(gx * gx + gy * gy);
+            });
+
+        vector<cl_uchar> classes(pixels);
+        ParallelFor(pixels, [&](int64_t begin, int64_t end) -> void {
+                for (int64_t i = begin; i < end; ++i) {
+                    const int x = static_cast<int>(i % _width);
+                    const int y = static_cast<int>(i / _width);
+
+                    int dx = 1, dy = 0;
+                    if (direction[i] == DIRECTION_DIAGONAL) {
+                        dy = 1;
+                    } else if (direction[i] == DIRECTION_VERTICAL) {
+                        dx = 0;
+                        dy = 1;
+                    } else if (direction[i] == DIRECTION_ANTIDIAGONAL) {
+                        dy = -1;
+                    }
+
+                    const float m = magnitude[i];
+                    classes[i] = CLASS_NONE;
+                    if (m >= Pixel(magnitude, x - dx, y - dy) && m >= Pixel(magnitude, x + dx, y + dy))
+                        classes[i] = m >= HIGH_THRESHOLD ? CLASS_STRONG : (m >= LOW_THRESHOLD ? CLASS_WEAK : CLASS_NONE);
+                }
+            });
+
+        ValidateOutput(testName + " edges", false, [&](int64_t i) -> float {
+                const int x = static_cast<int>(i % _width);
+                const int y = static_cast<int>(i / _width);
+
+                bool edge = classes[i] == CLASS_STRONG;
+                if (classes[i] == CLASS_WEAK) {
+                    for (int ny = max(y - 1, 0); ny <= min(y + 1, _height - 1); ++ny)
+                        for (int nx = max(x - 1, 0); nx <= min(x + 1, _width - 1); ++nx)
+                            edge = edge || classes[ny * _width + nx] == CLASS_STRONG;
+                }
+                return edge ? 1.0f : 0.0f;
+            });
+    }
+}
+
+void ImageFilter::ReleaseData() {
+    _imageData.clear();
+    _results.clear();
+    _inputBuffer.reset();
+    _tempBuffer.reset();
+    _outputBuffer.reset();
+    _directionBuffer.reset();
+    _classBuffer.reset();
+    _inputImage.reset();
+    _tempImage.reset();
+    _outputImage.reset();
+}
+
+void ImageFilter::Cleanup() {
+    ReleaseData();
+    _gaussianBuffer.reset();
+    _filterBuffer.reset();
+    _program.reset();
+}
+
+void ImageFilter::Run() {
+    cout << "ImageFilter:" << endl;
+
+    if (InitContext() == 0) {
+        for (const auto& resolution : RESOLUTIONS) {
+            cout << "ImageFilter (" << resolution.name << ")" << endl;
+            if (InitData(resolution.width, resolution.height) == 0) {
+                RunSobel();
+                RunGaussian();
+                RunConvolution();
+                RunCanny();
+            }
+            ReleaseData();
+        }
+    }
+    Cleanup();
+
+    cout << endl;
+}
@@ -0,0 +1,117 @@
+#ifndef __BENCH_BENCHMARKS_IMAGEFILTER_HPP
+#define __BENCH_BENCHMARKS_IMAGEFILTER_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cl {
+    class Image2D;
+}
+
+namespace benchmarks {
+
+/**
+ * Image processing filters on single channel float images at 1080p, 4K and 8K: Sobel edge detection,
+ * Gaussian blur as separable two-pass convolution, general NxN convolution and Canny edge detection
+ * (blur, gradient, non-maximum suppression, double threshold and one hysteresis step).
+ * Every filter is executed on image objects read through a sampler and on buffers with local memory tiles.
+ */
+class ImageFilter : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Program> _program = nullptr;
+    std::shared_ptr<cl::Buffer> _gaussianBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _filterBuffer = nullptr;
+
+    std::shared_ptr<cl::Buffer> _inputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _tempBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _outputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _directionBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _classBuffer = nullptr;
+
+    std::shared_ptr<cl::Image2D> _inputImage = nullptr;
+    std::shared_ptr<cl::Image2D> _tempImage = nullptr;
+    std::shared_ptr<cl::Image2D> _outputImage = nullptr;
+
+    bool _imagesSupported = false;
+    int _width = 0;
+    int _height = 0;
+
+    std::vector<float> _imageData;
+    std::vector<float> _gaussianWeights;
+    std::vector<float> _filterWeights;
+    std::vector<float> _results;
+
+    /**
+     * Compiles the kernels, uploads the filter weights and checks the image support of the device.
+     */
+    int InitContext();
+
+    /**
+     * Creates the test image (blocks of two intensities with noise) and allocates the buffers and images.
+     *
+     * @return 0 on success, the resolution is skipped otherwise
+     */
+    int InitData(int width, int height);
+
+    /**
+     * Executes the passes of a filter, prints the throughput in megapixels per second.
+     * A pass which fails to enqueue has to clear its events, nothing is printed then and the caller reports the error.
+     */
+    void PerformFilterTest(const std::string& testName, std::function<void(std::vector<cl::Event>&)> passes);
+
+    /**
+     * Reads the output image (or _outputBuffer) and compares it with the host reference.
+     */
+    void ValidateOutput(const std::string& testName, bool image, std::function<float(int64_t i)> reference);
+
+    /**
+     * Input pixel with clamp-to-edge border handling.
+     */
+    float Pixel(const std::vector<float>& image, int x, int y) const;
+
+    /**
+     * Host reference of the separable Gaussian blur, same operation order as the kernels.
+     */
+    void GaussianReference(std::vector<float>& blurred) const;
+
+    void RunSobel();
+
+    void RunGaussian();
+
+    /**
+     * NxN convolution for N = 3, 5, 7 and 9 with a random filter.
+     */
+    void RunConvolution();
+
+    void RunCanny();
+
+    /**
+     * Release the buffers and images of a resolution.
+     */
+    void ReleaseData();
+
+    /**
+     * Release everything else.
+     */
+    void Cleanup();
+
+public:
+    explicit ImageFilter(std::shared_ptr<ComputeController> controller);
+
+    virtual ~ImageFilter();
+
+    /**
+     * Execute all filters for all resolutions.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_IMAGEFILTER_HPP
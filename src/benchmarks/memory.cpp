@@ -1,7 +1,10 @@
 #include "memory.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <memory.h>
+#include <random>
+#include <vector>
 
 #include "../clglobal.hpp"
 #include "../computecontroller.hpp"
@@ -9,8 +12,49 @@
 using namespace benchmarks;
 using namespace std;
 
-static const int BUFFER_SIZE = 256 * 1024 * 1024; // 256 MiB
+static const size_t MIN_TRANSFER_SIZE = 4 * 1024;               // 4 KiB
+static const size_t MAX_TRANSFER_SIZE = 1024 * 1024 * 1024;      // 1 GiB
+static const size_t TRANSFER_SIZE_STEP = 4;
+static const size_t TRANSFER_VOLUME = 2ull * 1024 * 1024 * 1024; // bytes moved per size of the sweep
+static const int MIN_TRANSFER_ITERATIONS = 3;
+static const int MAX_TRANSFER_ITERATIONS = 1000;
 static const int ITERATIONS = 100; // number of iterations
+static const size_t ZERO_COPY_SIZE = 64 * 1024 * 1024;
+static const int ZERO_COPY_ITERATIONS = 20;
+static const int ZERO_COPY_ALIGNMENT = 4096;        // most runtimes only avoid the copy for page aligned host pointers
+static const double HIDDEN_COPY_FRACTION = 0.25;    // a zero-copy map has to be clearly faster than reading the buffer
+static const size_t LATENCY_MIN_FOOTPRINT = 4 * 1024;
+static const size_t LATENCY_MAX_FOOTPRINT = 1024 * 1024 * 1024;
+static const size_t LATENCY_MIN_ELEMENTS = 16;      // shorter lists would be predictable
+static const size_t LATENCY_STRIDES[] = { 128, 4096 }; // one load per cache line, one load per page (TLB reach)
+static const int LATENCY_STEPS = 256 * 1024;
+static const int LATENCY_ITERATIONS = 5;
+static const int RANDOM_SEED = 85733;
+static const int ACCESS_PATTERN_LENGTH_BITS = 24;   // 2^24 floats = 64 MiB per array
+static const cl_uint MAX_ACCESS_STRIDE = 4096;
+static const size_t ACCESS_PATTERN_WINDOWS[] = { 32, 1024, 32768, 1048576 }; // elements: 128 B, 4 KiB, 128 KiB, 4 MiB
+static const int ACCESS_PATTERN_ITERATIONS = 20;
+
+// reads every value so that mapped memory is really accessed
+static float TouchRead(const float *buffer, size_t length) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < length; ++i)
+        sum += buffer[i];
+    return sum;
+}
+
+static void TouchWrite(float *buffer, size_t length) {
+    for (size_t i = 0; i < length; ++i)
+        buffer[i] = static_cast<float>(i);
+}
+
+static string FormatSize(size_t bytes) {
+    if (bytes >= 1024 * 1024 * 1024)
+        return to_string(bytes / (1024 * 1024 * 1024)) + " GiB";
+    if (bytes >= 1024 * 1024)
+        return to_string(bytes / (1024 * 1024)) + " MiB";
+    return to_string(bytes / 1024) + " KiB";
+}
 
 int Memory::AlignmentFactor() {
     cl_uint factor = -1;
@@ -36,141 +80,272 @@ TItem* Memory::AlignAddress(TItem* address, const int alignment, const int displ
 }
 
 template<typename TItem>
-void Memory::FillBufferWithContent(TItem *buffer, int length) {
-    for (int i = 0; i < length; ++i) {
+void Memory::FillBufferWithContent(TItem *buffer, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
         buffer[i] = (TItem)i;
     }
 }
 
+size_t Memory::MaximumTransferSize() {
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+
+    size_t size = MIN_TRANSFER_SIZE;
+    while (size * TRANSFER_SIZE_STEP <= MAX_TRANSFER_SIZE && size * TRANSFER_SIZE_STEP <= maxAllocationSize)
+        size *= TRANSFER_SIZE_STEP;
+
+    return size;
+}
+
+int Memory::IterationsForSize(size_t bytes) {
+    const size_t iterations = TRANSFER_VOLUME / bytes;
+    return static_cast<int>(max<size_t>(MIN_TRANSFER_ITERATIONS, min<size_t>(MAX_TRANSFER_ITERATIONS, iterations)));
+}
+
+void Memory::SweepTransferSizes(const string& testName, function<void(cl::Event&, size_t)> transfer) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const size_t maximumSize = MaximumTransferSize();
+    cl_ulong startTime, endTime;
+
+    cout << testName << endl;
+
+    for (size_t bytes = MIN_TRANSFER_SIZE; bytes <= maximumSize; bytes *= TRANSFER_SIZE_STEP) {
+        _cpuStatistics.Clear();
+        _gpuStatistics.Clear();
+
+        // the first transfer of a size is not timed, it may include page faults and pinning
+        const int iterations = IterationsForSize(bytes);
+        for (int i = -1; i < iterations; ++i) {
+            cl::Event event;
+
+            _timer.Remember();
+            transfer(event, bytes);
+            cl_int status = event.wait();
+            const int64_t timeCPU = _timer.Diff();
+            CHECK(status);
+
+            if (i < 0)
+                continue;
+
+            event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+            event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+            _cpuStatistics.Add(timeCPU);
+            _gpuStatistics.Add(endTime - startTime);
+        }
+
+        // commands enqueued after the timed one (e.g. unmap) have to finish before the next size
+        queue.finish();
+
+        const int64_t timeGPU = _gpuStatistics.Mean();
+        cout << "  " << FormatSize(bytes) << ": " << (timeGPU > 0 ? static_cast<double>(bytes) / timeGPU : 0.0) << " GB/s"
+            << " (GPU: " << timeGPU << " ns, CPU: " << _cpuStatistics.Mean() << " ns, " << iterations << " iterations)" << endl;
+    }
+}
+
 // is this memory really pinned after passing it to cl::Buffer???
 void Memory::CopyMemoryToDevice(bool align) {
-    int length = BUFFER_SIZE / sizeof(float);
+    const size_t bufferSize = MaximumTransferSize();
 
     // allocate buffer using correct assignment values
     int displacement = (align ? 0 : 83);
     int alignmentFactor = AlignmentFactor();
-    void *buffer = malloc(BUFFER_SIZE + alignmentFactor + displacement);
+    void *buffer = malloc(bufferSize + alignmentFactor + displacement);
     float *hostBuffer = AlignAddress<float>(static_cast<float*>(buffer), alignmentFactor, displacement);
 
-    string testName = "CopyMemoryToDevice ";
-    testName += (align ? "(aligned),  " : "(unaligned),");
+    string testName = "CopyMemoryToDevice, CL_MEM_USE_HOST_PTR ";
+    testName += (align ? "(aligned)" : "(unaligned)");
 
     cl::CommandQueue& queue = _controller->Queue();
-    FillBufferWithContent<float>(hostBuffer, length);
-    cl::Buffer pinnedMemoryBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, static_cast<size_t>(BUFFER_SIZE), static_cast<void*>(hostBuffer), nullptr);
+    FillBufferWithContent<float>(hostBuffer, bufferSize / sizeof(float));
+    cl::Buffer pinnedMemoryBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bufferSize, static_cast<void*>(hostBuffer), nullptr);
 
-    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, BUFFER_SIZE);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
 
-    // actual test function
-    PerformTest([&](cl::Event& event) -> void { 
-            queue.enqueueCopyBuffer(pinnedMemoryBuffer, targetBuffer, 0, 0, BUFFER_SIZE, nullptr, &event);
-        }, testName, ITERATIONS);
+    SweepTransferSizes(testName, [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueCopyBuffer(pinnedMemoryBuffer, targetBuffer, 0, 0, bytes, nullptr, &event);
+        });
 
     free(buffer);
 }
 
+void Memory::CopyAllocatedHostMemoryToDevice() {
+    const size_t bufferSize = MaximumTransferSize();
+    cl::CommandQueue& queue = _controller->Queue();
+
+    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bufferSize);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    float *mappedBuffer = static_cast<float*>(queue.enqueueMapBuffer(hostBuffer, CL_TRUE, CL_MAP_WRITE, 0, bufferSize));
+    FillBufferWithContent<float>(mappedBuffer, bufferSize / sizeof(float));
+    queue.enqueueUnmapMemObject(hostBuffer, mappedBuffer);
+    queue.finish();
+
+    SweepTransferSizes("CopyMemoryToDevice, CL_MEM_ALLOC_HOST_PTR", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueCopyBuffer(hostBuffer, targetBuffer, 0, 0, bytes, nullptr, &event);
+        });
+}
+
 void Memory::CopyUnpinnedMemoryToDevice() {
+    const size_t bufferSize = MaximumTransferSize();
     cl::CommandQueue& queue = _controller->Queue();
 
     int alignmentFactor = AlignmentFactor();
-    void *buffer = malloc(BUFFER_SIZE + alignmentFactor);
+    void *buffer = malloc(bufferSize + alignmentFactor);
     float *hostBuffer = AlignAddress<float>(static_cast<float*>(buffer), alignmentFactor, 0);
 
-    int length = BUFFER_SIZE / sizeof(float);
-    FillBufferWithContent<float>(hostBuffer, length);
+    FillBufferWithContent<float>(hostBuffer, bufferSize / sizeof(float));
 
-    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, BUFFER_SIZE);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
 
-    string testName = "CopyUnpinnedMemoryToDevice,    ";
-
-    PerformTest([&](cl::Event& event) -> void {
-            queue.enqueueWriteBuffer(targetBuffer, CL_TRUE, 0, BUFFER_SIZE, static_cast<void*>(hostBuffer), nullptr, &event);
-        }, testName, ITERATIONS);
+    SweepTransferSizes("WriteBuffer, unpinned host memory", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueWriteBuffer(targetBuffer, CL_FALSE, 0, bytes, static_cast<void*>(hostBuffer), nullptr, &event);
+        });
 
     free(buffer);
 }
 
+void Memory::CopyPinnedMemoryToDevice() {
+    const size_t bufferSize = MaximumTransferSize();
+    cl::CommandQueue& queue = _controller->Queue();
+
+    // the usual way to get pinned memory: map a buffer allocated by the runtime and keep it mapped
+    cl::Buffer pinnedBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bufferSize);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    float *hostBuffer = static_cast<float*>(queue.enqueueMapBuffer(pinnedBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferSize));
+    FillBufferWithContent<float>(hostBuffer, bufferSize / sizeof(float));
+
+    SweepTransferSizes("WriteBuffer, pinned host memory", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueWriteBuffer(targetBuffer, CL_FALSE, 0, bytes, static_cast<void*>(hostBuffer), nullptr, &event);
+        });
+
+    queue.enqueueUnmapMemObject(pinnedBuffer, hostBuffer);
+    queue.finish();
+}
+
+void Memory::CopyOnDevice() {
+    const size_t bufferSize = MaximumTransferSize();
+    cl::CommandQueue& queue = _controller->Queue();
+
+    cl::Buffer sourceBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    // every byte is read and written once
+    SweepTransferSizes("CopyBuffer, device to device (bytes copied)", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueCopyBuffer(sourceBuffer, targetBuffer, 0, 0, bytes, nullptr, &event);
+        });
+}
+
 void Memory::CopyToHostMemory() {
+    const size_t bufferSize = MaximumTransferSize();
     cl::CommandQueue& queue = _controller->Queue();
 
     int alignmentFactor = AlignmentFactor();
-    void *buffer = malloc(BUFFER_SIZE + alignmentFactor);
+    void *buffer = malloc(bufferSize + alignmentFactor);
     float *positionedBuffer = AlignAddress<float>(static_cast<float*>(buffer), alignmentFactor, 0);
 
-    int length = BUFFER_SIZE / sizeof(float);
-    FillBufferWithContent<float>(positionedBuffer, length);
+    FillBufferWithContent<float>(positionedBuffer, bufferSize / sizeof(float));
 
-    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, BUFFER_SIZE);
-    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, BUFFER_SIZE, static_cast<void*>(positionedBuffer));
+    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, bufferSize, static_cast<void*>(positionedBuffer));
     queue.finish();
 
-    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE);
-
-    string testName = "CopyToHostMemory,              ";
+    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bufferSize);
 
-    PerformTest([&](cl::Event& event) -> void {
-            queue.enqueueCopyBuffer(deviceBuffer, hostBuffer, 0, 0, BUFFER_SIZE, nullptr, &event);
-        }, testName, ITERATIONS);
+    SweepTransferSizes("CopyToHostMemory, CL_MEM_ALLOC_HOST_PTR", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueCopyBuffer(deviceBuffer, hostBuffer, 0, 0, bytes, nullptr, &event);
+        });
 
     free(buffer);
 }
 
 void Memory::CopyToUnpinnedHostMemory() {
+    const size_t bufferSize = MaximumTransferSize();
     cl::CommandQueue& queue = _controller->Queue();
 
     int alignmentFactor = AlignmentFactor();
-    void *buffer = malloc(BUFFER_SIZE + alignmentFactor);
+    void *buffer = malloc(bufferSize + alignmentFactor);
     float *positionedBuffer = AlignAddress<float>(static_cast<float*>(buffer), alignmentFactor, 0);
 
-    int length = BUFFER_SIZE / sizeof(float);
-    FillBufferWithContent<float>(positionedBuffer, length);
+    FillBufferWithContent<float>(positionedBuffer, bufferSize / sizeof(float));
 
-    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, BUFFER_SIZE);
-    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, BUFFER_SIZE, static_cast<void*>(positionedBuffer));
+    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, bufferSize, static_cast<void*>(positionedBuffer));
     queue.finish();
 
-    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, BUFFER_SIZE);
+    SweepTransferSizes("ReadBuffer, unpinned host memory", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueReadBuffer(deviceBuffer, CL_FALSE, 0, bytes, positionedBuffer, nullptr, &event);
+        });
 
-    string testName = "CopyToUnpinnedHostMemory,      ";
+    free(buffer);
+}
 
-    PerformTest([&](cl::Event& event) -> void {
-            queue.enqueueReadBuffer(deviceBuffer, CL_TRUE, 0, BUFFER_SIZE, positionedBuffer, nullptr, &event);
-        }, testName, ITERATIONS);
+void Memory::CopyToPinnedHostMemory() {
+    const size_t bufferSize = MaximumTransferSize();
+    cl::CommandQueue& queue = _controller->Queue();
 
-    free(buffer);
+    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    cl::Buffer pinnedBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bufferSize);
+
+    float *hostBuffer = static_cast<float*>(queue.enqueueMapBuffer(pinnedBuffer, CL_TRUE, CL_MAP_READ | CL_MAP_WRITE, 0, bufferSize));
+    FillBufferWithContent<float>(hostBuffer, bufferSize / sizeof(float));
+    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, bufferSize, static_cast<void*>(hostBuffer));
+
+    SweepTransferSizes("ReadBuffer, pinned host memory", [&](cl::Event& event, size_t bytes) -> void {
+            queue.enqueueReadBuffer(deviceBuffer, CL_FALSE, 0, bytes, static_cast<void*>(hostBuffer), nullptr, &event);
+        });
+
+    queue.enqueueUnmapMemObject(pinnedBuffer, hostBuffer);
+    queue.finish();
+}
+
+void Memory::MapDeviceMemory() {
+    const size_t bufferSize = MaximumTransferSize();
+    cl::CommandQueue& queue = _controller->Queue();
+
+    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    // only the map command is timed, the unmap of a read-only mapping does not transfer data
+    SweepTransferSizes("MapBuffer (CL_MAP_READ) and unmap, device memory", [&](cl::Event& event, size_t bytes) -> void {
+            void *mappedBuffer = queue.enqueueMapBuffer(deviceBuffer, CL_FALSE, CL_MAP_READ, 0, bytes, nullptr, &event);
+            queue.enqueueUnmapMemObject(deviceBuffer, mappedBuffer);
+        });
 }
 
 void Memory::WriteToHostMemory(bool align) {
     string compilerParams = GetCompilerFlags<float>();
     auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
 
+    if (program.get() == nullptr)
+        return;
+
     cl_int status = 0;
     cl::Kernel writeToHostKernel(*program, "write_to_buffer_loop_simple", &status);
     CHECK(status);
 
     cl::CommandQueue& queue = _controller->Queue();
+    const size_t bufferSize = MaximumTransferSize();
 
     // allocate buffer using correct assignment values
     int displacement = (align ? 0 : 83);
     int alignmentFactor = AlignmentFactor();
-    void *buffer = malloc(BUFFER_SIZE + alignmentFactor + displacement);
+    void *buffer = malloc(bufferSize + alignmentFactor + displacement);
     float *repositionedBuffer = AlignAddress<float>(static_cast<float*>(buffer), alignmentFactor, displacement);
-    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, static_cast<size_t>(BUFFER_SIZE), repositionedBuffer, nullptr);
+    cl::Buffer hostBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bufferSize, repositionedBuffer, nullptr);
 
     // initialize kernel
     cl_int blockSizeCl = 128;// 4;
-    cl_int lengthCl = BUFFER_SIZE / sizeof(float);
-    cl::NDRange global(lengthCl / blockSizeCl);
     writeToHostKernel.setArg(0, hostBuffer);
     writeToHostKernel.setArg(1, blockSizeCl);
-    writeToHostKernel.setArg(2, lengthCl);
 
-    string testName = "WriteToHostMemory ";
-    testName += (align ? "(aligned),   " : "(unaligned), ");
+    string testName = "WriteToHostMemory, kernel, CL_MEM_USE_HOST_PTR ";
+    testName += (align ? "(aligned)" : "(unaligned)");
 
-    PerformTest([&](cl::Event& event) -> void {
-            queue.enqueueNDRangeKernel(writeToHostKernel, cl::NullRange, global, cl::NullRange, nullptr, &event);
-        }, testName, ITERATIONS);
+    SweepTransferSizes(testName, [&](cl::Event& event, size_t bytes) -> void {
+            cl_int lengthCl = static_cast<cl_int>(bytes / sizeof(float));
+            writeToHostKernel.setArg(2, lengthCl);
+            queue.enqueueNDRangeKernel(writeToHostKernel, cl::NullRange, cl::NDRange(lengthCl / blockSizeCl), cl::NullRange, nullptr, &event);
+        });
 
     free(buffer);
 }
@@ -179,37 +354,333 @@ void Memory::ReadFromHostMemory() {
     string compilerParams = GetCompilerFlags<float>();
     auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
 
+    if (program.get() == nullptr)
+        return;
+
     cl_int status = 0;
     cl::Kernel readKernel(*program, "read_from_buffer_vectorized", &status);
     CHECK(status);
 
-    int length = BUFFER_SIZE / sizeof(float);
+    const size_t bufferSize = MaximumTransferSize();
+    const size_t length = bufferSize / sizeof(float);
     float *buffer = new float[length];
     FillBufferWithContent<float>(buffer, length);
 
     cl_int blockSizeCl = 128;// 4;
-    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, static_cast<size_t>(BUFFER_SIZE), buffer, nullptr);
-    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, sizeof(float) * BUFFER_SIZE / blockSizeCl);
+    cl::Buffer deviceBuffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bufferSize, buffer, nullptr);
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, sizeof(float) * length / blockSizeCl);
 
     cl::CommandQueue& queue = _controller->Queue();
-    queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, BUFFER_SIZE, static_cast<void*>(buffer));
-    queue.finish();
-
-    cl::NDRange global(length / blockSizeCl);
     readKernel.setArg(0, deviceBuffer);
     readKernel.setArg(1, targetBuffer);
     readKernel.setArg(2, blockSizeCl);
-    readKernel.setArg(3, length);
 
-    string testName = "ReadFromHostMemory,            ";
-
-    PerformTest([&](cl::Event& event) -> void {
-            queue.enqueueNDRangeKernel(readKernel, cl::NullRange, global, cl::NullRange, nullptr, &event);
-        }, testName, ITERATIONS);
+    SweepTransferSizes("ReadFromHostMemory, kernel, CL_MEM_USE_HOST_PTR", [&](cl::Event& event, size_t bytes) -> void {
+            cl_int lengthCl = static_cast<cl_int>(bytes / sizeof(float));
+            readKernel.setArg(3, lengthCl);
+            queue.enqueueNDRangeKernel(readKernel, cl::NullRange, cl::NDRange(lengthCl / blockSizeCl), cl::NullRange, nullptr, &event);
+        });
 
     delete[] buffer;
 }
 
+int64_t Memory::TimeHostAccess(const string& testName, size_t bytes, function<void()> prepare, function<void()> access) {
+    _cpuStatistics.Clear();
+
+    for (int i = 0; i < ZERO_COPY_ITERATIONS; ++i) {
+        prepare();
+
+        _timer.Remember();
+        access();
+        _cpuStatistics.Add(_timer.Diff());
+    }
+
+    const int64_t timeCPU = _cpuStatistics.Mean();
+    cout << "  " << testName << ": " << (timeCPU > 0 ? static_cast<double>(bytes) / timeCPU : 0.0) << " GB/s"
+        << " (CPU: " << timeCPU << " (+/- " << _cpuStatistics.Deviation<int64_t>() << ") ns)" << endl;
+
+    return timeCPU;
+}
+
+void Memory::AnalyseZeroCopy() {
+    string compilerParams = GetCompilerFlags<float>();
+    auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
+
+    if (program.get() == nullptr)
+        return;
+
+    cl_int status = 0;
+    cl::Kernel writeKernel(*program, "write_to_buffer_loop_simple", &status);
+    CHECK(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    const size_t bufferSize = min(ZERO_COPY_SIZE, MaximumTransferSize());
+    const size_t length = bufferSize / sizeof(float);
+    const cl_int blockSizeCl = 128;
+
+    void *allocation = malloc(bufferSize + ZERO_COPY_ALIGNMENT);
+    float *hostPointer = AlignAddress<float>(static_cast<float*>(allocation), ZERO_COPY_ALIGNMENT, 0);
+    vector<float> copyBuffer(length);
+    volatile float sink = 0.0f;
+
+    const bool useHostPointer[] = { false, true };
+    for (const bool useHostPtr : useHostPointer) {
+        cl::Buffer buffer = useHostPtr
+            ? cl::Buffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR, bufferSize, hostPointer)
+            : cl::Buffer(_controller->Context(), CL_MEM_READ_WRITE | CL_MEM_ALLOC_HOST_PTR, bufferSize);
+        const string bufferType = useHostPtr ? "CL_MEM_USE_HOST_PTR" : "CL_MEM_ALLOC_HOST_PTR";
+
+        writeKernel.setArg(0, buffer);
+        writeKernel.setArg(1, blockSizeCl);
+        writeKernel.setArg(2, static_cast<cl_int>(length));
+
+        // the device writes the buffer before every read test, so the host has to see the device's data
+        auto writeOnDevice = [&]() -> void {
+            queue.enqueueNDRangeKernel(writeKernel, cl::NullRange, cl::NDRange(length / blockSizeCl), cl::NullRange);
+            queue.finish();
+        };
+        auto nothing = []() -> void { };
+
+        cout << "ZeroCopy, " << bufferType << ", " << FormatSize(bufferSize) << ":" << endl;
+
+        const int64_t mapTime = TimeHostAccess("map (CL_MAP_READ), unmap", bufferSize, writeOnDevice, [&]() -> void {
+                void *mapped = queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_READ, 0, bufferSize);
+                queue.enqueueUnmapMemObject(buffer, mapped);
+                queue.finish();
+            });
+        const int64_t copyTime = TimeHostAccess("ReadBuffer", bufferSize, writeOnDevice, [&]() -> void {
+                queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bufferSize, &copyBuffer[0]);
+            });
+
+        TimeHostAccess("map (CL_MAP_READ), read, unmap", bufferSize, writeOnDevice, [&]() -> void {
+                float *mapped = static_cast<float*>(queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_READ, 0, bufferSize));
+                sink = sink + TouchRead(mapped, length);
+                queue.enqueueUnmapMemObject(buffer, mapped);
+                queue.finish();
+            });
+        TimeHostAccess("ReadBuffer, read", bufferSize, writeOnDevice, [&]() -> void {
+                queue.enqueueReadBuffer(buffer, CL_TRUE, 0, bufferSize, &copyBuffer[0]);
+                sink = sink + TouchRead(&copyBuffer[0], length);
+            });
+        TimeHostAccess("map (CL_MAP_WRITE), write, unmap", bufferSize, nothing, [&]() -> void {
+                float *mapped = static_cast<float*>(queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_WRITE, 0, bufferSize));
+                TouchWrite(mapped, length);
+                queue.enqueueUnmapMemObject(buffer, mapped);
+                queue.finish();
+            });
+        TimeHostAccess("map (CL_MAP_WRITE_INVALIDATE_REGION), write, unmap", bufferSize, nothing, [&]() -> void {
+                float *mapped = static_cast<float*>(queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_WRITE_INVALIDATE_REGION, 0, bufferSize));
+                TouchWrite(mapped, length);
+                queue.enqueueUnmapMemObject(buffer, mapped);
+                queue.finish();
+            });
+        TimeHostAccess("write, WriteBuffer", bufferSize, nothing, [&]() -> void {
+                TouchWrite(&copyBuffer[0], length);
+                queue.enqueueWriteBuffer(buffer, CL_TRUE, 0, bufferSize, &copyBuffer[0]);
+            });
+
+        // a zero-copy map returns the same memory every time (the host pointer for CL_MEM_USE_HOST_PTR),
+        // shows the data written by the device and is much cheaper than copying the buffer
+        writeOnDevice();
+        float *firstMapping = static_cast<float*>(queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_READ, 0, bufferSize));
+        Validate("ZeroCopy, " + bufferType + ", mapped content", length, [&](int64_t i) -> bool {
+                return firstMapping[i] == static_cast<float>(i);
+            });
+        queue.enqueueUnmapMemObject(buffer, firstMapping);
+        float *secondMapping = static_cast<float*>(queue.enqueueMapBuffer(buffer, CL_TRUE, CL_MAP_READ, 0, bufferSize));
+        queue.enqueueUnmapMemObject(buffer, secondMapping);
+        queue.finish();
+
+        const bool samePointer = useHostPtr ? firstMapping == hostPointer : firstMapping == secondMapping;
+        const bool cheapMap = mapTime < HIDDEN_COPY_FRACTION * copyTime;
+        cout << "  zero-copy: " << (samePointer && cheapMap ? "yes" : "no") << " (mapped pointer "
+            << (samePointer ? "stable" : "changes") << ", map takes " << (copyTime > 0 ? 100.0 * mapTime / copyTime : 0.0)
+            << "% of ReadBuffer)" << endl;
+    }
+
+    free(allocation);
+}
+
+void Memory::AnalyseLatency(size_t stride) {
+    string compilerParams = GetCompilerFlags<float>();
+    auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
+
+    if (program.get() == nullptr)
+        return;
+
+    cl_int status = 0;
+    cl::Kernel chaseKernel(*program, "pointer_chase", &status);
+    CHECK(status);
+
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+
+    size_t maximumFootprint = LATENCY_MIN_FOOTPRINT;
+    while (maximumFootprint * 2 <= LATENCY_MAX_FOOTPRINT && maximumFootprint * 2 <= maxAllocationSize)
+        maximumFootprint *= 2;
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::Buffer chainBuffer(_controller->Context(), CL_MEM_READ_ONLY, maximumFootprint);
+    cl::Buffer resultBuffer(_controller->Context(), CL_MEM_WRITE_ONLY, sizeof(cl_uint));
+
+    chaseKernel.setArg(0, chainBuffer);
+    chaseKernel.setArg(1, resultBuffer);
+    chaseKernel.setArg(2, LATENCY_STEPS);
+
+    // only every (stride / 4)th value of the chain is part of the list, the others are never read
+    const size_t elementStride = stride / sizeof(cl_uint);
+    vector<cl_uint> chain(maximumFootprint / sizeof(cl_uint));
+    vector<cl_uint> expectedResults, results;
+    default_random_engine randomEngine(RANDOM_SEED);
+    cl_ulong startTime, endTime;
+
+    cout << "Latency, pointer chase with a stride of " << stride << " bytes" << endl;
+
+    for (size_t footprint = max(LATENCY_MIN_FOOTPRINT, LATENCY_MIN_ELEMENTS * stride); footprint <= maximumFootprint; footprint *= 2) {
+        const size_t elements = footprint / stride;
+
+        // Sattolo's algorithm: a random permutation which consists of a single cycle through all elements
+        vector<cl_uint> next(elements);
+        for (size_t i = 0; i < elements; ++i)
+            next[i] = static_cast<cl_uint>(i);
+        for (size_t i = elements - 1; i > 0; --i)
+            swap(next[i], next[uniform_int_distribution<size_t>(0, i - 1)(randomEngine)]);
+
+        for (size_t i = 0; i < elements; ++i)
+            chain[i * elementStride] = static_cast<cl_uint>(next[i] * elementStride);
+        queue.enqueueWriteBuffer(chainBuffer, CL_TRUE, 0, footprint, &chain[0]);
+
+        // the first chase is not timed, it loads the list into the caches
+        _gpuStatistics.Clear();
+        for (int i = -1; i < LATENCY_ITERATIONS; ++i) {
+            cl::Event event;
+            status = queue.enqueueNDRangeKernel(chaseKernel, cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, &event);
+            WAIT_AND_CHECK(event, status);
+
+            if (i < 0)
+                continue;
+
+            event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+            event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+            _gpuStatistics.Add(endTime - startTime);
+        }
+
+        cl_uint result = 0;
+        queue.enqueueReadBuffer(resultBuffer, CL_TRUE, 0, sizeof(cl_uint), &result);
+        results.push_back(result);
+
+        cl_uint index = 0;
+        for (int i = 0; i < LATENCY_STEPS; ++i)
+            index = next[index];
+        expectedResults.push_back(static_cast<cl_uint>(index * elementStride));
+
+        cout << "  " << FormatSize(footprint) << ": " << static_cast<double>(_gpuStatistics.Mean()) / LATENCY_STEPS
+            << " ns per load (GPU: " << _gpuStatistics.Mean() << " ns for " << LATENCY_STEPS << " loads)" << endl;
+    }
+
+    Validate("pointer chase, stride " + to_string(stride), static_cast<int64_t>(results.size()), [&](int64_t i) -> bool {
+            return results[i] == expectedResults[i];
+        });
+}
+
+void Memory::AnalyseAccessPatterns() {
+    string compilerParams = GetCompilerFlags<float>();
+    auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
+
+    if (program.get() == nullptr)
+        return;
+
+    cl_int status = 0;
+    cl::Kernel stridedKernel(*program, "read_strided", &status);
+    CHECK(status);
+    cl::Kernel gatherKernel(*program, "gather", &status);
+    CHECK(status);
+    cl::Kernel scatterKernel(*program, "scatter", &status);
+    CHECK(status);
+
+    const cl_uint length = 1u << ACCESS_PATTERN_LENGTH_BITS;
+    const size_t bufferSize = length * sizeof(float);
+
+    // the values equal their index, so every result shows which element has been read
+    vector<float> data(length), results(length);
+    FillBufferWithContent<float>(&data[0], length);
+    vector<cl_uint> indices(length);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::Buffer dataBuffer(_controller->Context(), CL_MEM_READ_ONLY, bufferSize);
+    cl::Buffer indexBuffer(_controller->Context(), CL_MEM_READ_ONLY, length * sizeof(cl_uint));
+    cl::Buffer targetBuffer(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    queue.enqueueWriteBuffer(dataBuffer, CL_TRUE, 0, bufferSize, &data[0]);
+
+    default_random_engine randomEngine(RANDOM_SEED);
+    cl::NDRange global(length);
+
+    // executes one pattern, bytes are the values read and written plus the indices
+    auto measure = [&](cl::Kernel& kernel, const string& patternName, double bytes) -> void {
+            PerformTest([&](cl::Event& event) -> void {
+                    queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, cl::NullRange, nullptr, &event);
+                }, "  " + patternName + ",", ACCESS_PATTERN_ITERATIONS);
+
+            const int64_t timeGPU = _gpuStatistics.Mean();
+            cout << "  " << patternName << ": " << (timeGPU > 0 ? bytes / timeGPU : 0.0) << " GB/s" << endl;
+
+            queue.enqueueReadBuffer(targetBuffer, CL_TRUE, 0, bufferSize, &results[0]);
+        };
+
+    cout << "Access patterns, " << FormatSize(bufferSize) << " of float values" << endl;
+
+    stridedKernel.setArg(0, dataBuffer);
+    stridedKernel.setArg(1, targetBuffer);
+    stridedKernel.setArg(3, length);
+    stridedKernel.setArg(4, static_cast<cl_uint>(ACCESS_PATTERN_LENGTH_BITS));
+
+    for (cl_uint stride = 1; stride <= MAX_ACCESS_STRIDE; stride *= 2) {
+        stridedKernel.setArg(2, stride);
+        const string patternName = "stride " + to_string(stride);
+        measure(stridedKernel, patternName, 2.0 * bufferSize);
+
+        ValidateResults(patternName, &results[0], length, [&](int64_t i) -> float {
+                const uint64_t position = static_cast<uint64_t>(i) * stride;
+                return static_cast<float>((position & (length - 1)) + (position >> ACCESS_PATTERN_LENGTH_BITS));
+            });
+    }
+
+    gatherKernel.setArg(0, dataBuffer);
+    gatherKernel.setArg(1, indexBuffer);
+    gatherKernel.setArg(2, targetBuffer);
+
+    // locality control: the indices are a random permutation within aligned windows,
+    // the last window covers the whole array (random gather)
+    vector<size_t> windows(begin(ACCESS_PATTERN_WINDOWS), end(ACCESS_PATTERN_WINDOWS));
+    windows.push_back(length);
+
+    for (auto& window : windows) {
+        for (cl_uint i = 0; i < length; ++i)
+            indices[i] = i;
+        for (size_t offset = 0; offset < length; offset += window)
+            shuffle(indices.begin() + offset, indices.begin() + offset + window, randomEngine);
+        queue.enqueueWriteBuffer(indexBuffer, CL_TRUE, 0, length * sizeof(cl_uint), &indices[0]);
+
+        const string patternName = window == length ? string("random gather")
+            : "indexed gather, window of " + to_string(window) + " elements";
+        measure(gatherKernel, patternName, 2.0 * bufferSize + length * sizeof(cl_uint));
+
+        ValidateResults(patternName, &results[0], length, [&](int64_t i) -> float {
+                return static_cast<float>(indices[i]);
+            });
+    }
+
+    // the indices still contain the random permutation of the whole array, so no element is written twice
+    scatterKernel.setArg(0, dataBuffer);
+    scatterKernel.setArg(1, indexBuffer);
+    scatterKernel.setArg(2, targetBuffer);
+    measure(scatterKernel, "random scatter", 2.0 * bufferSize + length * sizeof(cl_uint));
+
+    Validate("random scatter", length, [&](int64_t i) -> bool {
+            return results[indices[i]] == static_cast<float>(i);
+        });
+}
+
 void Memory::AnalyseMemoryAccessPatterns() {
     string compilerParams = GetCompilerFlags<float>();
     auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "memory.cl", compilerParams);
@@ -288,13 +759,32 @@ void Memory::AnalyseMemoryAccessPatterns() {
 void Memory::Run() {
     cout << "Memory Benchmarks" << endl;
 
+    cout << "Bandwidth per transfer size (" << FormatSize(MIN_TRANSFER_SIZE) << " to " << FormatSize(MaximumTransferSize()) << "):" << endl;
     CopyMemoryToDevice(true);
     CopyMemoryToDevice(false);
+    CopyAllocatedHostMemoryToDevice();
     CopyUnpinnedMemoryToDevice();
+    CopyPinnedMemoryToDevice();
+    CopyOnDevice();
     CopyToHostMemory();
     CopyToUnpinnedHostMemory();
+    CopyToPinnedHostMemory();
+    MapDeviceMemory();
     WriteToHostMemory(true);
     WriteToHostMemory(false);
+    ReadFromHostMemory();
+
+    AnalyseZeroCopy();
+
+    // a stride passed with --latency-stride replaces the default ones
+    if (_latencyStride > 0) {
+        AnalyseLatency(_latencyStride);
+    } else {
+        for (auto& stride : LATENCY_STRIDES)
+            AnalyseLatency(stride);
+    }
+
+    AnalyseAccessPatterns();
 
     int workGroupSizes[] = { 32, 64, 128, 192, 256, 512 };
 
@@ -303,7 +793,6 @@ void Memory::Run() {
 
         cout << "WorkGroupSize set to: " << workGroupSize << endl;
 
-        ReadFromHostMemory();
         AnalyseMemoryAccessPatterns();
     }
 
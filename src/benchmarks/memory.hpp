@@ -3,6 +3,7 @@
 
 #include "../benchmarkbase.hpp"
 
+#include <functional>
 #include <string>
 
 namespace cl {
@@ -18,30 +19,75 @@ namespace benchmarks {
 class Memory : public BenchmarkBase {
 private:
     template<typename TItem>
-    void FillBufferWithContent(TItem *buffer, int length);
+    void FillBufferWithContent(TItem *buffer, size_t length);
 
     /**
-     * Copy a memory buffer to the device.
+     * Executes a transfer for all sizes of the sweep (MIN_TRANSFER_SIZE up to MaximumTransferSize())
+     * and prints the bandwidth curve. Small sizes show the latency of a transfer, large sizes the bandwidth.
+     *
+     * @param testName name of the transfer type
+     * @param transfer enqueues one transfer of the given amount of bytes, the event has to belong to the
+     *                 transferring command
+     */
+    void SweepTransferSizes(const std::string& testName, std::function<void(cl::Event&, size_t bytes)> transfer);
+
+    /**
+     * @return largest size of the sweep which does not exceed the maximum allocation size of the device
+     */
+    size_t MaximumTransferSize();
+
+    /**
+     * @return number of timed transfers, scaled so that every size moves roughly TRANSFER_VOLUME bytes
+     */
+    static int IterationsForSize(size_t bytes);
+
+    /**
+     * Copy from a CL_MEM_USE_HOST_PTR buffer to the device.
      * 
      * @param align true if the memory on the host should be aligned efficiently.
      */
 	void CopyMemoryToDevice(bool align);
 
     /**
-     * Copy a regular buffer allocated with new or malloc (=unpinned) to the device.
+     * Copy from a CL_MEM_ALLOC_HOST_PTR buffer to the device.
+     */
+    void CopyAllocatedHostMemoryToDevice();
+
+    /**
+     * Write a regular buffer allocated with new or malloc (=unpinned) to the device.
      */
     void CopyUnpinnedMemoryToDevice();
 
     /**
-     * Copy back to host memory.
+     * Write from pinned memory (a mapped CL_MEM_ALLOC_HOST_PTR buffer) to the device.
+     */
+    void CopyPinnedMemoryToDevice();
+
+    /**
+     * Copy from one device buffer to another one.
+     */
+    void CopyOnDevice();
+
+    /**
+     * Copy back to a CL_MEM_ALLOC_HOST_PTR buffer.
      */
     void CopyToHostMemory();
     
     /**
-     * Copy to unpinned host memory.
+     * Read into unpinned host memory.
      */
     void CopyToUnpinnedHostMemory();
 
+    /**
+     * Read into pinned host memory (a mapped CL_MEM_ALLOC_HOST_PTR buffer).
+     */
+    void CopyToPinnedHostMemory();
+
+    /**
+     * Map a device buffer for reading and unmap it again.
+     */
+    void MapDeviceMemory();
+
     /**
      * Let a kernel write to host memory.
      *
@@ -50,10 +96,43 @@ private:
 	void WriteToHostMemory(bool align);
 
     /**
-     * Read from host memory.
+     * Let a kernel read from host memory.
      */
     void ReadFromHostMemory();
 
+    /**
+     * Times a host side access pattern (e.g. map, touch, unmap) with the cpu timer and prints
+     * the effective bandwidth.
+     *
+     * @param prepare executed before every timed access, not part of the measurement
+     * @param access the measured operation, has to be complete when it returns
+     * @return mean duration of access in ns
+     */
+    int64_t TimeHostAccess(const std::string& testName, size_t bytes, std::function<void()> prepare, std::function<void()> access);
+
+    /**
+     * Compare map, touch and unmap of CL_MEM_ALLOC_HOST_PTR and CL_MEM_USE_HOST_PTR buffers with
+     * copy based transfers and check whether mapping really avoids a copy (zero-copy).
+     */
+    void AnalyseZeroCopy();
+
+    /**
+     * Measures the latency of dependent loads with a pointer chase over a randomly permuted cyclic list.
+     * The footprint of the list is swept from LATENCY_MIN_FOOTPRINT up to the maximum allocation size,
+     * the steps of the resulting curve show the cache levels, the TLB reach and the DRAM latency.
+     *
+     * @param stride distance in bytes between two elements of the list
+     */
+    void AnalyseLatency(size_t stride);
+
+    /**
+     * Effective bandwidth of a copy with one irregular side: strided reads from unit stride up to
+     * MAX_ACCESS_STRIDE, gathers with a controlled locality (random indices within windows of growing
+     * size), a fully random gather and a random scatter. Only the copied values and the indices count
+     * as transferred bytes, so the numbers show how much of the bandwidth an irregular kernel can use.
+     */
+    void AnalyseAccessPatterns();
+
     /**
      * Compare column- vs row-major data layouts.
      */
@@ -0,0 +1,330 @@
+#include "montecarlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int PATHS = 1 << 20;               // per option
+static const int PATHS_PER_WORK_ITEM = 16;
+static const int ASIAN_STEPS = 64;              // averaging dates of the Asian options
+static const int ITERATIONS = 10;
+static const int RANDOM_SEED = 85733;
+
+// the host simulation runs in double precision, single precision sums of 2^20 payoffs differ slightly
+static const double FLOAT_TOLERANCE = 1e-3;
+// European prices have to be within this number of standard errors of the closed-form solution
+static const double STANDARD_ERRORS = 4.0;
+
+struct OptionParameters {
+    double spot;
+    double strike;
+    double time;
+    double rate;
+    double volatility;
+};
+
+static const OptionParameters OPTIONS[] = {
+    { 100.0, 100.0, 1.0, 0.05, 0.2 },       // at the money
+    { 100.0, 110.0, 0.5, 0.03, 0.3 },       // out of the money
+    { 50.0, 45.0, 2.0, 0.04, 0.25 },        // in the money, long maturity
+    { 120.0, 100.0, 0.25, 0.01, 0.4 }       // deep in the money, high volatility
+};
+static const int OPTION_COUNT = sizeof(OPTIONS) / sizeof(OPTIONS[0]);
+
+// host version of Philox4x32-10 in montecarlo.cl
+static void Philox4x32(uint32_t counter[4], uint32_t key0, uint32_t key1) {
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            key0 += 0x9E3779B9u;
+            key1 += 0xBB67AE85u;
+        }
+
+        const uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+        const uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+        const uint32_t next[4] = {
+            static_cast<uint32_t>(product1 >> 32) ^ counter[1] ^ key0, static_cast<uint32_t>(product1),
+            static_cast<uint32_t>(product0 >> 32) ^ counter[3] ^ key1, static_cast<uint32_t>(product0)
+        };
+        copy(next, next + 4, counter);
+    }
+}
+
+// known-answer vectors of Philox4x32-10 from Random123 (kat_vectors): counter, key, expected output
+static const uint32_t PHILOX_KNOWN_ANSWERS[][10] = {
+    { 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u,
+      0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u },
+    { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu,
+      0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu },
+    { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u, 0xa4093822u, 0x299f31d0u,
+      0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u }
+};
+static const int PHILOX_KNOWN_ANSWER_COUNT = sizeof(PHILOX_KNOWN_ANSWERS) / sizeof(PHILOX_KNOWN_ANSWERS[0]);
+
+static void BoxMuller(const uint32_t bits[4], double normals[4]) {
+    const double twoPi = 6.28318530717958647693;
+    for (int i = 0; i < 2; ++i) {
+        const double radius = sqrt(-2.0 * log(bits[2 * i] * 2.3283064365386963e-10 + 1.1641532182693481e-10));
+        const double angle = twoPi * (bits[2 * i + 1] * 2.3283064365386963e-10 + 1.1641532182693481e-10);
+        normals[2 * i] = radius * cos(angle);
+        normals[2 * i + 1] = radius * sin(angle);
+    }
+}
+
+// undiscounted payoff of one path, steps = 0 for the European option
+static double ReferencePayoff(int option, int path, int steps) {
+    const OptionParameters& parameters = OPTIONS[option];
+    const double sigma = parameters.volatility;
+    double normals[4];
+
+    if (steps == 0) {
+        uint32_t counter[4] = { static_cast<uint32_t>(path), 0, 0, 0 };
+        Philox4x32(counter, RANDOM_SEED, option);
+        BoxMuller(counter, normals);
+
+        const double drift = (parameters.rate - 0.5 * sigma * sigma) * parameters.time;
+        const double price = parameters.spot * exp(drift + sigma * sqrt(parameters.time) * normals[0]);
+        return max(price - parameters.strike, 0.0);
+    }
+
+    const double dt = parameters.time / steps;
+    const double drift = (parameters.rate - 0.5 * sigma * sigma) * dt;
+    const double diffusion = sigma * sqrt(dt);
+    double price = parameters.spot;
+    double average = 0.0;
+
+    for (int step = 0; step < steps; step += 4) {
+        uint32_t counter[4] = { static_cast<uint32_t>(path), static_cast<uint32_t>(step / 4), 0, 0 };
+        Philox4x32(counter, RANDOM_SEED, option);
+        BoxMuller(counter, normals);
+
+        for (int i = 0; i < 4 && step + i < steps; ++i) {
+            price *= exp(drift + diffusion * normals[i]);
+            average += price;
+        }
+    }
+
+    return max(average / steps - parameters.strike, 0.0);
+}
+
+static double ClosedFormCall(const OptionParameters& parameters) {
+    const double sigmaSqrtT = parameters.volatility * sqrt(parameters.time);
+    const double d1 = (log(parameters.spot / parameters.strike)
+        + (parameters.rate + 0.5 * parameters.volatility * parameters.volatility) * parameters.time) / sigmaSqrtT;
+    const double d2 = d1 - sigmaSqrtT;
+
+    return parameters.spot * 0.5 * erfc(-d1 * 0.70710678118654752440)
+        - parameters.strike * exp(-parameters.rate * parameters.time) * 0.5 * erfc(-d2 * 0.70710678118654752440);
+}
+
+MonteCarlo::MonteCarlo(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller) {
+
+}
+
+MonteCarlo::~MonteCarlo() {
+
+}
+
+template <typename TItem>
+int MonteCarlo::InitContext() {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "montecarlo.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    _groupsPerOption = (PATHS + WORK_GROUP_SIZE * PATHS_PER_WORK_ITEM - 1) / (WORK_GROUP_SIZE * PATHS_PER_WORK_ITEM);
+
+    // the options as structure of arrays
+    vector<TItem> spot, strike, time, rate, volatility;
+    for (const auto& option : OPTIONS) {
+        spot.push_back(static_cast<TItem>(option.spot));
+        strike.push_back(static_cast<TItem>(option.strike));
+        time.push_back(static_cast<TItem>(option.time));
+        rate.push_back(static_cast<TItem>(option.rate));
+        volatility.push_back(static_cast<TItem>(option.volatility));
+    }
+
+    cl_int status = CL_SUCCESS;
+    const cl::Context& context = _controller->Context();
+    const size_t bytes = OPTION_COUNT * sizeof(TItem);
+    _spotBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, &spot[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _strikeBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, &strike[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _timeBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, &time[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _rateBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, &rate[0], &status);
+    CHECK_RETURN_ERROR(status);
+    _volatilityBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, &volatility[0], &status);
+    CHECK_RETURN_ERROR(status);
+
+    // sum and sum of squares per work-group and option, per option after the reduction
+    _partialsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, 2 * _groupsPerOption * bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _resultBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, 2 * bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+template <typename TItem>
+void MonteCarlo::RunInternal(int steps) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const string testName = string("MonteCarlo") + (is_same<TItem, float>::value ? "<float>" : "<double>")
+        + (steps == 0 ? " European" : " Asian (" + to_string(steps) + " steps)");
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel simulationKernel(*_program, steps == 0 ? "MonteCarloEuropean" : "MonteCarloAsian", &status);
+    CHECK(status);
+    cl::Kernel reductionKernel(*_program, "ReducePartials", &status);
+    CHECK(status);
+
+    int argument = 0;
+    simulationKernel.setArg(argument++, *_spotBuffer);
+    simulationKernel.setArg(argument++, *_strikeBuffer);
+    simulationKernel.setArg(argument++, *_timeBuffer);
+    simulationKernel.setArg(argument++, *_rateBuffer);
+    simulationKernel.setArg(argument++, *_volatilityBuffer);
+    simulationKernel.setArg(argument++, PATHS);
+    simulationKernel.setArg(argument++, static_cast<cl_uint>(RANDOM_SEED));
+    if (steps > 0)
+        simulationKernel.setArg(argument++, steps);
+    simulationKernel.setArg(argument++, *_partialsBuffer);
+
+    reductionKernel.setArg(0, *_partialsBuffer);
+    reductionKernel.setArg(1, _groupsPerOption);
+    reductionKernel.setArg(2, *_resultBuffer);
+
+    const cl::NDRange simulationGlobal(_groupsPerOption * WORK_GROUP_SIZE, OPTION_COUNT);
+    const cl::NDRange reductionGlobal(WORK_GROUP_SIZE, OPTION_COUNT);
+    const cl::NDRange local(WORK_GROUP_SIZE, 1);
+
+    // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            events.resize(2);
+            status = queue.enqueueNDRangeKernel(simulationKernel, cl::NullRange, simulationGlobal, local, nullptr, &events[0]);
+            if (status == CL_SUCCESS)
+                status = queue.enqueueNDRangeKernel(reductionKernel, cl::NullRange, reductionGlobal, local, nullptr, &events[1]);
+            if (status != CL_SUCCESS)
+                events.clear();
+        }, testName + ",", ITERATIONS);
+    CHECK(status);
+
+    const double time = _gpuStatistics.Mean();
+    cout << "  " << testName << ", " << OPTION_COUNT << " options x " << PATHS << " paths: "
+        << (time > 0.0 ? 1000.0 * OPTION_COUNT * PATHS / time : 0.0) << " Mpaths/s" << endl;
+
+    vector<TItem> results(2 * OPTION_COUNT);
+    status = queue.enqueueReadBuffer(*_resultBuffer, CL_TRUE, 0, results.size() * sizeof(TItem), &results[0]);
+    CHECK(status);
+
+    for (int option = 0; option < OPTION_COUNT; ++option) {
+        const OptionParameters& parameters = OPTIONS[option];
+        const double discount = exp(-parameters.rate * parameters.time);
+        const double mean = results[2 * option] / PATHS;
+        const double variance = max(0.0, results[2 * option + 1] / PATHS - mean * mean);
+
+        cout << "    S=" << parameters.spot << " K=" << parameters.strike << " T=" << parameters.time
+            << ": " << discount * mean << " (+/- " << discount * sqrt(variance / (PATHS - 1)) << ")";
+        if (steps == 0)
+            cout << ", closed form " << ClosedFormCall(parameters);
+        cout << endl;
+    }
+
+    ValidatePrices<TItem>(testName, results, steps);
+}
+
+template <typename TItem>
+void MonteCarlo::ValidatePrices(const string& testName, const vector<TItem>& results, int steps) {
+    if (!ValidationEnabled())
+        return;
+
+    // sums of the undiscounted payoffs of the same paths as on the device
+    vector<double> references(OPTION_COUNT);
+    for (int option = 0; option < OPTION_COUNT; ++option) {
+        mutex sumMutex;
+        double sum = 0.0;
+        ParallelFor(PATHS, [&](int64_t begin, int64_t end) -> void {
+                double localSum = 0.0;
+                for (int64_t path = begin; path < end; ++path)
+                    localSum += ReferencePayoff(option, static_cast<int>(path), steps);
+
+                lock_guard<mutex> lock(sumMutex);
+                sum += localSum;
+            });
+        references[option] = sum;
+    }
+
+    const double tolerance = is_same<TItem, float>::value ? FLOAT_TOLERANCE : ValidationTolerance<TItem>();
+    vector<TItem> sums(OPTION_COUNT);
+    for (int option = 0; option < OPTION_COUNT; ++option)
+        sums[option] = results[2 * option] / PATHS;
+
+    ValidateResults(testName + " host simulation", &sums[0], OPTION_COUNT, [&](int64_t i) -> double {
+            return references[i] / PATHS;
+        }, tolerance);
+
+    if (steps > 0)
+        return;
+
+    Validate(testName + " closed form", OPTION_COUNT, [&](int64_t i) -> bool {
+            const OptionParameters& parameters = OPTIONS[i];
+            const double discount = exp(-parameters.rate * parameters.time);
+            const double mean = results[2 * i] / PATHS;
+            const double standardError = sqrt(max(0.0, results[2 * i + 1] / PATHS - mean * mean) / (PATHS - 1));
+            return abs(discount * mean - ClosedFormCall(parameters)) <= STANDARD_ERRORS * discount * standardError;
+        });
+}
+
+void MonteCarlo::Cleanup() {
+    _spotBuffer.reset();
+    _strikeBuffer.reset();
+    _timeBuffer.reset();
+    _rateBuffer.reset();
+    _volatilityBuffer.reset();
+    _partialsBuffer.reset();
+    _resultBuffer.reset();
+    _program.reset();
+}
+
+void MonteCarlo::Run() {
+    cout << "MonteCarlo (" << PATHS << " paths per option, Philox4x32-10, Box-Muller):" << endl;
+
+    // the host simulation only proves something if its generator is the real Philox4x32-10
+    Validate("Philox4x32-10 known answers", PHILOX_KNOWN_ANSWER_COUNT, [](int64_t i) -> bool {
+            const uint32_t* answer = PHILOX_KNOWN_ANSWERS[i];
+            uint32_t counter[4] = { answer[0], answer[1], answer[2], answer[3] };
+            Philox4x32(counter, answer[4], answer[5]);
+            return equal(counter, counter + 4, answer + 6);
+        });
+
+    if (InitContext<float>() == 0) {
+        RunInternal<float>(0);
+        RunInternal<float>(ASIAN_STEPS);
+    }
+    Cleanup();
+
+    if (_controller->SupportsDoublePrecision()) {
+        if (InitContext<double>() == 0) {
+            RunInternal<double>(0);
+            RunInternal<double>(ASIAN_STEPS);
+        }
+        Cleanup();
+    }
+
+    cout << endl;
+}
@@ -0,0 +1,73 @@
+#ifndef __BENCH_BENCHMARKS_MONTECARLO_HPP
+#define __BENCH_BENCHMARKS_MONTECARLO_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Prices European and arithmetic Asian call options by Monte Carlo simulation, the counterpart of the
+ * closed-form BlackScholes benchmark. The normal random numbers are generated on the device with the
+ * counter-based Philox4x32-10 generator and the Box-Muller transform, the payoffs are reduced per work-group
+ * and per option. The throughput is reported in paths per second. The prices are compared with a host
+ * simulation of the same random numbers, European prices also with the closed-form solution. The host
+ * generator is checked against the Random123 known-answer vectors first.
+ */
+class MonteCarlo : public BenchmarkBase {
+private:
+    std::shared_ptr<cl::Buffer> _spotBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _strikeBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _timeBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _rateBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _volatilityBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _partialsBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _resultBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    int _groupsPerOption = 0;
+
+    /**
+     * Compile the kernels, copy the options to the device and allocate the buffers for the partial results.
+     */
+    template <typename TItem>
+    int InitContext();
+
+    /**
+     * Simulate and price all options with European or Asian payoffs and print the throughput.
+     *
+     * @param steps number of averaging dates of the Asian options, 0 for European options
+     */
+    template <typename TItem>
+    void RunInternal(int steps);
+
+    /**
+     * Compare the prices with the host simulation and, for European options, with the closed-form solution.
+     *
+     * @param results sum and sum of squares of the payoffs for every option
+     */
+    template <typename TItem>
+    void ValidatePrices(const std::string& testName, const std::vector<TItem>& results, int steps);
+
+    /**
+     * Release the buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit MonteCarlo(std::shared_ptr<ComputeController> controller);
+
+    virtual ~MonteCarlo();
+
+    /**
+     * Execute the tests in single and, if supported, double precision.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_MONTECARLO_HPP
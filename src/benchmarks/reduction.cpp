@@ -0,0 +1,210 @@
+#include "reduction.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int GROUPS_PER_COMPUTE_UNIT = 8;
+static const int MIN_SIZE_BITS = 16;
+static const int MAX_SIZE_BITS = 28;
+static const int SIZE_STEP_BITS = 4;
+static const int ITERATIONS = 20;
+
+// small integers: all sums are exact in double and stay below 2^31 for 2^28 elements
+template <typename TItem>
+static TItem InputValue(int64_t i) {
+    return static_cast<TItem>(((static_cast<uint32_t>(i) * 2654435761u) >> 28) & 3);
+}
+
+Reduction::Reduction(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _sizes()
+    , _copyBandwidth()
+    , _reference() {
+
+}
+
+Reduction::~Reduction() {
+
+}
+
+template <typename TItem>
+int Reduction::InitContext() {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+    if (_workGroupFunctions)
+        compilerParams += " -cl-std=CL2.0 -DWORK_GROUP_FUNCTIONS";
+    if (_subGroupFunctions)
+        compilerParams += " -DSUB_GROUP_FUNCTIONS";
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "reduction.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    cl_ulong maxAllocationSize = 0;
+    cl_ulong globalMemorySize = 0;
+    cl_uint computeUnits = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_GLOBAL_MEM_SIZE, &globalMemorySize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_COMPUTE_UNITS, &computeUnits);
+    _maxWorkGroups = max<int>(1, computeUnits * GROUPS_PER_COMPUTE_UNIT);
+
+    // the input and the two buffers of the copy bandwidth measurement have to fit into memory
+    _sizes.clear();
+    _copyBandwidth.clear();
+    for (int bits = MIN_SIZE_BITS; bits <= MAX_SIZE_BITS; bits += SIZE_STEP_BITS) {
+        const size_t bytes = (static_cast<size_t>(1) << bits) * sizeof(TItem);
+        if (bytes > maxAllocationSize || 3 * bytes > globalMemorySize)
+            break;
+
+        _sizes.push_back(1 << bits);
+        _copyBandwidth.push_back(DeviceCopyBandwidth(bytes));
+    }
+
+    if (_sizes.empty())
+        return -1;
+
+    const int length = _sizes.back();
+    vector<TItem> input(length);
+    ParallelFor(length, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t i = begin; i < end; ++i)
+                input[i] = InputValue<TItem>(i);
+        });
+
+    cl_int status = CL_SUCCESS;
+    _inputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY, length * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _partialsBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, _maxWorkGroups * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    status = _controller->Queue().enqueueWriteBuffer(*_inputBuffer, CL_TRUE, 0, length * sizeof(TItem), &input[0]);
+    CHECK_RETURN_ERROR(status);
+
+    // the sizes are prefixes of each other, so the reference is accumulated size by size
+    _reference.clear();
+    double sum = 0.0;
+    int begin = 0;
+    for (auto& size : _sizes) {
+        for (int i = begin; i < size; ++i)
+            sum += static_cast<double>(input[i]);
+        _reference.push_back(sum);
+        begin = size;
+    }
+
+    return 0;
+}
+
+template <typename TItem>
+void Reduction::RunInternal(const string& kernelName) {
+    cl_int status = CL_SUCCESS;
+    cl::Kernel kernel(*_program, kernelName.c_str(), &status);
+    CHECK(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::NDRange local(WORK_GROUP_SIZE);
+    vector<TItem> results;
+
+    for (size_t s = 0; s < _sizes.size(); ++s) {
+        const int length = _sizes[s];
+        const int workGroups = min(_maxWorkGroups, (length + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE);
+
+        // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                events.resize(2);
+
+                kernel.setArg(0, *_inputBuffer);
+                kernel.setArg(1, *_partialsBuffer);
+                kernel.setArg(2, length);
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(workGroups * WORK_GROUP_SIZE), local, nullptr, &events[0]);
+
+                // the partial sums are reduced in place by a single work-group
+                if (status == CL_SUCCESS) {
+                    kernel.setArg(0, *_partialsBuffer);
+                    kernel.setArg(2, workGroups);
+                    status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, local, local, nullptr, &events[1]);
+                }
+                if (status != CL_SUCCESS)
+                    events.clear();
+            }, "  " + kernelName + ", " + to_string(length) + " elements,", ITERATIONS);
+        CHECK(status);
+
+        const int64_t timeGPU = _gpuStatistics.Mean();
+        const double bandwidth = timeGPU > 0 ? static_cast<double>(length) * sizeof(TItem) / timeGPU : 0.0;
+        cout << "  " << kernelName << ", " << length << " elements: " << bandwidth << " GB/s";
+        if (_copyBandwidth[s] > 0.0)
+            cout << " (" << 100.0 * bandwidth / _copyBandwidth[s] << "% of copy bandwidth, " << _copyBandwidth[s] << " GB/s)";
+        cout << endl;
+
+        TItem result = 0;
+        status = queue.enqueueReadBuffer(*_partialsBuffer, CL_TRUE, 0, sizeof(TItem), &result);
+        CHECK(status);
+        results.push_back(result);
+    }
+
+    ValidateResults(kernelName, &results[0], static_cast<int64_t>(results.size()), [&](int64_t i) -> double {
+            return _reference[i];
+        });
+}
+
+void Reduction::Cleanup() {
+    _inputBuffer.reset();
+    _partialsBuffer.reset();
+    _program.reset();
+    _sizes.clear();
+    _copyBandwidth.clear();
+    _reference.clear();
+}
+
+void Reduction::Run() {
+    cout << "Reduction:" << endl;
+
+    _workGroupFunctions = _controller->SupportsOpenCLC20();
+    _subGroupFunctions = _controller->HasExtension("cl_intel_subgroups")
+        || (_workGroupFunctions && _controller->HasExtension("cl_khr_subgroups"));
+
+    vector<string> kernels { "ReduceLocal" };
+    if (_workGroupFunctions)
+        kernels.push_back("ReduceWorkGroup");
+    if (_subGroupFunctions)
+        kernels.push_back("ReduceSubGroup");
+
+    cout << "Reduction<int>" << endl;
+    if (InitContext<cl_int>() == 0) {
+        for (auto& kernel : kernels)
+            RunInternal<cl_int>(kernel);
+    }
+    Cleanup();
+
+    cout << "Reduction<long>" << endl;
+    if (InitContext<cl_long>() == 0) {
+        for (auto& kernel : kernels)
+            RunInternal<cl_long>(kernel);
+    }
+    Cleanup();
+
+    cout << "Reduction<float>" << endl;
+    if (InitContext<float>() == 0) {
+        for (auto& kernel : kernels)
+            RunInternal<float>(kernel);
+    }
+    Cleanup();
+
+    if (_controller->SupportsDoublePrecision()) {
+        cout << "Reduction<double>" << endl;
+        if (InitContext<double>() == 0) {
+            for (auto& kernel : kernels)
+                RunInternal<double>(kernel);
+        }
+        Cleanup();
+    }
+
+    cout << endl;
+}
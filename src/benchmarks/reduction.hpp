@@ -0,0 +1,67 @@
+#ifndef __BENCH_BENCHMARKS_REDUCTION_HPP
+#define __BENCH_BENCHMARKS_REDUCTION_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Parallel sum reduction of 2^16 up to 2^28 elements. Compares a tree reduction in local memory
+ * with the OpenCL 2.0 work-group built-in (work_group_reduce_add) and sub-group reductions
+ * (cl_khr_subgroups or cl_intel_subgroups) if the device supports them. The bandwidth is reported
+ * relative to a device to device copy, the memory roof of the reduction.
+ */
+class Reduction : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _inputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _partialsBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    std::vector<int> _sizes;                // number of elements of every test size
+    std::vector<double> _copyBandwidth;     // memory roof per test size in GB/s
+    std::vector<double> _reference;         // exact sum of the first _sizes[i] elements
+
+    int _maxWorkGroups = 0;
+    bool _workGroupFunctions = false;
+    bool _subGroupFunctions = false;
+
+    /**
+     * Compiles the kernels, selects the test sizes which fit onto the device, uploads the input
+     * and computes the reference sums.
+     */
+    template <typename TItem>
+    int InitContext();
+
+    /**
+     * Executes the reduction kernel for all test sizes, the partial sums are reduced by a second
+     * launch with a single work-group.
+     *
+     * @param kernelName ReduceLocal, ReduceWorkGroup or ReduceSubGroup
+     */
+    template <typename TItem>
+    void RunInternal(const std::string& kernelName);
+
+    /**
+     * Release all buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Reduction(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Reduction();
+
+    /**
+     * Execute the reductions for int, long, float and double (if supported).
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_REDUCTION_HPP
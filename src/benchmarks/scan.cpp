@@ -0,0 +1,306 @@
+#include "scan.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int ITEMS_PER_WORK_ITEM = 8;
+static const int TILE_SIZE = WORK_GROUP_SIZE * ITEMS_PER_WORK_ITEM;
+static const int MIN_SIZE_BITS = 16;
+static const int MAX_SIZE_BITS = 28;
+static const int SIZE_STEP_BITS = 4;
+static const int ITERATIONS = 20;
+static const int SEGMENT_LENGTH = 1000;             // average distance between two segment heads
+static const int64_t CHECKPOINT_DISTANCE = 256;
+
+// small integers: all prefix sums are exact in double and stay below 2^31 for 2^28 elements
+static int InputValue(int64_t i) {
+    return static_cast<int>(((static_cast<uint32_t>(i) * 2654435761u) >> 28) & 3);
+}
+
+static bool IsSegmentHead(int64_t i) {
+    return i == 0 || ((static_cast<uint32_t>(i) * 2246822519u) >> 8) % SEGMENT_LENGTH == 0;
+}
+
+Scan::Scan(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _sizes()
+    , _copyBandwidth()
+    , _checkpoints()
+    , _segmentedCheckpoints() {
+
+}
+
+Scan::~Scan() {
+
+}
+
+template <typename TItem>
+int Scan::InitContext() {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+    compilerParams += " -DITEMS_PER_WORK_ITEM=" + to_string(ITEMS_PER_WORK_ITEM);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "scan.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    cl_ulong maxAllocationSize = 0;
+    cl_ulong globalMemorySize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_GLOBAL_MEM_SIZE, &globalMemorySize);
+
+    // input, output and heads have to fit into three quarters of the device memory
+    _sizes.clear();
+    _copyBandwidth.clear();
+    for (int bits = MIN_SIZE_BITS; bits <= MAX_SIZE_BITS; bits += SIZE_STEP_BITS) {
+        const size_t length = static_cast<size_t>(1) << bits;
+        const size_t bytes = length * sizeof(TItem);
+        if (bytes > maxAllocationSize || 4 * (2 * bytes + length) > 3 * globalMemorySize)
+            break;
+
+        _sizes.push_back(static_cast<int>(length));
+        _copyBandwidth.push_back(DeviceCopyBandwidth(bytes));
+    }
+
+    if (_sizes.empty())
+        return -1;
+
+    const int length = _sizes.back();
+    const int tileCount = (length + TILE_SIZE - 1) / TILE_SIZE;
+
+    vector<TItem> input(length);
+    vector<cl_uchar> heads(length);
+    ParallelFor(length, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t i = begin; i < end; ++i) {
+                input[i] = static_cast<TItem>(InputValue(i));
+                heads[i] = IsSegmentHead(i) ? 1 : 0;
+            }
+        });
+
+    cl_int status = CL_SUCCESS;
+    const cl::Context& context = _controller->Context();
+    _inputBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, length * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _outputBuffer = make_shared<cl::Buffer>(context, CL_MEM_WRITE_ONLY, length * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _headsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, length * sizeof(cl_uchar), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _tileSumsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, tileCount * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _tileFlagsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, tileCount * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _tileCounterBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _aggregatesBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, tileCount * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _prefixesBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, tileCount * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    status = queue.enqueueWriteBuffer(*_inputBuffer, CL_TRUE, 0, length * sizeof(TItem), &input[0]);
+    CHECK_RETURN_ERROR(status);
+    status = queue.enqueueWriteBuffer(*_headsBuffer, CL_TRUE, 0, length * sizeof(cl_uchar), &heads[0]);
+    CHECK_RETURN_ERROR(status);
+
+    if (!ValidationEnabled())
+        return 0;
+
+    _checkpoints.clear();
+    _segmentedCheckpoints.clear();
+    double sum = 0.0, segmentedSum = 0.0;
+    for (int64_t i = 0; i < length; ++i) {
+        if (i % CHECKPOINT_DISTANCE == 0) {
+            _checkpoints.push_back(sum);
+            _segmentedCheckpoints.push_back(segmentedSum);
+        }
+
+        sum += InputValue(i);
+        segmentedSum = IsSegmentHead(i) ? InputValue(i) : segmentedSum + InputValue(i);
+    }
+
+    return 0;
+}
+
+double Scan::ReferenceValue(int64_t i, bool segmented) {
+    double value = segmented ? _segmentedCheckpoints[i / CHECKPOINT_DISTANCE] : _checkpoints[i / CHECKPOINT_DISTANCE];
+
+    for (int64_t j = i - i % CHECKPOINT_DISTANCE; j <= i; ++j)
+        value = segmented && IsSegmentHead(j) ? InputValue(j) : value + InputValue(j);
+
+    return value;
+}
+
+template <typename TItem>
+void Scan::RunInternal(const string& algorithm) {
+    cl_int status = CL_SUCCESS;
+    const bool segmented = algorithm == "Segmented";
+    const string prefix = segmented ? "SegmentedScan" : "Scan";
+
+    // the single-pass scan consists of one kernel, the others of three passes
+    cl::Kernel reduceKernel, tileSumsKernel, scanKernel;
+    if (algorithm == "SinglePass") {
+        scanKernel = cl::Kernel(*_program, "ScanSinglePass", &status);
+        CHECK(status);
+    } else {
+        reduceKernel = cl::Kernel(*_program, (prefix + "ReduceTiles").c_str(), &status);
+        CHECK(status);
+        tileSumsKernel = cl::Kernel(*_program, (prefix + "TileSums").c_str(), &status);
+        CHECK(status);
+        scanKernel = cl::Kernel(*_program, (prefix + "Tiles").c_str(), &status);
+        CHECK(status);
+    }
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    for (size_t s = 0; s < _sizes.size(); ++s) {
+        const int length = _sizes[s];
+        const int tileCount = (length + TILE_SIZE - 1) / TILE_SIZE;
+        cl::NDRange global(tileCount * WORK_GROUP_SIZE);
+
+        if (algorithm == "SinglePass") {
+            scanKernel.setArg(0, *_inputBuffer);
+            scanKernel.setArg(1, *_outputBuffer);
+            scanKernel.setArg(2, *_tileCounterBuffer);
+            scanKernel.setArg(3, *_tileFlagsBuffer);
+            scanKernel.setArg(4, *_aggregatesBuffer);
+            scanKernel.setArg(5, *_prefixesBuffer);
+            scanKernel.setArg(6, length);
+        } else if (segmented) {
+            reduceKernel.setArg(0, *_inputBuffer);
+            reduceKernel.setArg(1, *_headsBuffer);
+            reduceKernel.setArg(2, *_tileSumsBuffer);
+            reduceKernel.setArg(3, *_tileFlagsBuffer);
+            reduceKernel.setArg(4, length);
+            tileSumsKernel.setArg(0, *_tileSumsBuffer);
+            tileSumsKernel.setArg(1, *_tileFlagsBuffer);
+            tileSumsKernel.setArg(2, tileCount);
+            scanKernel.setArg(0, *_inputBuffer);
+            scanKernel.setArg(1, *_headsBuffer);
+            scanKernel.setArg(2, *_outputBuffer);
+            scanKernel.setArg(3, *_tileSumsBuffer);
+            scanKernel.setArg(4, length);
+        } else {
+            reduceKernel.setArg(0, *_inputBuffer);
+            reduceKernel.setArg(1, *_tileSumsBuffer);
+            reduceKernel.setArg(2, length);
+            tileSumsKernel.setArg(0, *_tileSumsBuffer);
+            tileSumsKernel.setArg(1, tileCount);
+            scanKernel.setArg(0, *_inputBuffer);
+            scanKernel.setArg(1, *_outputBuffer);
+            scanKernel.setArg(2, *_tileSumsBuffer);
+            scanKernel.setArg(3, length);
+        }
+
+        // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                if (algorithm == "SinglePass") {
+                    // the look-back flags and the tile counter have to be reset, this is not part of the measurement
+                    status = queue.enqueueFillBuffer(*_tileFlagsBuffer, static_cast<cl_int>(0), 0, tileCount * sizeof(cl_int));
+                    status |= queue.enqueueFillBuffer(*_tileCounterBuffer, static_cast<cl_int>(0), 0, sizeof(cl_int));
+
+                    events.resize(1);
+                    if (status == CL_SUCCESS)
+                        status = queue.enqueueNDRangeKernel(scanKernel, cl::NullRange, global, local, nullptr, &events[0]);
+                } else {
+                    events.resize(3);
+                    status = queue.enqueueNDRangeKernel(reduceKernel, cl::NullRange, global, local, nullptr, &events[0]);
+                    if (status == CL_SUCCESS)
+                        status = queue.enqueueNDRangeKernel(tileSumsKernel, cl::NullRange, local, local, nullptr, &events[1]);
+                    if (status == CL_SUCCESS)
+                        status = queue.enqueueNDRangeKernel(scanKernel, cl::NullRange, global, local, nullptr, &events[2]);
+                }
+                if (status != CL_SUCCESS)
+                    events.clear();
+            }, "  Scan" + algorithm + ", " + to_string(length) + " elements,", ITERATIONS);
+        CHECK(status);
+
+        // minimum traffic: read the input (and the heads), write the output
+        const double bytes = 2.0 * length * sizeof(TItem) + (segmented ? length * sizeof(cl_uchar) : 0);
+        const int64_t timeGPU = _gpuStatistics.Mean();
+        const double bandwidth = timeGPU > 0 ? bytes / timeGPU : 0.0;
+        cout << "  Scan" << algorithm << ", " << length << " elements: " << bandwidth << " GB/s";
+        if (_copyBandwidth[s] > 0.0)
+            cout << " (" << 100.0 * bandwidth / _copyBandwidth[s] << "% of copy bandwidth, " << _copyBandwidth[s] << " GB/s)";
+        cout << endl;
+
+        if (!ValidationEnabled())
+            continue;
+
+        vector<TItem> results(length);
+        status = queue.enqueueReadBuffer(*_outputBuffer, CL_TRUE, 0, length * sizeof(TItem), &results[0]);
+        CHECK(status);
+
+        // the floating point scans add up the tiles in a different order than the host (the integer scans
+        // are exact), the longest addition chain runs through the items of a work-item, the work-group
+        // and the carries of all preceding tiles
+        const int64_t operations = static_cast<int64_t>(tileCount) + ITEMS_PER_WORK_ITEM + WORK_GROUP_SIZE;
+        ValidateResults("Scan" + algorithm + ", " + to_string(length) + " elements", &results[0], length,
+            [&](int64_t i) -> double {
+                return ReferenceValue(i, segmented);
+            }, AccumulatedTolerance<TItem>(operations));
+    }
+}
+
+void Scan::Cleanup() {
+    _inputBuffer.reset();
+    _outputBuffer.reset();
+    _headsBuffer.reset();
+    _tileSumsBuffer.reset();
+    _tileFlagsBuffer.reset();
+    _tileCounterBuffer.reset();
+    _aggregatesBuffer.reset();
+    _prefixesBuffer.reset();
+    _program.reset();
+    _sizes.clear();
+    _copyBandwidth.clear();
+    _checkpoints.clear();
+    _segmentedCheckpoints.clear();
+}
+
+void Scan::Run() {
+    cout << "Scan:" << endl;
+
+    const string algorithms[] = { "TwoPass", "SinglePass", "Segmented" };
+
+    cout << "Scan<int>" << endl;
+    if (InitContext<cl_int>() == 0) {
+        for (auto& algorithm : algorithms)
+            RunInternal<cl_int>(algorithm);
+    }
+    Cleanup();
+
+    cout << "Scan<long>" << endl;
+    if (InitContext<cl_long>() == 0) {
+        for (auto& algorithm : algorithms)
+            RunInternal<cl_long>(algorithm);
+    }
+    Cleanup();
+
+    cout << "Scan<float>" << endl;
+    if (InitContext<float>() == 0) {
+        for (auto& algorithm : algorithms)
+            RunInternal<float>(algorithm);
+    }
+    Cleanup();
+
+    if (_controller->SupportsDoublePrecision()) {
+        cout << "Scan<double>" << endl;
+        if (InitContext<double>() == 0) {
+            for (auto& algorithm : algorithms)
+                RunInternal<double>(algorithm);
+        }
+        Cleanup();
+    }
+
+    cout << endl;
+}
@@ -0,0 +1,76 @@
+#ifndef __BENCH_BENCHMARKS_SCAN_HPP
+#define __BENCH_BENCHMARKS_SCAN_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Inclusive prefix sums of 2^16 up to 2^28 elements: a two-pass scan (reduce-then-scan), a single-pass
+ * scan with decoupled look-back and a segmented scan. The bandwidth is reported relative to a device
+ * to device copy, the memory roof of a scan.
+ */
+class Scan : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _inputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _outputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _headsBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _tileSumsBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _tileFlagsBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _tileCounterBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _aggregatesBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _prefixesBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    std::vector<int> _sizes;                    // number of elements of every test size
+    std::vector<double> _copyBandwidth;         // memory roof per test size in GB/s
+
+    // inclusive scan results just before every CHECKPOINT_DISTANCE-th element, the reference of
+    // any element is computed from the nearest checkpoint
+    std::vector<double> _checkpoints;
+    std::vector<double> _segmentedCheckpoints;
+
+    /**
+     * Compiles the kernels, selects the test sizes which fit onto the device, uploads the input
+     * and the segment heads and computes the checkpoints of the reference.
+     */
+    template <typename TItem>
+    int InitContext();
+
+    /**
+     * @return expected result of element i
+     */
+    double ReferenceValue(int64_t i, bool segmented);
+
+    /**
+     * Executes one scan algorithm for all test sizes and validates the results.
+     *
+     * @param algorithm TwoPass, SinglePass or Segmented
+     */
+    template <typename TItem>
+    void RunInternal(const std::string& algorithm);
+
+    /**
+     * Release all buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Scan(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Scan();
+
+    /**
+     * Execute the scans for int, long, float and double (if supported).
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_SCAN_HPP
@@ -0,0 +1,335 @@
+#include "sort.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const int WORK_GROUP_SIZE = 256;
+static const int ITEMS_PER_WORK_ITEM = 4;
+static const int TILE_SIZE = WORK_GROUP_SIZE * ITEMS_PER_WORK_ITEM;
+static const int BITONIC_TILE = 2 * WORK_GROUP_SIZE;
+static const int RADIX_BITS = 4;
+static const int RADIX = 1 << RADIX_BITS;
+static const int MIN_SIZE_BITS = 16;
+static const int MAX_SIZE_BITS = 24;
+static const int SIZE_STEP_BITS = 2;
+static const int ITERATIONS = 10;
+static const int RANDOM_SEED = 85733;
+
+// keys per nanosecond to million keys per second
+static double KeysPerSecond(int length, int64_t time) {
+    return time > 0 ? 1000.0 * length / time : 0.0;
+}
+
+Sort::Sort(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller) {
+
+}
+
+Sort::~Sort() {
+
+}
+
+template <typename TKey>
+int Sort::InitContext() {
+    // there is no VTYPE for unsigned keys, GetCompilerFlags only adds the optimization flags
+    string compilerParams = GetCompilerFlags<TKey>();
+    compilerParams += " -DKEY_BITS=" + to_string(8 * sizeof(TKey));
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+    compilerParams += " -DITEMS_PER_WORK_ITEM=" + to_string(ITEMS_PER_WORK_ITEM);
+    compilerParams += " -DRADIX_BITS=" + to_string(RADIX_BITS);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "sort.cl", compilerParams);
+    _keyValueProgram = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "sort.cl", compilerParams + " -DKEY_VALUE");
+
+    if (_program.get() == nullptr || _keyValueProgram.get() == nullptr)
+        return -1;
+
+    return 0;
+}
+
+template <typename TKey>
+int Sort::InitBuffers(const vector<TKey>& keys) {
+    const int length = static_cast<int>(keys.size());
+    const int tileCount = (length + TILE_SIZE - 1) / TILE_SIZE;
+
+    vector<cl_uint> values(length);
+    for (int i = 0; i < length; ++i)
+        values[i] = i;
+
+    cl_int status = CL_SUCCESS;
+    const cl::Context& context = _controller->Context();
+    _inputKeysBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, length * sizeof(TKey), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _inputValuesBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, length * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _keysBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, length * sizeof(TKey), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _valuesBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, length * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _keysTemporaryBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, length * sizeof(TKey), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _valuesTemporaryBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, length * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _countsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, RADIX * tileCount * sizeof(cl_uint), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    status = queue.enqueueWriteBuffer(*_inputKeysBuffer, CL_TRUE, 0, length * sizeof(TKey), &keys[0]);
+    CHECK_RETURN_ERROR(status);
+    status = queue.enqueueWriteBuffer(*_inputValuesBuffer, CL_TRUE, 0, length * sizeof(cl_uint), &values[0]);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+template <typename TKey>
+void Sort::ParallelSort(vector<TKey>& keys) {
+    const int64_t length = static_cast<int64_t>(keys.size());
+    const int64_t chunks = max(1u, thread::hardware_concurrency());
+    const int64_t chunkSize = (length + chunks - 1) / chunks;
+
+    ParallelFor(chunks, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t c = begin; c < end; ++c)
+                sort(keys.begin() + min(c * chunkSize, length), keys.begin() + min((c + 1) * chunkSize, length));
+        });
+
+    for (int64_t width = chunkSize; width < length; width *= 2) {
+        const int64_t merges = (length + 2 * width - 1) / (2 * width);
+        ParallelFor(merges, [&](int64_t begin, int64_t end) -> void {
+                for (int64_t m = begin; m < end; ++m) {
+                    const int64_t first = m * 2 * width;
+                    inplace_merge(keys.begin() + first, keys.begin() + min(first + width, length),
+                        keys.begin() + min(first + 2 * width, length));
+                }
+            });
+    }
+}
+
+template <typename TKey>
+void Sort::RadixSort(int length, bool keyValue, const vector<TKey>& keys, const vector<TKey>& sortedKeys) {
+    cl_int status = CL_SUCCESS;
+    cl::Program& program = keyValue ? *_keyValueProgram : *_program;
+    cl::Kernel histogramKernel(program, "RadixHistogram", &status);
+    CHECK(status);
+    cl::Kernel scanKernel(program, "RadixScan", &status);
+    CHECK(status);
+    cl::Kernel scatterKernel(program, "RadixScatter", &status);
+    CHECK(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    const int tileCount = (length + TILE_SIZE - 1) / TILE_SIZE;
+    const int passes = 8 * sizeof(TKey) / RADIX_BITS;   // even, the result ends up in _keysBuffer
+    cl::NDRange global(tileCount * WORK_GROUP_SIZE);
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    histogramKernel.setArg(1, *_countsBuffer);
+    histogramKernel.setArg(2, length);
+    scanKernel.setArg(0, *_countsBuffer);
+    scanKernel.setArg(1, RADIX * tileCount);
+    scatterKernel.setArg(4, *_countsBuffer);
+    scatterKernel.setArg(5, length);
+
+    const string testName = string(keyValue ? "RadixSort, key-value" : "RadixSort, keys") + ", " + to_string(length) + " keys";
+    // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            // restoring the unsorted input is not part of the measurement
+            status = queue.enqueueCopyBuffer(*_inputKeysBuffer, *_keysBuffer, 0, 0, length * sizeof(TKey));
+            if (keyValue)
+                status |= queue.enqueueCopyBuffer(*_inputValuesBuffer, *_valuesBuffer, 0, 0, length * sizeof(cl_uint));
+
+            events.resize(3 * passes);
+            for (int pass = 0; pass < passes && status == CL_SUCCESS; ++pass) {
+                cl::Buffer& keysIn = pass % 2 == 0 ? *_keysBuffer : *_keysTemporaryBuffer;
+                cl::Buffer& keysOut = pass % 2 == 0 ? *_keysTemporaryBuffer : *_keysBuffer;
+                cl::Buffer& valuesIn = pass % 2 == 0 ? *_valuesBuffer : *_valuesTemporaryBuffer;
+                cl::Buffer& valuesOut = pass % 2 == 0 ? *_valuesTemporaryBuffer : *_valuesBuffer;
+                const int shift = pass * RADIX_BITS;
+
+                histogramKernel.setArg(0, keysIn);
+                histogramKernel.setArg(3, shift);
+                scatterKernel.setArg(0, keysIn);
+                scatterKernel.setArg(1, valuesIn);
+                scatterKernel.setArg(2, keysOut);
+                scatterKernel.setArg(3, valuesOut);
+                scatterKernel.setArg(6, shift);
+
+                status = queue.enqueueNDRangeKernel(histogramKernel, cl::NullRange, global, local, nullptr, &events[3 * pass]);
+                if (status == CL_SUCCESS)
+                    status = queue.enqueueNDRangeKernel(scanKernel, cl::NullRange, local, local, nullptr, &events[3 * pass + 1]);
+                if (status == CL_SUCCESS)
+                    status = queue.enqueueNDRangeKernel(scatterKernel, cl::NullRange, global, local, nullptr, &events[3 * pass + 2]);
+            }
+            if (status != CL_SUCCESS)
+                events.clear();
+        }, "  " + testName + ",", ITERATIONS);
+    CHECK(status);
+
+    cout << "  " << testName << ": " << KeysPerSecond(length, _gpuStatistics.Mean()) << " Mkeys/s" << endl;
+
+    if (!ValidationEnabled())
+        return;
+
+    vector<TKey> results(length);
+    status = queue.enqueueReadBuffer(*_keysBuffer, CL_TRUE, 0, length * sizeof(TKey), &results[0]);
+    CHECK(status);
+    ValidateResults(testName, &results[0], length, [&](int64_t i) -> TKey {
+            return sortedKeys[i];
+        });
+
+    if (!keyValue)
+        return;
+
+    // every value has to point to its key and equal keys have to keep their original order
+    vector<cl_uint> values(length);
+    status = queue.enqueueReadBuffer(*_valuesBuffer, CL_TRUE, 0, length * sizeof(cl_uint), &values[0]);
+    CHECK(status);
+    Validate(testName + ", values", length, [&](int64_t i) -> bool {
+            return values[i] < static_cast<cl_uint>(length) && keys[values[i]] == sortedKeys[i]
+                && (i == 0 || sortedKeys[i - 1] != sortedKeys[i] || values[i - 1] < values[i]);
+        });
+}
+
+template <typename TKey>
+void Sort::BitonicSort(int length, const vector<TKey>& sortedKeys) {
+    cl_int status = CL_SUCCESS;
+    cl::Kernel globalKernel(*_program, "BitonicGlobal", &status);
+    CHECK(status);
+    cl::Kernel localKernel(*_program, "BitonicLocal", &status);
+    CHECK(status);
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl::NDRange globalPairs(length / 2);
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    globalKernel.setArg(0, *_keysBuffer);
+    localKernel.setArg(0, *_keysBuffer);
+
+    const string testName = "BitonicSort, keys, " + to_string(length) + " keys";
+    // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            status = queue.enqueueCopyBuffer(*_inputKeysBuffer, *_keysBuffer, 0, 0, length * sizeof(TKey));
+
+            // all stages up to the tile size are sorted in local memory
+            if (status == CL_SUCCESS) {
+                events.push_back(cl::Event());
+                localKernel.setArg(1, 2);
+                localKernel.setArg(2, min(BITONIC_TILE, length));
+                localKernel.setArg(3, 1);
+                status = queue.enqueueNDRangeKernel(localKernel, cl::NullRange, globalPairs, local, nullptr, &events.back());
+            }
+
+            // the larger stages need global steps until the compared elements are in the same tile
+            for (int k = 2 * BITONIC_TILE; k <= length && status == CL_SUCCESS; k <<= 1) {
+                for (int j = k / 2; j >= BITONIC_TILE && status == CL_SUCCESS; j >>= 1) {
+                    events.push_back(cl::Event());
+                    globalKernel.setArg(1, j);
+                    globalKernel.setArg(2, k);
+                    status = queue.enqueueNDRangeKernel(globalKernel, cl::NullRange, globalPairs, local, nullptr, &events.back());
+                }
+                if (status != CL_SUCCESS)
+                    break;
+
+                events.push_back(cl::Event());
+                localKernel.setArg(1, k);
+                localKernel.setArg(2, k);
+                localKernel.setArg(3, BITONIC_TILE / 2);
+                status = queue.enqueueNDRangeKernel(localKernel, cl::NullRange, globalPairs, local, nullptr, &events.back());
+            }
+            if (status != CL_SUCCESS)
+                events.clear();
+        }, "  " + testName + ",", ITERATIONS);
+    CHECK(status);
+
+    cout << "  " << testName << ": " << KeysPerSecond(length, _gpuStatistics.Mean()) << " Mkeys/s" << endl;
+
+    if (!ValidationEnabled())
+        return;
+
+    vector<TKey> results(length);
+    status = queue.enqueueReadBuffer(*_keysBuffer, CL_TRUE, 0, length * sizeof(TKey), &results[0]);
+    CHECK(status);
+    ValidateResults(testName, &results[0], length, [&](int64_t i) -> TKey {
+            return sortedKeys[i];
+        });
+}
+
+template <typename TKey>
+void Sort::RunInternal(int length) {
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    if (length * sizeof(TKey) > maxAllocationSize)
+        return;
+
+    mt19937_64 randomEngine(RANDOM_SEED);
+    uniform_int_distribution<TKey> keyDistribution;
+    vector<TKey> keys(length);
+    for (auto& key : keys)
+        key = keyDistribution(randomEngine);
+
+    // host baselines, the result of std::sort is the reference
+    vector<TKey> sortedKeys(keys);
+    _timer.Remember();
+    sort(sortedKeys.begin(), sortedKeys.end());
+    const int64_t timeSort = _timer.Diff();
+
+    vector<TKey> parallelSortedKeys(keys);
+    _timer.Remember();
+    ParallelSort(parallelSortedKeys);
+    const int64_t timeParallelSort = _timer.Diff();
+
+    cout << "  std::sort, " << length << " keys: " << KeysPerSecond(length, timeSort) << " Mkeys/s" << endl;
+    cout << "  parallel sort (" << max(1u, thread::hardware_concurrency()) << " threads), " << length << " keys: "
+        << KeysPerSecond(length, timeParallelSort) << " Mkeys/s" << endl;
+
+    if (InitBuffers(keys) == 0) {
+        RadixSort(length, false, keys, sortedKeys);
+        RadixSort(length, true, keys, sortedKeys);
+        BitonicSort(length, sortedKeys);
+    }
+    CleanupBuffers();
+}
+
+void Sort::CleanupBuffers() {
+    _inputKeysBuffer.reset();
+    _inputValuesBuffer.reset();
+    _keysBuffer.reset();
+    _valuesBuffer.reset();
+    _keysTemporaryBuffer.reset();
+    _valuesTemporaryBuffer.reset();
+    _countsBuffer.reset();
+}
+
+void Sort::Cleanup() {
+    CleanupBuffers();
+    _program.reset();
+    _keyValueProgram.reset();
+}
+
+void Sort::Run() {
+    cout << "Sort:" << endl;
+
+    cout << "Sort<uint>" << endl;
+    if (InitContext<cl_uint>() == 0) {
+        for (int bits = MIN_SIZE_BITS; bits <= MAX_SIZE_BITS; bits += SIZE_STEP_BITS)
+            RunInternal<cl_uint>(1 << bits);
+    }
+    Cleanup();
+
+    cout << "Sort<ulong>" << endl;
+    if (InitContext<cl_ulong>() == 0) {
+        for (int bits = MIN_SIZE_BITS; bits <= MAX_SIZE_BITS; bits += SIZE_STEP_BITS)
+            RunInternal<cl_ulong>(1 << bits);
+    }
+    Cleanup();
+
+    cout << endl;
+}
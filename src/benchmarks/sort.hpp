@@ -0,0 +1,87 @@
+#ifndef __BENCH_BENCHMARKS_SORT_HPP
+#define __BENCH_BENCHMARKS_SORT_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace benchmarks {
+
+/**
+ * Sorting of 32 and 64 bit keys: a LSD radix sort (keys only and key-value pairs) and a bitonic sort
+ * on the device, std::sort and a parallel merge sort on the host as baseline. The throughput is
+ * reported in keys per second for 2^16 up to 2^24 keys.
+ */
+class Sort : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _inputKeysBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _inputValuesBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _keysBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _valuesBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _keysTemporaryBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _valuesTemporaryBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _countsBuffer = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+    std::shared_ptr<cl::Program> _keyValueProgram = nullptr;
+
+    /**
+     * Compiles the kernels for keys of type TKey (cl_uint or cl_ulong).
+     */
+    template <typename TKey>
+    int InitContext();
+
+    /**
+     * Generates random keys, sorts them on the host and executes the device sorts.
+     */
+    template <typename TKey>
+    void RunInternal(int length);
+
+    /**
+     * Allocates the device buffers and uploads the keys and their indices as values.
+     */
+    template <typename TKey>
+    int InitBuffers(const std::vector<TKey>& keys);
+
+    /**
+     * Radix sort with RADIX_BITS per pass, the values are the original indices of the keys.
+     * A stable sort has to keep the indices of equal keys in ascending order.
+     */
+    template <typename TKey>
+    void RadixSort(int length, bool keyValue, const std::vector<TKey>& keys, const std::vector<TKey>& sortedKeys);
+
+    template <typename TKey>
+    void BitonicSort(int length, const std::vector<TKey>& sortedKeys);
+
+    /**
+     * Sorts one chunk per hardware thread with std::sort and merges the chunks pairwise in parallel.
+     */
+    template <typename TKey>
+    static void ParallelSort(std::vector<TKey>& keys);
+
+    /**
+     * Release all buffers.
+     */
+    void CleanupBuffers();
+
+    /**
+     * Release all buffers and the program instances.
+     */
+    void Cleanup();
+
+public:
+    explicit Sort(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Sort();
+
+    /**
+     * Execute the sorts for 32 and 64 bit keys.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_SORT_HPP
@@ -16,7 +16,8 @@ static const int SPMV_DIMENSION = 4096; //1024, 8192, 12288, 16384
 static const int TEST_ITERATIONS = 100;
 
 Spmv::Spmv(std::shared_ptr<ComputeController> controller)
-    : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _reference() {
 
 }
 
@@ -164,6 +165,20 @@ int Spmv::InitContext() {
     inputVector.resize(_numberOfRows);
     InitVector(&inputVector[0], _numberOfRows);
 
+    // host reference of the product
+    _reference.clear();
+    if (ValidationEnabled()) {
+        _reference.resize(_numberOfRows);
+        ParallelFor(_numberOfRows, [&](int64_t begin, int64_t end) -> void {
+                for (int64_t row = begin; row < end; ++row) {
+                    double sum = 0.0;
+                    for (int i = rowDelimiters[row]; i < rowDelimiters[row + 1]; ++i)
+                        sum += static_cast<double>(valuesRMU[i]) * inputVector[columnIdsRMU[i]];
+                    _reference[row] = sum;
+                }
+            });
+    }
+
     // create buffers
     _inputValueBufferCMP = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, _maxRowLength * _numberOfRows * sizeof(TItem));
     _inputValueBufferRMP = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, _maxRowLength * _numberOfRows * sizeof(TItem));
@@ -236,13 +251,8 @@ void Spmv::RunInternal() {
     queue.enqueueReadBuffer(*_outputVectorBuffer, CL_TRUE, 0, _numberOfRows * sizeof(TItem), &resultRM[0]);
     queue.finish();
 
-    for (int i = 0; i < _numberOfRows; ++i) {
-        if (resultCM[i] != resultRM[i]) {
-            cout << resultCM[i] << " " << resultRM[i] << endl;
-            cerr << "Results are not equal." << endl;
-            return;
-        }
-    }
+    ValidateResults("Column Major", &resultCM[0], _numberOfRows, [&](int64_t i) -> double { return _reference[i]; });
+    ValidateResults("Row Major", &resultRM[0], _numberOfRows, [&](int64_t i) -> double { return _reference[i]; });
 }
 
 void Spmv::Cleanup() {
@@ -253,6 +263,7 @@ void Spmv::Cleanup() {
     _inputRowLengthsBuffer.reset();
     _inputVectorBuffer.reset();
     _outputVectorBuffer.reset();
+    _reference.clear();
 
     _ellpackKernel.reset(),
     _ellpackRowKernel.reset();
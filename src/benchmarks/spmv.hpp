@@ -25,6 +25,8 @@ private:
     std::shared_ptr<cl::Kernel> _ellpackRowKernel = nullptr;
     std::shared_ptr<cl::Program> _program = nullptr;
 
+    std::vector<double> _reference;
+
     int _maxRowLength = -1;
     int _numberOfRows = -1;
 
@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <random>
+#include <utility>
 
 #include "../clglobal.hpp"
 #include "../computecontroller.hpp"
@@ -18,6 +19,21 @@ static const float WEIGHT_CENTER = 0.25f;
 static const float WEIGHT_DIAGONAL = 0.05f;
 static const int LOCAL_ROWS = 8;
 static const int LOCAL_COLUMNS = 256;
+static const int TEMPORAL_TILE = 32;
+static const int TEMPORAL_WORK_GROUP_EDGE = 16;
+static const int TEMPORAL_STEPS[] = { 2, 4, 5, 8 };    // must divide ALGORITHM_ITERATIONS
+static const int ITERATIONS_3D = 20;
+static const int BLOCK_X_3D = 32;
+static const int BLOCK_Y_3D = 8;
+static const int GRID_SIZES_3D[][3] = { { 64, 64, 64 }, { 256, 256, 256 }, { 320, 240, 200 }, { 1001, 97, 53 } };
+static const float WEIGHT_CENTER_7 = 0.4f;
+static const float WEIGHT_NEIGHBOR_7 = 0.1f;
+static const float WEIGHT_CENTER_27 = 0.2f;
+static const float WEIGHT_FACE_27 = 0.05f;
+static const float WEIGHT_EDGE_27 = 0.025f;
+static const float WEIGHT_CORNER_27 = 0.0125f;
+static const int VALIDATION_STEPS = 40;                // sampled validation, must be a multiple of all TEMPORAL_STEPS
+static const int STEP_OPERATIONS = 11;                  // floating point operations per cell and time step
 
 Stencil::Stencil(std::shared_ptr<ComputeController> controller) : BenchmarkBase(controller) {
 
@@ -73,18 +89,15 @@ int Stencil::InitContext() {
 }
 
 template <typename TItem>
-void Stencil::RunInternal() {
-    if (InitContext<TItem>() != 0)
-        return;
-
+int64_t Stencil::RunBaseline(int64_t& timeCPU, const vector<TItem>& reference) {
     cl::CommandQueue& queue = _controller->Queue();
 
     cl_int alignment = 16;
     TItem center = WEIGHT_CENTER, cardinal = WEIGHT_CARDINAL, diagonal = WEIGHT_DIAGONAL;
 
     cl::NDRange localWorkSize(1, LOCAL_COLUMNS);    // 1 means the kernel handles eight rows (LOCAL_ROWS compiler flag)
-    cl::NDRange globalWorkSize((MATRIX_HEIGHT - 2) / LOCAL_ROWS,
-        RoundToPowerOf2(MATRIX_WIDTH - 2, LOCAL_COLUMNS));
+    cl::NDRange globalWorkSize(RoundToMultipleOf(MATRIX_HEIGHT - 2, LOCAL_ROWS) / LOCAL_ROWS,
+        RoundToMultipleOf(MATRIX_WIDTH - 2, LOCAL_COLUMNS));
     cl_long startTime, endTime;
     cl::Event event;
 
@@ -97,16 +110,25 @@ void Stencil::RunInternal() {
     _stencilKernel->setArg(4, cardinal);
     _stencilKernel->setArg(5, diagonal);
 
-    for (int i = 0; i < TEST_ITERATIONS; ++i) {
+    // an additional untimed pass computes the time steps of a shorter validation, see ValidationSteps()
+    const int passes = TEST_ITERATIONS + (ValidationSteps() != ALGORITHM_ITERATIONS ? 1 : 0);
+    for (int i = 0; i < passes; ++i) {
+        const bool timed = i < TEST_ITERATIONS;
+        const int steps = timed ? ALGORITHM_ITERATIONS : ValidationSteps();
 
         auto currentBuffer = _inputBuffer;
         auto otherBuffer = _outputBuffer;
 
-        // initialize/restore original input buffer
-        cl_int status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem), nullptr, &event);
-        WAIT_AND_CHECK(event, status);
+        // initialize/restore original input buffer, the kernel never writes the border of the output buffer
+        cl_int status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.enqueueCopyBuffer(*_sourceBuffer, *_outputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.finish();
+        if (status != CL_SUCCESS) {
+            cerr << "stencil: failed to restore input data" << endl;
+            return -1;
+        }
 
-        for (int j = 0; j < ALGORITHM_ITERATIONS; ++j) {
+        for (int j = 0; j < steps; ++j) {
             // update kernel arguments
             _stencilKernel->setArg(0, *currentBuffer);
             _stencilKernel->setArg(1, *otherBuffer);
@@ -114,16 +136,208 @@ void Stencil::RunInternal() {
             // execute kernel
             _timer.Remember();
             status = queue.enqueueNDRangeKernel(*_stencilKernel, cl::NullRange, globalWorkSize, localWorkSize, nullptr, &event);
-            WAIT_AND_CHECK(event, status);
-            totalTimeCPU += _timer.Diff();
+            if (status == CL_SUCCESS)
+                status = event.wait();
+            const int64_t stepTimeCPU = _timer.Diff();
+
+            if (status != CL_SUCCESS) {
+                cerr << "stencil: kernel execution failed, error code: " << status << endl;
+                return -1;
+            }
+
+            if (timed) {
+                event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+                event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+                totalTimeCPU += stepTimeCPU;
+                totalTimeGPU += (endTime - startTime);
+            }
 
-            queue.finish();
+            // swap buffers, output is new input for next interation
+            auto temporaryBuffer = currentBuffer;
+            currentBuffer = otherBuffer;
+            otherBuffer = temporaryBuffer;
+        }
+    }
+
+    totalTimeCPU /= TEST_ITERATIONS;
+    totalTimeGPU /= TEST_ITERATIONS;
+
+    cout << " CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
+    PrintThroughput(totalTimeGPU);
+
+    // every time step swaps the buffers
+    ValidateResult("StencilKernel", ValidationSteps() % 2 == 0 ? *_inputBuffer : *_outputBuffer, reference);
 
+    timeCPU = totalTimeCPU;
+    return totalTimeGPU;
+}
+
+template <typename TItem>
+void Stencil::RunAsync(int64_t baselineTimeCPU, int64_t baselineTimeGPU, const vector<TItem>& reference) {
+    cl::CommandQueue& queue = _controller->Queue();
+
+    TItem center = WEIGHT_CENTER, cardinal = WEIGHT_CARDINAL, diagonal = WEIGHT_DIAGONAL;
+    cl_int alignment = 16;
+
+    cl::NDRange localWorkSize(1, LOCAL_COLUMNS);
+    cl::NDRange globalWorkSize(RoundToMultipleOf(MATRIX_HEIGHT - 2, LOCAL_ROWS) / LOCAL_ROWS,
+        RoundToMultipleOf(MATRIX_WIDTH - 2, LOCAL_COLUMNS));
+    cl_long startTime, endTime;
+
+    // one kernel object per direction, the arguments never change while enqueuing
+    cl_int status = CL_SUCCESS;
+    cl::Kernel kernels[2];
+    for (int k = 0; k < 2; ++k) {
+        kernels[k] = cl::Kernel(*_program, "StencilKernel", &status);
+        CHECK(status);
+        kernels[k].setArg(0, k == 0 ? *_inputBuffer : *_outputBuffer);
+        kernels[k].setArg(1, k == 0 ? *_outputBuffer : *_inputBuffer);
+        kernels[k].setArg(2, alignment);
+        kernels[k].setArg(3, center);
+        kernels[k].setArg(4, cardinal);
+        kernels[k].setArg(5, diagonal);
+    }
+
+    vector<cl::Event> events(ALGORITHM_ITERATIONS);
+    int64_t totalTimeCPU = 0;
+    int64_t totalTimeGPU = 0;
+
+    const int passes = TEST_ITERATIONS + (ValidationSteps() != ALGORITHM_ITERATIONS ? 1 : 0);
+    for (int i = 0; i < passes; ++i) {
+        const bool timed = i < TEST_ITERATIONS;
+        const int steps = timed ? ALGORITHM_ITERATIONS : ValidationSteps();
+
+        status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.enqueueCopyBuffer(*_sourceBuffer, *_outputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.finish();
+        CHECK(status);
+
+        // the queue is in-order, so step j + 1 only starts after step j has finished
+        _timer.Remember();
+        for (int j = 0; j < steps && status == CL_SUCCESS; ++j)
+            status = queue.enqueueNDRangeKernel(kernels[j % 2], cl::NullRange, globalWorkSize, localWorkSize, nullptr, &events[j]);
+        CHECK(status);
+        status = queue.finish();
+        const int64_t passTimeCPU = _timer.Diff();
+        CHECK(status);
+
+        if (!timed)
+            continue;
+
+        totalTimeCPU += passTimeCPU;
+        for (auto& event : events) {
             event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
             event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
             totalTimeGPU += (endTime - startTime);
+        }
+    }
+
+    totalTimeCPU /= TEST_ITERATIONS;
+    totalTimeGPU /= TEST_ITERATIONS;
+
+    cout << " CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
+    if (totalTimeCPU > 0) {
+        const double cellUpdates = static_cast<double>(MATRIX_HEIGHT - 2) * (MATRIX_WIDTH - 2) * ALGORITHM_ITERATIONS;
+        cout << "  throughput (wall clock): " << cellUpdates / totalTimeCPU << " GCellUpdates/s" << endl;
+    }
+    if (baselineTimeCPU > 0 && baselineTimeGPU > 0) {
+        cout << "  launch/sync overhead of one step per launch: "
+            << 100.0 * (baselineTimeCPU - baselineTimeGPU) / baselineTimeCPU << "% of " << baselineTimeCPU << " ns" << endl;
+    }
+    if (totalTimeCPU > 0)
+        cout << "  remaining overhead without per-step sync: " << 100.0 * (totalTimeCPU - totalTimeGPU) / totalTimeCPU << "%" << endl;
+
+    ValidateResult("StencilKernel (asynchronous)", ValidationSteps() % 2 == 0 ? *_inputBuffer : *_outputBuffer, reference);
+}
+
+template <typename TItem>
+int Stencil::InitTemporalBlocking(int timeSteps) {
+    // two tiles (ping-pong) with a halo of one cell per time step
+    cl_ulong localMemorySize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_LOCAL_MEM_SIZE, &localMemorySize);
+    const int extent = TEMPORAL_TILE + 2 * timeSteps;
+    const cl_ulong requiredMemory = 2 * extent * extent * sizeof(TItem);
+    if (requiredMemory > localMemorySize) {
+        cout << " requires " << requiredMemory << " bytes of local memory (" << localMemorySize << " available), skipped" << endl;
+        return 1;
+    }
+
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DLOCAL_ROWS=" + to_string(LOCAL_ROWS);
+    compilerParams += " -DLOCAL_COLUMNS=" + to_string(LOCAL_COLUMNS);
+    compilerParams += " -DGLOBAL_ROWS=" + to_string(MATRIX_HEIGHT);
+    compilerParams += " -DGLOBAL_COLUMNS=" + to_string(MATRIX_WIDTH);
+    compilerParams += " -DTB_TILE=" + to_string(TEMPORAL_TILE);
+    compilerParams += " -DTB_STEPS=" + to_string(timeSteps);
+
+    _temporalProgram = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "stencil2d.cl", compilerParams);
+
+    if (_temporalProgram.get() == nullptr)
+        return -1;
+
+    cl_int status = 0;
+    _temporalKernel = make_shared<cl::Kernel>(*_temporalProgram, "StencilKernelTemporal", &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+template <typename TItem>
+void Stencil::RunTemporalBlocking(int timeSteps, int64_t baselineTimeGPU, const vector<TItem>& reference) {
+    if (InitTemporalBlocking<TItem>(timeSteps) != 0)
+        return;
+
+    cl::CommandQueue& queue = _controller->Queue();
+
+    TItem center = WEIGHT_CENTER, cardinal = WEIGHT_CARDINAL, diagonal = WEIGHT_DIAGONAL;
+
+    // every work-group updates a tile of TEMPORAL_TILE x TEMPORAL_TILE interior cells
+    const int tileRows = RoundToMultipleOf(MATRIX_HEIGHT - 2, TEMPORAL_TILE) / TEMPORAL_TILE;
+    const int tileColumns = RoundToMultipleOf(MATRIX_WIDTH - 2, TEMPORAL_TILE) / TEMPORAL_TILE;
+    cl::NDRange localWorkSize(TEMPORAL_WORK_GROUP_EDGE, TEMPORAL_WORK_GROUP_EDGE);
+    cl::NDRange globalWorkSize(tileRows * TEMPORAL_WORK_GROUP_EDGE, tileColumns * TEMPORAL_WORK_GROUP_EDGE);
+    cl_long startTime, endTime;
+    cl::Event event;
+
+    int64_t totalTimeCPU = 0;
+    int64_t totalTimeGPU = 0;
+
+    _temporalKernel->setArg(2, center);
+    _temporalKernel->setArg(3, cardinal);
+    _temporalKernel->setArg(4, diagonal);
+
+    const int passes = TEST_ITERATIONS + (ValidationSteps() != ALGORITHM_ITERATIONS ? 1 : 0);
+    for (int i = 0; i < passes; ++i) {
+        const bool timed = i < TEST_ITERATIONS;
+        const int launches = (timed ? ALGORITHM_ITERATIONS : ValidationSteps()) / timeSteps;
+
+        auto currentBuffer = _inputBuffer;
+        auto otherBuffer = _outputBuffer;
+
+        cl_int status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.enqueueCopyBuffer(*_sourceBuffer, *_outputBuffer, 0, 0, MATRIX_WIDTH * MATRIX_HEIGHT * sizeof(TItem));
+        status |= queue.finish();
+        if (status != CL_SUCCESS) {
+            cerr << "stencil: failed to restore input data" << endl;
+            return;
+        }
+
+        for (int j = 0; j < launches; ++j) {
+            _temporalKernel->setArg(0, *currentBuffer);
+            _temporalKernel->setArg(1, *otherBuffer);
+
+            _timer.Remember();
+            status = queue.enqueueNDRangeKernel(*_temporalKernel, cl::NullRange, globalWorkSize, localWorkSize, nullptr, &event);
+            WAIT_AND_CHECK(event, status);
+            const int64_t stepTimeCPU = _timer.Diff();
+
+            if (timed) {
+                event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+                event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+                totalTimeCPU += stepTimeCPU;
+                totalTimeGPU += (endTime - startTime);
+            }
 
-            // swap buffers, output is new input for next interation
             auto temporaryBuffer = currentBuffer;
             currentBuffer = otherBuffer;
             otherBuffer = temporaryBuffer;
@@ -134,6 +348,242 @@ void Stencil::RunInternal() {
     totalTimeGPU /= TEST_ITERATIONS;
 
     cout << " CPU: " << totalTimeCPU << ", GPU: " << totalTimeGPU << endl;
+    PrintThroughput(totalTimeGPU);
+    if (baselineTimeGPU > 0 && totalTimeGPU > 0)
+        cout << "  speedup vs. one step per launch: " << static_cast<double>(baselineTimeGPU) / totalTimeGPU << endl;
+
+    ValidateResult("StencilKernelTemporal (" + to_string(timeSteps) + " steps)",
+        (ValidationSteps() / timeSteps) % 2 == 0 ? *_inputBuffer : *_outputBuffer, reference);
+}
+
+template <typename TItem>
+void Stencil::ComputeReference(vector<TItem>& reference, int steps) {
+    const TItem center = WEIGHT_CENTER, cardinal = WEIGHT_CARDINAL, diagonal = WEIGHT_DIAGONAL;
+
+    reference.resize(MATRIX_WIDTH * MATRIX_HEIGHT);
+    for (int i = 0; i < MATRIX_WIDTH * MATRIX_HEIGHT; ++i)
+        reference[i] = ((float)i) / MATRIX_WIDTH;   // same values as FillMatrix
+
+    // the border is constant, same summation order as the kernels
+    vector<TItem> next(reference);
+    for (int step = 0; step < steps; ++step) {
+        ParallelFor(MATRIX_HEIGHT - 2, [&](int64_t begin, int64_t end) -> void {
+                for (int64_t row = begin + 1; row < end + 1; ++row) {
+                    const TItem* src = &reference[row * MATRIX_WIDTH];
+                    TItem* dst = &next[row * MATRIX_WIDTH];
+
+                    for (int col = 1; col < MATRIX_WIDTH - 1; ++col) {
+                        TItem cardinalValueSum = src[col - MATRIX_WIDTH] + src[col + MATRIX_WIDTH] + src[col + 1] + src[col - 1];
+                        TItem diagonalValueSum = src[col - MATRIX_WIDTH + 1] + src[col + MATRIX_WIDTH + 1]
+                            + src[col - MATRIX_WIDTH - 1] + src[col + MATRIX_WIDTH - 1];
+                        dst[col] = center * src[col] + cardinal * cardinalValueSum + diagonal * diagonalValueSum;
+                    }
+                }
+            });
+        reference.swap(next);
+    }
+}
+
+template <typename TItem>
+void Stencil::ValidateResult(const string& testName, cl::Buffer& result, const vector<TItem>& reference) {
+    if (reference.empty())
+        return;
+
+    vector<TItem> values(MATRIX_WIDTH * MATRIX_HEIGHT);
+    cl_int status = _controller->Queue().enqueueReadBuffer(result, CL_TRUE, 0, values.size() * sizeof(TItem), &values[0]);
+    CHECK(status);
+
+    ValidateResults(testName, &values[0], values.size(), [&](int64_t i) -> TItem { return reference[i]; },
+        AccumulatedTolerance<TItem>(static_cast<int64_t>(ValidationSteps()) * STEP_OPERATIONS));
+}
+
+int Stencil::ValidationSteps() const {
+    // every cell depends on the whole matrix after ALGORITHM_ITERATIONS steps, sampling cells would not shorten the reference
+    return _validationMode == ValidationMode::Sampled ? VALIDATION_STEPS : ALGORITHM_ITERATIONS;
+}
+
+void Stencil::PrintThroughput(int64_t timeGPU) {
+    if (timeGPU <= 0)
+        return;
+
+    const double cellUpdates = static_cast<double>(MATRIX_HEIGHT - 2) * (MATRIX_WIDTH - 2) * ALGORITHM_ITERATIONS;
+    cout << "  throughput: " << cellUpdates / timeGPU << " GCellUpdates/s" << endl;
+}
+
+template <typename TItem>
+void Stencil::RunInternal() {
+    if (InitContext<TItem>() != 0) {
+        cout << endl;
+        return;
+    }
+
+    // the reference is shared by all variants, they compute the same ValidationSteps() time steps
+    vector<TItem> reference;
+    if (ValidationEnabled())
+        ComputeReference(reference, ValidationSteps());
+
+    int64_t baselineTimeCPU = 0;
+    int64_t baselineTimeGPU = RunBaseline<TItem>(baselineTimeCPU, reference);
+    if (baselineTimeGPU < 0)
+        return;
+
+    cout << "  asynchronous, no sync between steps:";
+    RunAsync<TItem>(baselineTimeCPU, baselineTimeGPU, reference);
+
+    for (int timeSteps : TEMPORAL_STEPS) {
+        cout << "  temporal blocking, " << timeSteps << " steps per launch:";
+        RunTemporalBlocking<TItem>(timeSteps, baselineTimeGPU, reference);
+    }
+}
+
+template <typename TItem>
+int Stencil::InitContext3D() {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DBLOCK_X=" + to_string(BLOCK_X_3D);
+    compilerParams += " -DBLOCK_Y=" + to_string(BLOCK_Y_3D);
+
+    _program3D = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "stencil3d.cl", compilerParams);
+
+    if (_program3D.get() == nullptr)
+        return -1;
+
+    return 0;
+}
+
+template <typename TItem>
+void Stencil::RunGrid3D(int nx, int ny, int nz) {
+    cl::CommandQueue& queue = _controller->Queue();
+
+    const size_t bufferSize = static_cast<size_t>(nx) * ny * nz * sizeof(TItem);
+    cl_ulong maxAllocationSize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    if (bufferSize > maxAllocationSize) {
+        cout << "  grid " << nx << "x" << ny << "x" << nz << " exceeds the maximum allocation size, skipped" << endl;
+        return;
+    }
+
+    _sourceBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    _inputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    _outputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+
+    FillMatrix<TItem>(*_sourceBuffer, nx, ny * nz);
+
+    const int64_t cells = static_cast<int64_t>(nx) * ny * nz;
+    vector<TItem> source, result;
+    if (ValidationEnabled()) {
+        source.resize(cells);
+        result.resize(cells);
+        cl_int status = queue.enqueueReadBuffer(*_sourceBuffer, CL_TRUE, 0, bufferSize, &source[0]);
+        CHECK(status);
+    }
+
+    const double cellUpdates = static_cast<double>(nx - 2) * (ny - 2) * (nz - 2);
+    const size_t paddedX = RoundToMultipleOf(nx - 2, BLOCK_X_3D);
+    const size_t paddedY = RoundToMultipleOf(ny - 2, BLOCK_Y_3D);
+
+    const char* kernelNames[] = { "Stencil7Naive", "Stencil7Streaming", "Stencil27Streaming" };
+    for (const char* kernelName : kernelNames) {
+        cl_int status = CL_SUCCESS;
+        cl::Kernel kernel(*_program3D, kernelName, &status);
+        CHECK(status);
+
+        const bool naive = string(kernelName) == "Stencil7Naive";
+        const bool points27 = string(kernelName) == "Stencil27Streaming";
+        cl::NDRange localWorkSize = naive ? cl::NDRange(BLOCK_X_3D, BLOCK_Y_3D, 1) : cl::NDRange(BLOCK_X_3D, BLOCK_Y_3D);
+        cl::NDRange globalWorkSize = naive ? cl::NDRange(paddedX, paddedY, nz - 2) : cl::NDRange(paddedX, paddedY);
+
+        kernel.setArg(2, nx);
+        kernel.setArg(3, ny);
+        kernel.setArg(4, nz);
+        if (points27) {
+            kernel.setArg(5, static_cast<TItem>(WEIGHT_CENTER_27));
+            kernel.setArg(6, static_cast<TItem>(WEIGHT_FACE_27));
+            kernel.setArg(7, static_cast<TItem>(WEIGHT_EDGE_27));
+            kernel.setArg(8, static_cast<TItem>(WEIGHT_CORNER_27));
+        } else {
+            kernel.setArg(5, static_cast<TItem>(WEIGHT_CENTER_7));
+            kernel.setArg(6, static_cast<TItem>(WEIGHT_NEIGHBOR_7));
+        }
+
+        // the kernels never write the border, both buffers start with the same content
+        status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, bufferSize);
+        status |= queue.enqueueCopyBuffer(*_sourceBuffer, *_outputBuffer, 0, 0, bufferSize);
+        status |= queue.finish();
+        CHECK(status);
+
+        auto currentBuffer = _inputBuffer;
+        auto otherBuffer = _outputBuffer;
+
+        string testName = "  " + string(kernelName) + " " + to_string(nx) + "x" + to_string(ny) + "x" + to_string(nz);
+        // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                events.resize(1);
+                kernel.setArg(0, *currentBuffer);
+                kernel.setArg(1, *otherBuffer);
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalWorkSize, localWorkSize, nullptr, &events[0]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+                swap(currentBuffer, otherBuffer);
+            }, testName, ITERATIONS_3D);
+        CHECK(status);
+
+        const double timeGPU = static_cast<double>(_gpuStatistics.Mean());
+        if (timeGPU > 0) {
+            cout << "    " << cellUpdates * 2 * sizeof(TItem) / timeGPU << " GB/s, "
+                << cellUpdates / timeGPU << " GCellUpdates/s" << endl;
+        }
+
+        if (!ValidationEnabled())
+            continue;
+
+        // a single time step on freshly initialized buffers
+        status = queue.enqueueCopyBuffer(*_sourceBuffer, *_inputBuffer, 0, 0, bufferSize);
+        status |= queue.enqueueCopyBuffer(*_sourceBuffer, *_outputBuffer, 0, 0, bufferSize);
+        status |= queue.finish();
+        CHECK(status);
+
+        cl::Event event;
+        kernel.setArg(0, *_inputBuffer);
+        kernel.setArg(1, *_outputBuffer);
+        status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, globalWorkSize, localWorkSize, nullptr, &event);
+        WAIT_AND_CHECK(event, status);
+        status = queue.enqueueReadBuffer(*_outputBuffer, CL_TRUE, 0, bufferSize, &result[0]);
+        CHECK(status);
+
+        ValidateResults(testName.substr(2), &result[0], cells, [&](int64_t i) -> TItem {
+                const int x = static_cast<int>(i % nx);
+                const int y = static_cast<int>((i / nx) % ny);
+                const int z = static_cast<int>(i / (static_cast<int64_t>(nx) * ny));
+                if (x == 0 || y == 0 || z == 0 || x == nx - 1 || y == ny - 1 || z == nz - 1)
+                    return source[i];
+
+                const int64_t sx = 1, sy = nx, sz = static_cast<int64_t>(nx) * ny;
+                auto at = [&](int dx, int dy, int dz) -> TItem { return source[i + dx * sx + dy * sy + dz * sz]; };
+
+                if (!points27) {
+                    return static_cast<TItem>(WEIGHT_CENTER_7) * at(0, 0, 0) + static_cast<TItem>(WEIGHT_NEIGHBOR_7) *
+                        (at(-1, 0, 0) + at(1, 0, 0) + at(0, -1, 0) + at(0, 1, 0) + at(0, 0, -1) + at(0, 0, 1));
+                }
+
+                TItem faces = at(-1, 0, 0) + at(1, 0, 0) + at(0, -1, 0) + at(0, 1, 0) + at(0, 0, -1) + at(0, 0, 1);
+                TItem edges = at(-1, -1, 0) + at(1, -1, 0) + at(-1, 1, 0) + at(1, 1, 0) +
+                    at(-1, 0, -1) + at(1, 0, -1) + at(0, -1, -1) + at(0, 1, -1) +
+                    at(-1, 0, 1) + at(1, 0, 1) + at(0, -1, 1) + at(0, 1, 1);
+                TItem corners = at(-1, -1, -1) + at(1, -1, -1) + at(-1, 1, -1) + at(1, 1, -1) +
+                    at(-1, -1, 1) + at(1, -1, 1) + at(-1, 1, 1) + at(1, 1, 1);
+                return static_cast<TItem>(WEIGHT_CENTER_27) * at(0, 0, 0) + static_cast<TItem>(WEIGHT_FACE_27) * faces +
+                    static_cast<TItem>(WEIGHT_EDGE_27) * edges + static_cast<TItem>(WEIGHT_CORNER_27) * corners;
+            });
+    }
+}
+
+template <typename TItem>
+void Stencil::RunInternal3D() {
+    if (InitContext3D<TItem>() != 0)
+        return;
+
+    for (auto& grid : GRID_SIZES_3D)
+        RunGrid3D<TItem>(grid[0], grid[1], grid[2]);
 }
 
 void Stencil::Run() {
@@ -146,5 +596,12 @@ void Stencil::Run() {
         RunInternal<double>();
     }
 
+    cout << "Stencil3D<float>" << endl;
+    RunInternal3D<float>();
+    if (_controller->SupportsDoublePrecision()) {
+        cout << "Stencil3D<double>" << endl;
+        RunInternal3D<double>();
+    }
+
     cout << endl;
 }
@@ -4,6 +4,8 @@
 #include "../benchmarkbase.hpp"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace benchmarks {
 
@@ -18,6 +20,9 @@ private:
 	std::shared_ptr<cl::Buffer> _outputBuffer = nullptr;
 	std::shared_ptr<cl::Kernel> _stencilKernel = nullptr;
 	std::shared_ptr<cl::Program> _program = nullptr;
+	std::shared_ptr<cl::Kernel> _temporalKernel = nullptr;
+	std::shared_ptr<cl::Program> _temporalProgram = nullptr;
+	std::shared_ptr<cl::Program> _program3D = nullptr;
 
     /**
      * Execute the kernels and generate statistics.
@@ -25,6 +30,89 @@ private:
     template <typename TItem>
     void RunInternal();
 
+    /**
+     * Executes the one-step-per-launch kernel.
+     *
+     * @param timeCPU receives the average cpu time in ns for all ALGORITHM_ITERATIONS time steps
+     * @param reference result of ComputeReference, empty if validation is disabled
+     * @return average gpu time in ns for all ALGORITHM_ITERATIONS time steps, -1 on error
+     */
+    template <typename TItem>
+    int64_t RunBaseline(int64_t& timeCPU, const std::vector<TItem>& reference);
+
+    /**
+     * Executes the one-step-per-launch kernel without synchronizing between the time steps.
+     * Two kernel instances with swapped buffer arguments are enqueued back-to-back,
+     * the device time is gathered from the events after the final finish().
+     *
+     * @param baselineTimeCPU cpu time of RunBaseline
+     * @param baselineTimeGPU result of RunBaseline
+     * @param reference result of ComputeReference, empty if validation is disabled
+     */
+    template <typename TItem>
+    void RunAsync(int64_t baselineTimeCPU, int64_t baselineTimeGPU, const std::vector<TItem>& reference);
+
+    /**
+     * Compiles the temporally blocked kernel for the given amount of time steps per launch.
+     *
+     * @return zero on success, a positive value if the tile does not fit into local memory
+     */
+    template <typename TItem>
+    int InitTemporalBlocking(int timeSteps);
+
+    /**
+     * Executes the temporally blocked kernel and compares its throughput with the baseline.
+     *
+     * @param timeSteps time steps computed in local memory per kernel launch
+     * @param baselineTimeGPU result of RunBaseline
+     * @param reference result of ComputeReference, empty if validation is disabled
+     */
+    template <typename TItem>
+    void RunTemporalBlocking(int timeSteps, int64_t baselineTimeGPU, const std::vector<TItem>& reference);
+
+    /**
+     * Computes the given amount of time steps of the 2D stencil on the host.
+     */
+    template <typename TItem>
+    void ComputeReference(std::vector<TItem>& reference, int steps);
+
+    /**
+     * Time steps of the validated 2D run. Sampled validation checks an additional untimed run
+     * of VALIDATION_STEPS, full validation the last timed run of ALGORITHM_ITERATIONS steps.
+     */
+    int ValidationSteps() const;
+
+    /**
+     * Reads the result of a 2D run after ValidationSteps() time steps and compares it with the host reference.
+     */
+    template <typename TItem>
+    void ValidateResult(const std::string& testName, cl::Buffer& result, const std::vector<TItem>& reference);
+
+    /**
+     * Prints the throughput in cell updates per second for ALGORITHM_ITERATIONS time steps.
+     */
+    void PrintThroughput(int64_t timeGPU);
+
+    /**
+     * Compile the 3D kernels (stencil3d.cl).
+     */
+    template <typename TItem>
+    int InitContext3D();
+
+    /**
+     * Execute the 3D stencil kernels on all grid sizes.
+     */
+    template <typename TItem>
+    void RunInternal3D();
+
+    /**
+     * Allocates a grid of the given size and executes all 3D kernels on it.
+     * Reports GB/s (one read and one write per cell) and cell updates per second.
+     * Every kernel is validated with a single time step against a host reference.
+     */
+    template <typename TItem>
+    void RunGrid3D(int nx, int ny, int nz);
+
     /**
      * Fill the given matrix with some numbers and copy it to the device.
      */
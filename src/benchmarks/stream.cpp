@@ -0,0 +1,200 @@
+#include "stream.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../clglobal.hpp"
+#include "../computecontroller.hpp"
+
+using namespace benchmarks;
+using namespace std;
+
+static const size_t ARRAY_SIZE = 256 * 1024 * 1024;    // bytes per array, far beyond the size of any device cache
+static const int WORK_GROUP_SIZE = 256;
+static const int GROUPS_PER_COMPUTE_UNIT = 16;          // enough work-groups to hide the memory latency
+static const int ITERATIONS = 20;
+static const int VECTOR_WIDTHS[] = { 1, 2, 4, 8, 16 };
+
+// initial values of the arrays and the scalar, the expected results after copy, scale, add and
+// triad are exact in single precision: c = 1, b = 3, c = 4, a = 15
+static const int INITIAL_A = 1;
+static const int INITIAL_B = 2;
+static const int INITIAL_C = 0;
+static const int SCALAR = 3;
+
+Stream::Stream(std::shared_ptr<ComputeController> controller)
+    : BenchmarkBase(controller)
+    , _bestTriadConfiguration() {
+
+}
+
+Stream::~Stream() {
+
+}
+
+template <typename TItem>
+int Stream::InitBuffers() {
+    cl_ulong maxAllocationSize = 0;
+    cl_ulong globalMemorySize = 0;
+    cl_uint computeUnits = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_GLOBAL_MEM_SIZE, &globalMemorySize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_COMPUTE_UNITS, &computeUnits);
+
+    // keep a quarter of the device memory free, the size stays a multiple of the widest vector
+    size_t bytes = ARRAY_SIZE;
+    while (bytes > maxAllocationSize || 4 * bytes > 3 * globalMemorySize)
+        bytes /= 2;
+
+    _arrayLength = bytes / sizeof(TItem);
+    _workGroupCount = max<int>(1, computeUnits * GROUPS_PER_COMPUTE_UNIT);
+
+    cl_int status = CL_SUCCESS;
+    _bufferA = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _bufferB = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _bufferC = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    cout << "  3 arrays of " << (bytes / (1024 * 1024)) << " MiB, " << _workGroupCount << " work-groups of "
+        << WORK_GROUP_SIZE << " work-items" << endl;
+
+    return 0;
+}
+
+template <typename TItem>
+int Stream::InitContext(int vectorWidth) {
+    string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DVECTOR_WIDTH=" + to_string(vectorWidth);
+
+    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "stream.cl", compilerParams);
+
+    if (_program.get() == nullptr)
+        return -1;
+
+    return 0;
+}
+
+template <typename TItem>
+void Stream::ResetArrays() {
+    cl::CommandQueue& queue = _controller->Queue();
+    const size_t bytes = _arrayLength * sizeof(TItem);
+
+    queue.enqueueFillBuffer(*_bufferA, static_cast<TItem>(INITIAL_A), 0, bytes);
+    queue.enqueueFillBuffer(*_bufferB, static_cast<TItem>(INITIAL_B), 0, bytes);
+    queue.enqueueFillBuffer(*_bufferC, static_cast<TItem>(INITIAL_C), 0, bytes);
+    queue.finish();
+}
+
+template <typename TItem>
+void Stream::RunInternal(int vectorWidth, bool blocked) {
+    // bytes per element counted like STREAM: every array which is read or written once, no write-allocate traffic
+    const string operations[] = { "Copy", "Scale", "Add", "Triad" };
+    const int arraysAccessed[] = { 2, 2, 3, 3 };
+
+    cl::CommandQueue& queue = _controller->Queue();
+    const int vectorCount = static_cast<int>(_arrayLength / vectorWidth);
+    const TItem scalar = static_cast<TItem>(SCALAR);
+    const string configuration = string(sizeof(TItem) == sizeof(float) ? "float" : "double")
+        + (vectorWidth > 1 ? to_string(vectorWidth) : "") + (blocked ? ", blocked" : ", grid-stride");
+
+    cl::NDRange global(_workGroupCount * WORK_GROUP_SIZE);
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    cout << "Stream<" << configuration << ">" << endl;
+
+    ResetArrays<TItem>();
+
+    for (int i = 0; i < 4; ++i) {
+        cl_int status = CL_SUCCESS;
+        const string kernelName = "Stream" + operations[i] + (blocked ? "Blocked" : "");
+        cl::Kernel kernel(*_program, kernelName.c_str(), &status);
+        CHECK(status);
+
+        kernel.setArg(0, *_bufferA);
+        kernel.setArg(1, *_bufferB);
+        kernel.setArg(2, *_bufferC);
+        kernel.setArg(3, scalar);
+        kernel.setArg(4, vectorCount);
+
+        // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                events.resize(1);
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            }, "  " + operations[i], ITERATIONS);
+        CHECK(status);
+
+        // STREAM reports the best run, the mean shows how stable the bandwidth is
+        const double bytes = static_cast<double>(arraysAccessed[i]) * _arrayLength * sizeof(TItem);
+        const double bestBandwidth = _gpuStatistics.Min() > 0 ? bytes / _gpuStatistics.Min() : 0.0;
+        const double meanBandwidth = _gpuStatistics.Mean() > 0 ? bytes / _gpuStatistics.Mean() : 0.0;
+        cout << "  " << operations[i] << ": " << bestBandwidth << " GB/s (mean: " << meanBandwidth << " GB/s)" << endl;
+
+        if (operations[i] == "Triad" && bestBandwidth > _bestTriadBandwidth) {
+            _bestTriadBandwidth = bestBandwidth;
+            _bestTriadConfiguration = configuration;
+        }
+    }
+
+    if (!ValidationEnabled())
+        return;
+
+    vector<TItem> a(_arrayLength), b(_arrayLength), c(_arrayLength);
+    queue.enqueueReadBuffer(*_bufferA, CL_TRUE, 0, _arrayLength * sizeof(TItem), &a[0]);
+    queue.enqueueReadBuffer(*_bufferB, CL_TRUE, 0, _arrayLength * sizeof(TItem), &b[0]);
+    queue.enqueueReadBuffer(*_bufferC, CL_TRUE, 0, _arrayLength * sizeof(TItem), &c[0]);
+
+    // every kernel is idempotent, so the arrays contain the result of one pass of the whole sequence
+    const TItem expectedC = static_cast<TItem>(INITIAL_A + SCALAR * INITIAL_A);
+    const TItem expectedB = static_cast<TItem>(SCALAR * INITIAL_A);
+    const TItem expectedA = static_cast<TItem>(expectedB + SCALAR * expectedC);
+    Validate("Stream<" + configuration + ">", static_cast<int64_t>(_arrayLength), [&](int64_t i) -> bool {
+            return a[i] == expectedA && b[i] == expectedB && c[i] == expectedC;
+        });
+}
+
+void Stream::Cleanup() {
+    _bufferA.reset();
+    _bufferB.reset();
+    _bufferC.reset();
+    _program.reset();
+}
+
+void Stream::Run() {
+    cout << "Stream Benchmark (copy, scale, add, triad):" << endl;
+
+    _bestTriadBandwidth = 0.0;
+    _bestTriadConfiguration.clear();
+
+    if (InitBuffers<float>() == 0) {
+        for (auto& vectorWidth : VECTOR_WIDTHS) {
+            if (InitContext<float>(vectorWidth) == 0) {
+                RunInternal<float>(vectorWidth, false);
+                RunInternal<float>(vectorWidth, true);
+            }
+        }
+    }
+    Cleanup();
+
+    if (_controller->SupportsDoublePrecision()) {
+        if (InitBuffers<double>() == 0) {
+            for (auto& vectorWidth : VECTOR_WIDTHS) {
+                if (InitContext<double>(vectorWidth) == 0) {
+                    RunInternal<double>(vectorWidth, false);
+                    RunInternal<double>(vectorWidth, true);
+                }
+            }
+        }
+        Cleanup();
+    }
+
+    if (_bestTriadBandwidth > 0.0)
+        cout << "Sustainable device bandwidth (best triad): " << _bestTriadBandwidth << " GB/s, Stream<"
+            << _bestTriadConfiguration << ">" << endl;
+
+    cout << endl;
+}
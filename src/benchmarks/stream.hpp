@@ -0,0 +1,76 @@
+#ifndef __BENCH_BENCHMARKS_STREAM_HPP
+#define __BENCH_BENCHMARKS_STREAM_HPP
+
+#include "../benchmarkbase.hpp"
+
+#include <memory>
+#include <string>
+
+namespace benchmarks {
+
+/**
+ * STREAM-style device memory benchmark: copy, scale, add and triad on three device arrays.
+ * Every kernel is executed for single and double precision, vector widths from 1 to 16 and with
+ * a grid-stride as well as a blocked work distribution. The best triad bandwidth is reported as the
+ * sustainable device bandwidth.
+ */
+class Stream : public BenchmarkBase {
+private:
+
+    std::shared_ptr<cl::Buffer> _bufferA = nullptr;
+    std::shared_ptr<cl::Buffer> _bufferB = nullptr;
+    std::shared_ptr<cl::Buffer> _bufferC = nullptr;
+    std::shared_ptr<cl::Program> _program = nullptr;
+
+    size_t _arrayLength = 0;        // number of TItem values per array
+    int _workGroupCount = 0;
+
+    double _bestTriadBandwidth = 0.0;
+    std::string _bestTriadConfiguration;
+
+    /**
+     * Allocates the three arrays. Their size is ARRAY_SIZE bytes or less if the device can not hold it.
+     */
+    template <typename TItem>
+    int InitBuffers();
+
+    /**
+     * Compiles the kernels for the given vector width.
+     */
+    template <typename TItem>
+    int InitContext(int vectorWidth);
+
+    /**
+     * Sets the arrays to their initial values (a = 1, b = 2, c = 0).
+     */
+    template <typename TItem>
+    void ResetArrays();
+
+    /**
+     * Executes copy, scale, add and triad in this order, prints the bandwidth of each kernel
+     * and validates the arrays afterwards.
+     *
+     * @param blocked run the blocked variants instead of the grid-stride kernels
+     */
+    template <typename TItem>
+    void RunInternal(int vectorWidth, bool blocked);
+
+    /**
+     * Release all buffers and the program instance.
+     */
+    void Cleanup();
+
+public:
+    explicit Stream(std::shared_ptr<ComputeController> controller);
+
+    virtual ~Stream();
+
+    /**
+     * Execute the STREAM kernels for float and (if supported) double precision.
+     */
+    void Run();
+};
+
+}
+
+#endif // __BENCH_BENCHMARKS_STREAM_HPP
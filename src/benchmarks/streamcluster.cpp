@@ -1,8 +1,12 @@
 #include "streamcluster.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <memory>
+#include <numeric>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include "../clglobal.hpp"
@@ -11,21 +15,95 @@
 using namespace benchmarks;
 using namespace std;
 
-static const int MAXIMUM_CLUSTERS = 5;
-static const int NUMBER_OF_POINTS = 1024 * 1024;
-static const int POINT_DIMENSION = 3;
-static const int TEST_ITERATIONS = 100;
+// parameters of the Rodinia/PARSEC implementation
+static const int KMIN = 10;                     // minimum and maximum number of centers per point set
+static const int KMAX = 20;
+static const int ITER = 3;                      // iterations of pFL and number of feasible centers scale with it
+static const int SP = 1;                        // chances of pspeedy to open KMIN centers before z is reduced
+
+static const int WORK_GROUP_SIZE = 256;
 static const int RANDOM_SEED = 85733;
+static const int GAIN_CHECKS = 8;               // pgain calls per point set which are compared with the host
+
+// points in a stream, points per chunk, dimension
+static const int STREAMS[][3] = {
+    { 16384, 16384, 128 },                      // PARSEC simlarge
+    { 65536, 65536, 256 },                      // Rodinia default
+    { 262144, 65536, 128 }                      // four chunks
+};
+
+// the stream is drawn from gaussian clusters around random sources
+static const int SOURCE_COUNT = 32;
+static const double SOURCE_DEVIATION = 0.05;
+
+namespace benchmarks {
 
+/**
+ * Point set on the host, the coordinates are stored point by point.
+ */
 template <typename TItem>
-struct Point {
-    TItem weight;
-    int assign;
-    TItem cost;
+struct StreamPoints {
+    int count = 0;
+    int dimension = 0;
+    vector<TItem> coordinates{};
+    vector<TItem> weights{};
+    vector<TItem> costs{};
+    vector<int> assignments{};
 };
 
+}
+
+template <typename TItem>
+static double Distance(const StreamPoints<TItem>& points, int a, int b) {
+    const TItem* first = &points.coordinates[static_cast<size_t>(a) * points.dimension];
+    const TItem* second = &points.coordinates[static_cast<size_t>(b) * points.dimension];
+
+    double distance = 0.0;
+    for (int d = 0; d < points.dimension; ++d) {
+        const double difference = static_cast<double>(first[d]) - second[d];
+        distance += difference * difference;
+    }
+    return distance;
+}
+
+template <typename TItem>
+static void GenerateChunk(StreamPoints<TItem>& points, int offset, int count, int dimension) {
+    // the sources are the same for all chunks of a stream
+    default_random_engine sourceEngine(RANDOM_SEED);
+    uniform_real_distribution<double> sourceDistribution(0.0, 1.0);
+    vector<double> sources(SOURCE_COUNT * dimension);
+    for (auto& coordinate : sources)
+        coordinate = sourceDistribution(sourceEngine);
+
+    default_random_engine randomEngine(RANDOM_SEED + offset + 1);
+    uniform_int_distribution<int> sourceIndexDistribution(0, SOURCE_COUNT - 1);
+    normal_distribution<double> noiseDistribution(0.0, SOURCE_DEVIATION);
+
+    points.count = count;
+    points.dimension = dimension;
+    points.coordinates.resize(static_cast<size_t>(count) * dimension);
+    points.weights.assign(count, static_cast<TItem>(1));
+    points.costs.assign(count, static_cast<TItem>(0));
+    points.assignments.assign(count, 0);
+
+    for (int i = 0; i < count; ++i) {
+        const int source = sourceIndexDistribution(randomEngine);
+        for (int d = 0; d < dimension; ++d)
+            points.coordinates[static_cast<size_t>(i) * dimension + d] =
+                static_cast<TItem>(sources[source * dimension + d] + noiseDistribution(randomEngine));
+    }
+}
+
 StreamCluster::StreamCluster(std::shared_ptr<ComputeController> controller)
-        : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _randomEngine()
+    , _isCenter()
+    , _centerTable()
+    , _slotCenters()
+    , _freeSlots()
+    , _deviceGains()
+    , _hostGains()
+    , _gainScales() {
 
 }
 
@@ -36,142 +114,565 @@ StreamCluster::~StreamCluster() {
 template <typename TItem>
 int StreamCluster::InitContext() {
     string compilerParams = GetCompilerFlags<TItem>();
+    compilerParams += " -DWORK_GROUP_SIZE=" + to_string(WORK_GROUP_SIZE);
+
     _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "streamcluster.cl", compilerParams);
 
     if (_program.get() == nullptr)
         return -1;
 
     cl_int status = CL_SUCCESS;
-    _kernel = make_shared<cl::Kernel>(*_program, "pgain_kernel", &status);
+    _gainKernel = make_shared<cl::Kernel>(*_program, "PGain", &status);
+    CHECK_RETURN_ERROR(status);
+    _evaluateKernel = make_shared<cl::Kernel>(*_program, "EvaluateGain", &status);
+    CHECK_RETURN_ERROR(status);
+    _applyKernel = make_shared<cl::Kernel>(*_program, "ApplyGain", &status);
+    CHECK_RETURN_ERROR(status);
+
+    return 0;
+}
+
+template <typename TItem>
+int StreamCluster::InitDeviceMemory(const StreamPoints<TItem>& points) {
+    const int n = points.count;
+    const cl::Context& context = _controller->Context();
+    cl::CommandQueue& queue = _controller->Queue();
+
+    // dimension by dimension for coalesced loads
+    vector<TItem> coordinates(points.coordinates.size());
+    for (int i = 0; i < n; ++i) {
+        for (int d = 0; d < points.dimension; ++d)
+            coordinates[static_cast<size_t>(d) * n + i] = points.coordinates[static_cast<size_t>(i) * points.dimension + d];
+    }
+
+    cl_int status = CL_SUCCESS;
+    _coordinatesBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, coordinates.size() * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _weightBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, n * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _costBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, n * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _assignmentBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, n * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _centerTableBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, n * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _xCostBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, n * sizeof(TItem), nullptr, &status);
     CHECK_RETURN_ERROR(status);
+    _switchMembershipBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, n * sizeof(cl_char), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _resultBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, 2 * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    status = queue.enqueueWriteBuffer(*_coordinatesBuffer, CL_TRUE, 0, coordinates.size() * sizeof(TItem), &coordinates[0]);
+    CHECK_RETURN_ERROR(status);
+    status = queue.enqueueWriteBuffer(*_weightBuffer, CL_TRUE, 0, n * sizeof(TItem), &points.weights[0]);
+    CHECK_RETURN_ERROR(status);
+
+    _groups = (n + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE;
+    _slotCapacity = 0;
+
+    _gainKernel->setArg(0, *_coordinatesBuffer);
+    _gainKernel->setArg(1, *_weightBuffer);
+    _gainKernel->setArg(2, *_costBuffer);
+    _gainKernel->setArg(3, *_assignmentBuffer);
+    _gainKernel->setArg(4, *_centerTableBuffer);
+    _gainKernel->setArg(5, *_xCostBuffer);
+    _gainKernel->setArg(6, *_switchMembershipBuffer);
+    _gainKernel->setArg(8, cl::Local(points.dimension * sizeof(TItem)));
+    _gainKernel->setArg(9, n);
+    _gainKernel->setArg(10, points.dimension);
+
+    _evaluateKernel->setArg(1, _groups);
+    _evaluateKernel->setArg(6, *_resultBuffer);
+
+    _applyKernel->setArg(0, *_costBuffer);
+    _applyKernel->setArg(1, *_assignmentBuffer);
+    _applyKernel->setArg(2, *_centerTableBuffer);
+    _applyKernel->setArg(3, *_xCostBuffer);
+    _applyKernel->setArg(4, *_switchMembershipBuffer);
+    _applyKernel->setArg(6, n);
+
+    return 0;
+}
 
-    _pointBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, NUMBER_OF_POINTS * sizeof(Point<TItem>));
-    _coordinatesBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, NUMBER_OF_POINTS * POINT_DIMENSION * sizeof(TItem));
-    _costBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, NUMBER_OF_POINTS * (MAXIMUM_CLUSTERS + 1) * sizeof(TItem));
-    _centerTableBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, NUMBER_OF_POINTS * sizeof(int));
-    _membershipBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, NUMBER_OF_POINTS * sizeof(char));
+template <typename TItem>
+int StreamCluster::EnsureSlotCapacity() {
+    const int slots = static_cast<int>(_slotCenters.size());
+    if (slots <= _slotCapacity)
+        return 0;
 
-    cl_int numberOfPoints = NUMBER_OF_POINTS;
-    cl_int numberOfCenters = MAXIMUM_CLUSTERS;
+    _slotCapacity = max(2 * _slotCapacity, slots);
 
-    _kernel->setArg(0, *_pointBuffer);
-    _kernel->setArg(1, *_coordinatesBuffer);
-    _kernel->setArg(2, *_costBuffer);
-    _kernel->setArg(3, *_centerTableBuffer);
-    _kernel->setArg(4, *_membershipBuffer);
-    _kernel->setArg(5, numberOfPoints);
-    _kernel->setArg(7, numberOfCenters);
+    // one partial result per work-group and slot plus the saving of the points which switch to x
+    cl_int status = CL_SUCCESS;
+    const cl::Context& context = _controller->Context();
+    _partialsBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE,
+        static_cast<size_t>(_groups) * (_slotCapacity + 1) * sizeof(TItem), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _slotCenterBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_ONLY, _slotCapacity * sizeof(cl_int), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+    _closeCenterBuffer = make_shared<cl::Buffer>(context, CL_MEM_READ_WRITE, _slotCapacity * sizeof(cl_char), nullptr, &status);
+    CHECK_RETURN_ERROR(status);
+
+    _gainKernel->setArg(7, *_partialsBuffer);
+    _evaluateKernel->setArg(0, *_partialsBuffer);
+    _evaluateKernel->setArg(3, *_slotCenterBuffer);
+    _evaluateKernel->setArg(5, *_closeCenterBuffer);
+    _applyKernel->setArg(5, *_closeCenterBuffer);
 
     return 0;
 }
 
-void StreamCluster::Cleanup() {
-    _pointBuffer.reset();
-    _coordinatesBuffer.reset();
-    _costBuffer.reset();
-    _centerTableBuffer.reset();
-    _membershipBuffer.reset();
+template <typename TItem>
+int StreamCluster::UploadCenters(const StreamPoints<TItem>& points) {
+    const int n = points.count;
+
+    _isCenter.assign(n, 0);
+    for (int i = 0; i < n; ++i)
+        _isCenter[points.assignments[i]] = 1;
+
+    _centerTable.assign(n, 0);
+    _slotCenters.clear();
+    _freeSlots.clear();
+    for (int i = 0; i < n; ++i) {
+        if (_isCenter[i]) {
+            _centerTable[i] = static_cast<int>(_slotCenters.size());
+            _slotCenters.push_back(i);
+        }
+    }
 
-    _kernel.reset();
-    _program.reset();
+    if (EnsureSlotCapacity<TItem>() != 0)
+        return -1;
+
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueWriteBuffer(*_costBuffer, CL_TRUE, 0, n * sizeof(TItem), &points.costs[0]);
+    status |= queue.enqueueWriteBuffer(*_assignmentBuffer, CL_TRUE, 0, n * sizeof(cl_int), &points.assignments[0]);
+    status |= queue.enqueueWriteBuffer(*_centerTableBuffer, CL_TRUE, 0, n * sizeof(cl_int), &_centerTable[0]);
+    status |= queue.enqueueWriteBuffer(*_slotCenterBuffer, CL_TRUE, 0, _slotCenters.size() * sizeof(cl_int), &_slotCenters[0]);
+    if (status != CL_SUCCESS)
+        return -1;
+
+    return static_cast<int>(_slotCenters.size());
 }
 
 template <typename TItem>
-void StreamCluster::InitDeviceMemory() {
-    // initialize datastructures
-    vector<TItem> coordinates;
-    coordinates.resize(NUMBER_OF_POINTS * POINT_DIMENSION);
-    for (int i = 0; i < NUMBER_OF_POINTS * POINT_DIMENSION; ++i) {
-        coordinates[i] = static_cast<TItem>(i) / INT32_MAX;
+double StreamCluster::PSpeedy(StreamPoints<TItem>& points, const vector<int>& order, double z, int& centers) {
+    const int n = points.count;
+
+    // the first point is always a center
+    const int first = order[0];
+    ParallelFor(n, [&](int64_t begin, int64_t end) -> void {
+            for (int64_t k = begin; k < end; ++k) {
+                points.costs[k] = static_cast<TItem>(Distance(points, static_cast<int>(k), first) * points.weights[k]);
+                points.assignments[k] = first;
+            }
+        });
+    centers = 1;
+
+    uniform_real_distribution<double> openDistribution(0.0, 1.0);
+    for (int i = 1; i < n; ++i) {
+        const int candidate = order[i];
+        if (openDistribution(_randomEngine) >= points.costs[candidate] / z)
+            continue;
+
+        ++centers;
+        ParallelFor(n, [&](int64_t begin, int64_t end) -> void {
+                for (int64_t k = begin; k < end; ++k) {
+                    const TItem distance = static_cast<TItem>(Distance(points, static_cast<int>(k), candidate) * points.weights[k]);
+                    if (distance < points.costs[k]) {
+                        points.costs[k] = distance;
+                        points.assignments[k] = candidate;
+                    }
+                }
+            });
     }
 
-    default_random_engine randomEngine(RANDOM_SEED);
-    uniform_real_distribution<TItem> weightDistribution(static_cast<TItem>(0.7), static_cast<TItem>(1.3));
-    uniform_int_distribution<int> pointDistribution(0, NUMBER_OF_POINTS - 1);
+    double cost = z * centers;
+    for (int k = 0; k < n; ++k)
+        cost += points.costs[k];
+    return cost;
+}
+
+template <typename TItem>
+void StreamCluster::RecordHostGain(const StreamPoints<TItem>& points, int x, double z) {
+    const int n = points.count;
+    const int slots = static_cast<int>(_slotCenters.size());
+    vector<TItem> costs(n);
+    vector<int> assignments(n);
 
-    vector<Point<TItem>> points;
-    points.resize(NUMBER_OF_POINTS);
-    for (int i = 0; i < NUMBER_OF_POINTS; ++i) {
-        points[i].weight = weightDistribution(randomEngine); // should be value between 0.7 and 1.3
-        points[i].assign = pointDistribution(randomEngine); // another point id (random?)
-        points[i].cost = weightDistribution(randomEngine);
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueReadBuffer(*_costBuffer, CL_TRUE, 0, n * sizeof(TItem), &costs[0]);
+    status |= queue.enqueueReadBuffer(*_assignmentBuffer, CL_TRUE, 0, n * sizeof(cl_int), &assignments[0]);
+    CHECK(status);
+
+    // same bookkeeping as PGain and EvaluateGain in streamcluster.cl, scale is the magnitude of all summands
+    vector<double> sums(slots + 1, 0.0);
+    double scale = z;
+    for (int i = 0; i < n; ++i) {
+        const double xCost = Distance(points, i, x) * points.weights[i];
+        const double contribution = xCost < costs[i] ? xCost - costs[i] : costs[i] - xCost;
+        sums[xCost < costs[i] ? slots : _centerTable[assignments[i]]] += contribution;
+        scale += abs(contribution);
     }
 
-    vector<int> centerTable;
-    centerTable.resize(NUMBER_OF_POINTS, 0);
-    int count = 0;
-    for (int i = 0; i < NUMBER_OF_POINTS && count < MAXIMUM_CLUSTERS; ++i) {
-        if ( (i % 2) == 0 ) {
-            centerTable[i] = count++; 
+    double closedLower = 0.0;
+    for (int s = 0; s < slots; ++s) {
+        const double lower = z + sums[s];
+        if (_slotCenters[s] >= 0 && lower > 0.0) {
+            closedLower += lower;
+            scale += lower;
         }
     }
 
-    vector<char> zeroBuffer(NUMBER_OF_POINTS * MAXIMUM_CLUSTERS * sizeof(TItem), 0);
+    _hostGains.push_back(z + sums[slots] - closedLower);
+    _gainScales.push_back(scale);
+}
 
+template <typename TItem>
+double StreamCluster::PGain(StreamPoints<TItem>& points, int x, double z, int& centers) {
     cl::CommandQueue& queue = _controller->Queue();
-    queue.enqueueWriteBuffer(*_membershipBuffer, CL_TRUE, 0, NUMBER_OF_POINTS * sizeof(char), &zeroBuffer[0]);
-    queue.enqueueWriteBuffer(*_costBuffer, CL_TRUE, 0, NUMBER_OF_POINTS * MAXIMUM_CLUSTERS * sizeof(TItem), &zeroBuffer[0]);
-    queue.enqueueWriteBuffer(*_coordinatesBuffer, CL_TRUE, 0, NUMBER_OF_POINTS * POINT_DIMENSION * sizeof(TItem), &coordinates[0]);
-    queue.enqueueWriteBuffer(*_pointBuffer, CL_TRUE, 0, NUMBER_OF_POINTS * sizeof(Point<TItem>), &points[0]);
-    queue.enqueueWriteBuffer(*_centerTableBuffer, CL_TRUE, 0, NUMBER_OF_POINTS * sizeof(int), &centerTable[0]);
-    queue.finish();
-}
+    const int slots = static_cast<int>(_slotCenters.size());
+    const cl::NDRange local(WORK_GROUP_SIZE);
+    const cl::NDRange global(_groups * WORK_GROUP_SIZE);
+
+    if (_gainChecks > 0) {
+        Timer validationTimer;
+        RecordHostGain(points, x, z);
+        _validationTime += validationTimer.Diff();
+    }
 
-void StreamCluster::Execute() {
-    default_random_engine randomEngine(RANDOM_SEED);
-    uniform_int_distribution<int> pointDistribution(0, NUMBER_OF_POINTS - 1);
+    _gainKernel->setArg(11, x);
+    _gainKernel->setArg(12, slots);
+    _evaluateKernel->setArg(2, slots);
+    _evaluateKernel->setArg(4, static_cast<TItem>(z));
+    _applyKernel->setArg(7, x);
+
+    cl::Event events[3];
+    TItem result[2];
+    cl_int status = queue.enqueueNDRangeKernel(*_gainKernel, cl::NullRange, global, local, nullptr, &events[0]);
+    status |= queue.enqueueNDRangeKernel(*_evaluateKernel, cl::NullRange, local, local, nullptr, &events[1]);
+    status |= queue.enqueueReadBuffer(*_resultBuffer, CL_TRUE, 0, sizeof(result), result);
+    if (status != CL_SUCCESS) {
+        cerr << "Error " << status << " in " << __FILE__ << " on line: " << __LINE__ << endl;
+        return 0.0;
+    }
 
-    cl::CommandQueue& queue = _controller->Queue();
-    cl::NDRange local(_requestedWorkGroupSize);
-    cl::NDRange global(RoundToMultipleOf(NUMBER_OF_POINTS, _requestedWorkGroupSize));
-    cl::Event event;
-    cl_ulong startTime, endTime;
+    ++_pgainCalls;
+    const double openingCost = result[0];
+    if (_gainChecks > 0) {
+        _deviceGains.push_back(openingCost);
+        --_gainChecks;
+    }
+
+    const bool open = openingCost < 0.0;
+    vector<cl_char> closeCenters(slots);
+    if (open) {
+        status = queue.enqueueNDRangeKernel(*_applyKernel, cl::NullRange, global, local, nullptr, &events[2]);
+        status |= queue.enqueueReadBuffer(*_closeCenterBuffer, CL_TRUE, 0, slots * sizeof(cl_char), &closeCenters[0]);
+        if (status != CL_SUCCESS) {
+            cerr << "Error " << status << " in " << __FILE__ << " on line: " << __LINE__ << endl;
+            return 0.0;
+        }
+    }
 
-    _cpuStatistics.Clear();
-    _gpuStatistics.Clear();
+    for (int e = 0; e < (open ? 3 : 2); ++e) {
+        cl_ulong startTime = 0, endTime = 0;
+        events[e].getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
+        events[e].getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
+        _deviceTime += endTime - startTime;
+    }
 
-    for (int i = 0; i < TEST_ITERATIONS; ++i) {
-        cl_long randomPointId = pointDistribution(randomEngine);
-        _kernel->setArg(6, randomPointId);    // use a random point, in the original algorithm 
-                                              // this iterates over a list of feasible points
+    if (!open)
+        return 0.0;
 
-        _timer.Remember();
-        cl_int status = queue.enqueueNDRangeKernel(*_kernel, cl::NullRange, global, local, nullptr, &event);
-        WAIT_AND_CHECK(event, status);
-        _cpuStatistics.Add(_timer.Diff());
+    // close the unprofitable centers and open x, the points were already reassigned by ApplyGain
+    for (int s = 0; s < slots; ++s) {
+        if (closeCenters[s]) {
+            _isCenter[_slotCenters[s]] = 0;
+            _slotCenters[s] = -1;
+            _freeSlots.push_back(s);
+        }
+    }
+
+    if (!_isCenter[x]) {
+        int slot = static_cast<int>(_slotCenters.size());
+        if (_freeSlots.empty()) {
+            _slotCenters.push_back(x);
+        } else {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+            _slotCenters[slot] = x;
+        }
+        _isCenter[x] = 1;
+        _centerTable[x] = slot;
 
-        event.getProfilingInfo(CL_PROFILING_COMMAND_START, &startTime);
-        event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
-        _gpuStatistics.Add(endTime - startTime);
+        status = queue.enqueueWriteBuffer(*_centerTableBuffer, CL_TRUE, x * sizeof(cl_int), sizeof(cl_int), &_centerTable[x]);
+        if (status != CL_SUCCESS || EnsureSlotCapacity<TItem>() != 0)
+            return 0.0;
     }
 
-    // print sum instead of mean/deviation since that was what we started with
-    cout << " CPU: " << _cpuStatistics.Sum() << ", GPU: " << _gpuStatistics.Sum() << endl;
+    status = queue.enqueueWriteBuffer(*_slotCenterBuffer, CL_TRUE, 0, _slotCenters.size() * sizeof(cl_int), &_slotCenters[0]);
+    if (status != CL_SUCCESS)
+        return 0.0;
+
+    centers = static_cast<int>(_slotCenters.size() - _freeSlots.size());
+    return -openingCost;
 }
 
-void StreamCluster::Run() {
-    cout << "StreamCluster-Test:" << endl;
+template <typename TItem>
+double StreamCluster::PFL(StreamPoints<TItem>& points, vector<int>& feasible, double z, int& centers, double cost,
+                          int iterations, double e) {
+    double change = cost;
+
+    // continue until we run out of improvements
+    while (change / cost > e) {
+        change = 0.0;
+        shuffle(feasible.begin(), feasible.end(), _randomEngine);
+        for (int i = 0; i < iterations; ++i)
+            change += PGain(points, feasible[i % feasible.size()], z, centers);
+        cost -= change;
+    }
 
-    int workGroupSizes[] = { 32, 64, 128, /*192,*/ 256, 512 };
+    return cost;
+}
 
-    for (auto& workGroupSize : workGroupSizes) {
-        RequestWorkGroupSize(workGroupSize);
+template <typename TItem>
+double StreamCluster::LocalSearch(StreamPoints<TItem>& points, int& centers) {
+    const int n = points.count;
+
+    double hiz = 0.0;
+    for (int i = 0; i < n; ++i)
+        hiz += Distance(points, i, 0) * points.weights[i];
+    double loz = 0.0;
+    double z = (hiz + loz) / 2.0;
+
+    // every point is its own center
+    if (n <= KMAX) {
+        for (int i = 0; i < n; ++i) {
+            points.assignments[i] = i;
+            points.costs[i] = 0;
+        }
+        _isCenter.assign(n, 1);
+        centers = n;
+        return 0.0;
+    }
 
-        cout << "StreamCluster<float>,  WorkGroupSize: " << workGroupSize << ", ";
-        if (InitContext<float>() == 0) {
-            InitDeviceMemory<float>();
-            Execute();
-            Cleanup();
+    // the points are visited by pspeedy in random order
+    vector<int> order(n);
+    iota(order.begin(), order.end(), 0);
+    shuffle(order.begin(), order.end(), _randomEngine);
+    double cost = PSpeedy(points, order, z, centers);
+
+    // give speedy SP chances to get at least KMIN centers, afterwards assume that z is too high
+    int i = 0;
+    while (centers < KMIN && i < SP) {
+        cost = PSpeedy(points, order, z, centers);
+        ++i;
+    }
+    while (centers < KMIN) {
+        if (i >= SP) {
+            hiz = z;
+            z = (hiz + loz) / 2.0;
+            i = 0;
         }
+        shuffle(order.begin(), order.end(), _randomEngine);
+        cost = PSpeedy(points, order, z, centers);
+        ++i;
+    }
+
+    // candidates for new centers, sampled by weight
+    int feasibleCount = static_cast<int>(ITER * KMIN * log(static_cast<double>(KMIN)));
+    vector<int> feasible;
+    if (feasibleCount >= n) {
+        feasible.resize(n);
+        iota(feasible.begin(), feasible.end(), 0);
+    } else {
+        vector<double> accumulatedWeights(n);
+        partial_sum(points.weights.begin(), points.weights.end(), accumulatedWeights.begin());
+        uniform_real_distribution<double> weightDistribution(0.0, accumulatedWeights.back());
+        for (int f = 0; f < feasibleCount; ++f) {
+            const auto position = upper_bound(accumulatedWeights.begin(), accumulatedWeights.end(), weightDistribution(_randomEngine));
+            feasible.push_back(min(n - 1, static_cast<int>(position - accumulatedWeights.begin())));
+        }
+    }
+
+    // the solution is improved on the device
+    centers = UploadCenters(points);
+    if (centers < 0)
+        return cost;
+
+    const int iterations = static_cast<int>(ITER * KMAX * log(static_cast<double>(KMAX)));
+    while (true) {
+        cost = PFL(points, feasible, z, centers, cost, iterations, 0.1);
+
+        // if number of centers seems good, try a more accurate pFL
+        if ((centers <= 1.1 * KMAX && centers >= 0.9 * KMIN) || (centers <= KMAX + 2 && centers >= KMIN - 2))
+            cost = PFL(points, feasible, z, centers, cost, iterations, 0.001);
+
+        if (centers > KMAX) {
+            // facilities too cheap, increase z
+            loz = z;
+            z = (hiz + loz) / 2.0;
+            cost += (z - loz) * centers;
+        }
+        if (centers < KMIN) {
+            // facilities too expensive, decrease z
+            hiz = z;
+            z = (hiz + loz) / 2.0;
+            cost += (z - hiz) * centers;
+        }
+
+        // stop if the number of centers is in range or z can not be changed anymore
+        if ((centers <= KMAX && centers >= KMIN) || loz >= 0.999 * hiz)
+            break;
+    }
 
-        if (_controller->SupportsDoublePrecision()) {
-            cout << "StreamCluster<double>, WorkGroupSize: " << workGroupSize << ", ";
-            if (InitContext<double>() == 0) {
-                InitDeviceMemory<double>();
-                Execute();
-                Cleanup();
+    cl::CommandQueue& queue = _controller->Queue();
+    cl_int status = queue.enqueueReadBuffer(*_costBuffer, CL_TRUE, 0, n * sizeof(TItem), &points.costs[0]);
+    status |= queue.enqueueReadBuffer(*_assignmentBuffer, CL_TRUE, 0, n * sizeof(cl_int), &points.assignments[0]);
+    if (status != CL_SUCCESS)
+        cerr << "Error " << status << " in " << __FILE__ << " on line: " << __LINE__ << endl;
+
+    return cost;
+}
+
+template <typename TItem>
+void StreamCluster::ValidateAssignments(const string& testName, const StreamPoints<TItem>& points) {
+    Validate(testName, points.count, [&](int64_t i) -> bool {
+            const int center = points.assignments[i];
+            const TItem cost = static_cast<TItem>(Distance(points, static_cast<int>(i), center) * points.weights[i]);
+            return center >= 0 && center < points.count && _isCenter[center]
+                && WithinTolerance(points.costs[i], cost, ValidationTolerance<TItem>());
+        });
+}
+
+template <typename TItem>
+void StreamCluster::RunInternal(int pointCount, int chunkSize, int dimension) {
+    const string testName = string("StreamCluster") + (is_same<TItem, float>::value ? "<float>" : "<double>")
+        + ", " + to_string(pointCount) + " points in chunks of " + to_string(chunkSize) + ", " + to_string(dimension) + " dimensions";
+
+    _randomEngine.seed(RANDOM_SEED);
+    _pgainCalls = 0;
+    _deviceTime = 0;
+    _validationTime = 0;
+    _deviceGains.clear();
+    _hostGains.clear();
+    _gainScales.clear();
+
+    StreamPoints<TItem> centers;
+    centers.dimension = dimension;
+    int centerCount = 0;
+    double cost = 0.0;
+    int64_t generationTime = 0;
+
+    _timer.Remember();
+    for (int offset = 0; offset < pointCount; offset += chunkSize) {
+        // reading the stream is not part of the measurement
+        Timer generationTimer;
+        StreamPoints<TItem> chunk;
+        GenerateChunk(chunk, offset, min(chunkSize, pointCount - offset), dimension);
+        generationTime += generationTimer.Diff();
+
+        if (InitDeviceMemory(chunk) != 0)
+            return;
+        _gainChecks = ValidationEnabled() ? GAIN_CHECKS : 0;
+        LocalSearch(chunk, centerCount);
+
+        if (ValidationEnabled()) {
+            Timer validationTimer;
+            ValidateAssignments(testName + ", chunk " + to_string(offset / chunkSize) + " assignments", chunk);
+            _validationTime += validationTimer.Diff();
+        }
+
+        // contcenters: move every center to the weighted mean of its points
+        for (int i = 0; i < chunk.count; ++i) {
+            const int center = chunk.assignments[i];
+            if (center == i)
+                continue;
+
+            const TItem relativeWeight = chunk.weights[i] / (chunk.weights[center] + chunk.weights[i]);
+            for (int d = 0; d < dimension; ++d) {
+                TItem& coordinate = chunk.coordinates[static_cast<size_t>(center) * dimension + d];
+                coordinate = coordinate * (1 - relativeWeight) + chunk.coordinates[static_cast<size_t>(i) * dimension + d] * relativeWeight;
             }
+            chunk.weights[center] += chunk.weights[i];
+        }
+
+        // copycenters: the weighted centers of the chunk are part of the final point set
+        for (int i = 0; i < chunk.count; ++i) {
+            if (!_isCenter[i])
+                continue;
+
+            centers.coordinates.insert(centers.coordinates.end(), chunk.coordinates.begin() + static_cast<size_t>(i) * dimension,
+                chunk.coordinates.begin() + static_cast<size_t>(i + 1) * dimension);
+            centers.weights.push_back(chunk.weights[i]);
+            centers.costs.push_back(0);
+            centers.assignments.push_back(0);
+            ++centers.count;
+        }
+    }
+
+    // cluster the centers of all chunks
+    if (InitDeviceMemory(centers) != 0)
+        return;
+    _gainChecks = 0;
+    cost = LocalSearch(centers, centerCount);
+    const int64_t time = _timer.Diff() - _validationTime - generationTime;
+
+    ReleaseDeviceMemory();
+
+    cout << "  " << testName << ": " << (time > 0 ? 1000.0 * pointCount / time : 0.0) << " Mpoints/s ("
+        << time / 1000000 << " ms, " << _pgainCalls << " pgain calls, " << _deviceTime / 1000000 << " ms in kernels), "
+        << centerCount << " centers, cost " << cost << endl;
+
+    Validate(testName + ", gain", static_cast<int64_t>(_deviceGains.size()), [&](int64_t i) -> bool {
+            return abs(_deviceGains[i] - _hostGains[i]) <= ValidationTolerance<TItem>() * max(1.0, _gainScales[i]);
+        });
+}
+
+void StreamCluster::ReleaseDeviceMemory() {
+    _coordinatesBuffer.reset();
+    _weightBuffer.reset();
+    _costBuffer.reset();
+    _assignmentBuffer.reset();
+    _centerTableBuffer.reset();
+    _xCostBuffer.reset();
+    _switchMembershipBuffer.reset();
+    _partialsBuffer.reset();
+    _slotCenterBuffer.reset();
+    _closeCenterBuffer.reset();
+    _resultBuffer.reset();
+    _slotCapacity = 0;
+}
+
+void StreamCluster::Cleanup() {
+    ReleaseDeviceMemory();
+    _isCenter.clear();
+    _centerTable.clear();
+    _slotCenters.clear();
+    _freeSlots.clear();
+
+    _gainKernel.reset();
+    _evaluateKernel.reset();
+    _applyKernel.reset();
+    _program.reset();
+}
+
+void StreamCluster::Run() {
+    cout << "StreamCluster-Test (k = " << KMIN << " to " << KMAX << "):" << endl;
+
+    if (InitContext<float>() == 0) {
+        for (const auto& stream : STREAMS)
+            RunInternal<float>(stream[0], stream[1], stream[2]);
+    }
+    Cleanup();
+
+    if (_controller->SupportsDoublePrecision()) {
+        if (InitContext<double>() == 0) {
+            for (const auto& stream : STREAMS)
+                RunInternal<double>(stream[0], stream[1], stream[2]);
         }
+        Cleanup();
     }
 
     cout << endl;
@@ -3,39 +3,142 @@
 
 #include "../benchmarkbase.hpp"
 
+#include <cstdint>
 #include <memory>
+#include <random>
+#include <string>
+#include <vector>
 
 namespace benchmarks {
 
+template <typename TItem>
+struct StreamPoints;
+
 /**
  * Another clustering algorithm used in machine learning.
+ *
+ * Streaming k-median as in Rodinia/PARSEC streamcluster: the stream is read in chunks, every chunk is clustered
+ * by a local search (pspeedy for the initial solution, pFL improves it by opening and closing centers) and the
+ * weighted centers of all chunks are clustered again at the end. pgain, the evaluation of a candidate center,
+ * runs on the device: the cost of the candidate for every point, the reduction of the gains per center, the
+ * decision which centers are closed and the reassignment of the points. The host control loop only reads the
+ * resulting gain. The throughput is reported in points per second for the whole stream.
  */
 class StreamCluster : public BenchmarkBase {
 private:
-    std::shared_ptr<cl::Buffer> _pointBuffer = nullptr;
     std::shared_ptr<cl::Buffer> _coordinatesBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _weightBuffer = nullptr;
     std::shared_ptr<cl::Buffer> _costBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _assignmentBuffer = nullptr;
     std::shared_ptr<cl::Buffer> _centerTableBuffer = nullptr;
-    std::shared_ptr<cl::Buffer> _membershipBuffer = nullptr;
-    std::shared_ptr<cl::Kernel> _kernel = nullptr;
+    std::shared_ptr<cl::Buffer> _xCostBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _switchMembershipBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _partialsBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _slotCenterBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _closeCenterBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _resultBuffer = nullptr;
+    std::shared_ptr<cl::Kernel> _gainKernel = nullptr;
+    std::shared_ptr<cl::Kernel> _evaluateKernel = nullptr;
+    std::shared_ptr<cl::Kernel> _applyKernel = nullptr;
     std::shared_ptr<cl::Program> _program = nullptr;
 
+    std::default_random_engine _randomEngine;
+
+    // centers of the point set on the device: every center owns a slot, closed slots are reused
+    std::vector<char> _isCenter;
+    std::vector<int> _centerTable;      // point -> slot, valid for centers
+    std::vector<int> _slotCenters;      // slot -> point, -1 for closed slots
+    std::vector<int> _freeSlots;
+    int _slotCapacity = 0;
+    int _groups = 0;
+
+    // statistics and validation of the current stream
+    int64_t _pgainCalls = 0;
+    int64_t _deviceTime = 0;
+    int64_t _validationTime = 0;
+    int _gainChecks = 0;
+    std::vector<double> _deviceGains;
+    std::vector<double> _hostGains;
+    std::vector<double> _gainScales;
+
     /**
-     * Compile kernel, create buffers and set kernel arguments.
+     * Compile the kernels.
      */
     template <typename TItem>
     int InitContext();
 
     /**
-     * Initialize buffers and copy them to the target device.
+     * Create the buffers for a point set and copy its coordinates and weights to the device.
+     */
+    template <typename TItem>
+    int InitDeviceMemory(const StreamPoints<TItem>& points);
+
+    /**
+     * Derive the centers from the assignments, copy costs, assignments and centers to the device.
+     *
+     * @return number of centers
+     */
+    template <typename TItem>
+    int UploadCenters(const StreamPoints<TItem>& points);
+
+    /**
+     * Grow the buffers which hold one value per slot.
+     */
+    template <typename TItem>
+    int EnsureSlotCapacity();
+
+    /**
+     * pkmedian: cluster a point set into KMIN to KMAX centers. The costs and assignments of the points
+     * are updated on the host.
+     *
+     * @return cost of the solution
+     */
+    template <typename TItem>
+    double LocalSearch(StreamPoints<TItem>& points, int& centers);
+
+    /**
+     * Fast initial solution on the host, opens point i with probability cost(i) / z.
+     */
+    template <typename TItem>
+    double PSpeedy(StreamPoints<TItem>& points, const std::vector<int>& order, double z, int& centers);
+
+    /**
+     * Improve the solution on the device until the change drops below e (relative to the cost).
+     */
+    template <typename TItem>
+    double PFL(StreamPoints<TItem>& points, std::vector<int>& feasible, double z, int& centers, double cost,
+               int iterations, double e);
+
+    /**
+     * Open point x as a center if this reduces the cost, all centers which become unprofitable are closed.
+     *
+     * @return the saving, 0 if x is not opened
+     */
+    template <typename TItem>
+    double PGain(StreamPoints<TItem>& points, int x, double z, int& centers);
+
+    /**
+     * Host version of the gain computed by the device, used to validate the first calls of every point set.
+     */
+    template <typename TItem>
+    void RecordHostGain(const StreamPoints<TItem>& points, int x, double z);
+
+    /**
+     * Check that every point is assigned to an open center at the stored cost.
+     */
+    template <typename TItem>
+    void ValidateAssignments(const std::string& testName, const StreamPoints<TItem>& points);
+
+    /**
+     * Cluster a whole stream and print the throughput.
      */
     template <typename TItem>
-    void InitDeviceMemory();
+    void RunInternal(int pointCount, int chunkSize, int dimension);
 
     /**
-     * Execute the kernel a couple of times and generate statistics.
+     * Release the buffers of the current point set.
      */
-    void Execute();
+    void ReleaseDeviceMemory();
 
     /**
      * Release buffers, kernels and program instance.
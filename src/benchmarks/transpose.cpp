@@ -1,8 +1,9 @@
 #include "transpose.hpp"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
-#include <random>
+#include <vector>
 
 #include "../clglobal.hpp"
 #include "../computecontroller.hpp"
@@ -10,15 +11,30 @@
 using namespace benchmarks;
 using namespace std;
 
-// 8192 * 4096 * sizeof(float) = 128 MiB
-static const int MATRIX_WIDTH = 512;// 4096;
-static const int MATRIX_HEIGHT = 256;// 2048;
-static const int ITERATIONS = 100;
+// width x height, up to 32768 * 16384 * sizeof(cl_int) = 2 GiB per matrix
+static const int MATRIX_SIZES[][2] = {
+    { 4096, 2048 }, { 4096, 4096 }, { 5000, 3000 }, { 7680, 4320 }, { 8192, 4096 },
+    { 8192, 8192 }, { 16384, 8192 }, { 16384, 16384 }, { 32768, 16384 }
+};
+static const int ITERATIONS = 20;
+static const int WORK_GROUP_SIZE = 256;
 
-static const int BLOCK_DIMENSION = 16; // if you change, also update the define in transpose.cl
+// every program is compiled with one block size and one padding (-DBLOCK_DIMENSION, -DPADDING)
+static const int BLOCK_DIMENSIONS[] = { 16, 32 };
+static const int PADDINGS[] = { 0, 1 };
+static const int BLOCK_ROWS = 8;
+
+// the cycles are determined on the host and one work-item moves a whole cycle
+static const int64_t MAX_CYCLE_ELEMENTS = 1 << 26;
+static const int64_t MAX_CYCLE_LENGTH = 1 << 18;
+static const int CYCLE_WORK_GROUP_SIZE = 64;
+
+static const int PADDING_COUNT = sizeof(PADDINGS) / sizeof(PADDINGS[0]);
 
 Transpose::Transpose(std::shared_ptr<ComputeController> controller)
-    : BenchmarkBase(controller) {
+    : BenchmarkBase(controller)
+    , _programs()
+    , _results() {
 
 }
 
@@ -26,114 +42,322 @@ Transpose::~Transpose() {
 
 }
 
-template <typename TItem>
-void Transpose::GenerateInputData(int width, int height, TItem *buffer) {
-    for (int i = 0; i < width * height; ++i) {
-        buffer[i] = static_cast<TItem>(i);
+int Transpose::InitContext() {
+    // the values are indices of up to 2^29 elements, they are exact as int but not as float
+    _programs.clear();
+    for (const int blockDimension : BLOCK_DIMENSIONS) {
+        for (const int padding : PADDINGS) {
+            string compilerParams = GetCompilerFlags<cl_int>();
+            compilerParams += " -DBLOCK_DIMENSION=" + to_string(blockDimension);
+            compilerParams += " -DBLOCK_ROWS=" + to_string(BLOCK_ROWS);
+            compilerParams += " -DPADDING=" + to_string(padding);
+
+            auto program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "transpose.cl", compilerParams);
+            if (program.get() == nullptr)
+                return -1;
+            _programs.push_back(program);
+        }
     }
+
+    return 0;
 }
 
-int Transpose::InitContext() {
-    // compile program
-    string compilerParams = GetCompilerFlags<float>();
-    _program = _controller->BuildFromSource(CL_SRC_PATH_PREFIX + "transpose.cl", compilerParams);
+int Transpose::InitData(int width, int height) {
+    const int64_t elements = static_cast<int64_t>(width) * height;
+    const size_t bytes = elements * sizeof(cl_int);
+
+    cl_ulong maxAllocationSize = 0;
+    cl_ulong globalMemorySize = 0;
+    _controller->SelectedDevice().getInfo(CL_DEVICE_MAX_MEM_ALLOC_SIZE, &maxAllocationSize);
+    _controller->SelectedDevice().getInfo(CL_DEVICE_GLOBAL_MEM_SIZE, &globalMemorySize);
 
-    if (_program.get() == nullptr)
+    // input and output have to fit into three quarters of the device memory
+    if (bytes > maxAllocationSize || 4 * (2 * bytes) > 3 * globalMemorySize)
         return -1;
 
-    cl_int status = 0;
-    _transposeSimpleKernel = make_shared<cl::Kernel>(*_program, "transpose_simple", &status);
+    _width = width;
+    _height = height;
+    _copyBandwidth = DeviceCopyBandwidth(bytes);
+
+    cl_int status = CL_SUCCESS;
+    _inputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
     CHECK_RETURN_ERROR(status);
-    _transposeOptimizedKernel = make_shared<cl::Kernel>(*_program, "transpose_optimized", &status);
+    _outputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bytes, nullptr, &status);
     CHECK_RETURN_ERROR(status);
 
-    // initialize data structures
-    const int bufferSize = MATRIX_HEIGHT * MATRIX_WIDTH * sizeof(float);
-    _inputBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
-    _outputBuffer1 = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
-    _outputBuffer2 = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_WRITE, bufferSize);
+    // the input holds the index of every element, it is generated on the device to avoid a transfer of several GiB
+    cl::Kernel fillKernel(*_programs[0], "fill_index", &status);
+    CHECK_RETURN_ERROR(status);
+    fillKernel.setArg(0, *_inputBuffer);
+    fillKernel.setArg(1, static_cast<cl_ulong>(elements));
 
-    vector<float> buffer;
-    buffer.resize(MATRIX_HEIGHT * MATRIX_WIDTH);
-    GenerateInputData(MATRIX_WIDTH, MATRIX_HEIGHT, &buffer[0]);
-    _controller->Queue().enqueueWriteBuffer(*_inputBuffer, CL_TRUE, 0, bufferSize, static_cast<void*>(&buffer[0]));
+    const size_t global = (elements + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE * WORK_GROUP_SIZE;
+    status = _controller->Queue().enqueueNDRangeKernel(fillKernel, cl::NullRange, cl::NDRange(global), cl::NDRange(WORK_GROUP_SIZE));
+    CHECK_RETURN_ERROR(status);
+    status = _controller->Queue().finish();
+    CHECK_RETURN_ERROR(status);
 
-    // set kernel parameters
-    cl_int width = MATRIX_WIDTH;
-    cl_int height = MATRIX_HEIGHT;
+    return 0;
+}
 
-    _transposeSimpleKernel->setArg(0, *_inputBuffer);
-    _transposeSimpleKernel->setArg(1, *_outputBuffer1);
-    _transposeSimpleKernel->setArg(2, height);
-    _transposeSimpleKernel->setArg(3, width);
+void Transpose::ValidateOutput(const string& testName) {
+    if (!ValidationEnabled())
+        return;
 
-    _transposeOptimizedKernel->setArg(0, *_inputBuffer);
-    _transposeOptimizedKernel->setArg(1, *_outputBuffer2);
-    _transposeOptimizedKernel->setArg(2, height);
-    _transposeOptimizedKernel->setArg(3, width);
+    const int64_t items = static_cast<int64_t>(_width) * _height;
+    _results.resize(items);
 
-    return 0;
+    cl_int status = _controller->Queue().enqueueReadBuffer(*_outputBuffer, CL_TRUE, 0, items * sizeof(cl_int), &_results[0]);
+    CHECK(status);
+
+    // the input holds its own index, the output is a width x height matrix
+    const int64_t width = _width;
+    const int64_t height = _height;
+    ValidateResults(testName, &_results[0], items, [&](int64_t i) -> int32_t {
+            const int64_t row = i % height;
+            const int64_t column = i / height;
+            return static_cast<int32_t>(row * width + column);
+        });
 }
 
-void Transpose::Validate() {
-    // compare if output buffers are equal
-    const int items = MATRIX_HEIGHT * MATRIX_WIDTH;
-    const int bufferSize = items * sizeof(float);
-
-    vector<float> bufferSimple, bufferOptimized;
-    bufferSimple.resize(items);
-    bufferOptimized.resize(items);
-
-    cl::CommandQueue &queue = _controller->Queue();
-    queue.enqueueReadBuffer(*_outputBuffer1, CL_TRUE, 0, bufferSize, &bufferSimple[0]);
-    queue.enqueueReadBuffer(*_outputBuffer2, CL_TRUE, 0, bufferSize, &bufferOptimized[0]);
-    queue.finish();
-
-    for (int i = 0; i < items; ++i) {
-        if (bufferSimple[i] != bufferOptimized[i]) {
-            cerr << "Buffers are different at item " << i << ", bufferSimple[i]: " << bufferSimple[i]
-                << ", bufferOptimized[i]: " << bufferOptimized[i] << endl;
-            break;
-        }
-    }
+void Transpose::PrintBandwidth(const string& testName) {
+    const double time = _gpuStatistics.Mean();
+    if (time <= 0.0)
+        return;
+
+    // every element is read and written once
+    const double bandwidth = 2.0 * _width * _height * sizeof(cl_int) / time;
+    cout << "  " << testName << ": " << bandwidth << " GB/s";
+    if (_copyBandwidth > 0.0)
+        cout << " (" << 100.0 * bandwidth / _copyBandwidth << "% of copy bandwidth, " << _copyBandwidth << " GB/s)";
+    cout << endl;
 }
 
 void Transpose::RunSimple() {
     cl::CommandQueue& queue = _controller->Queue();
-    cl::Event event;
+    const int elements = _width * _height;
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel kernel(*_programs[0], "transpose_simple", &status);
+    CHECK(status);
+    kernel.setArg(0, *_inputBuffer);
+    kernel.setArg(1, *_outputBuffer);
+    kernel.setArg(2, _height);
+    kernel.setArg(3, _width);
+
+    cl::NDRange global(RoundToMultipleOf(elements, WORK_GROUP_SIZE));
+    cl::NDRange local(WORK_GROUP_SIZE);
+
+    string testName = "Transpose::RunSimple, " + to_string(_width) + "x" + to_string(_height);
+
+    // results of the previous run must not pass the validation
+    status = queue.enqueueFillBuffer(*_outputBuffer, -1, 0, static_cast<size_t>(_width) * _height * sizeof(cl_int));
+    CHECK(status);
+
+    // a failed launch leaves no event, PerformMultiPassTest stops and the error is reported here
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            events.resize(1);
+            status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+            if (status != CL_SUCCESS)
+                events.clear();
+        }, testName, ITERATIONS);
+    CHECK(status);
 
-    cl::NDRange global(MATRIX_WIDTH * MATRIX_HEIGHT);
+    PrintBandwidth(testName);
+    ValidateOutput(testName);
+}
 
-    string testName = "Transpose::RunSimple";
+void Transpose::RunOptimized(int config) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const int blockDimension = BLOCK_DIMENSIONS[config / PADDING_COUNT];
+    const int padding = PADDINGS[config % PADDING_COUNT];
+    const int tilesX = (_width + blockDimension - 1) / blockDimension;
+    const int tilesY = (_height + blockDimension - 1) / blockDimension;
+
+    // the vector kernel loads 4 consecutive elements, rows must not end within a vector
+    const bool vectorLoads = _width % 4 == 0 && _height % 4 == 0;
+    const string suffix = ", " + to_string(_width) + "x" + to_string(_height) + ", block " + to_string(blockDimension)
+        + ", padding " + to_string(padding);
+
+    for (int vectorWidth : { 1, 4 }) {
+        if (vectorWidth == 4 && !vectorLoads)
+            continue;
+
+        cl_int status = CL_SUCCESS;
+        cl::Kernel kernel(*_programs[config], vectorWidth == 1 ? "transpose_optimized" : "transpose_vector", &status);
+        CHECK(status);
+        kernel.setArg(0, *_inputBuffer);
+        kernel.setArg(1, *_outputBuffer);
+        kernel.setArg(2, _height);
+        kernel.setArg(3, _width);
+
+        cl::NDRange global(tilesX * blockDimension / vectorWidth, tilesY * BLOCK_ROWS);
+        cl::NDRange local(blockDimension / vectorWidth, BLOCK_ROWS);
+
+        string testName = string(vectorWidth == 1 ? "Transpose::RunOptimized" : "Transpose::RunVector") + suffix;
+
+        status = queue.enqueueFillBuffer(*_outputBuffer, -1, 0, static_cast<size_t>(_width) * _height * sizeof(cl_int));
+        CHECK(status);
+
+        PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+                events.resize(1);
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+                if (status != CL_SUCCESS)
+                    events.clear();
+            }, testName, ITERATIONS);
+        CHECK(status);
+
+        PrintBandwidth(testName);
+        ValidateOutput(testName);
+    }
+}
 
-    PerformTest([&](cl::Event &event) -> void {
-            queue.enqueueNDRangeKernel(*_transposeSimpleKernel, cl::NullRange, global, cl::NullRange, nullptr, &event);
+void Transpose::RunInPlaceSquare(int config) {
+    cl::CommandQueue& queue = _controller->Queue();
+    const int blockDimension = BLOCK_DIMENSIONS[config / PADDING_COUNT];
+    const int padding = PADDINGS[config % PADDING_COUNT];
+    const int tiles = (_width + blockDimension - 1) / blockDimension;
+    const size_t bytes = static_cast<size_t>(_width) * _height * sizeof(cl_int);
+
+    cl_int status = CL_SUCCESS;
+    cl::Kernel kernel(*_programs[config], "transpose_inplace_square", &status);
+    CHECK(status);
+    kernel.setArg(0, *_outputBuffer);
+    kernel.setArg(1, _width);
+
+    // the work-groups below the diagonal return immediately
+    cl::NDRange global(tiles * blockDimension, tiles * BLOCK_ROWS);
+    cl::NDRange local(blockDimension, BLOCK_ROWS);
+
+    string testName = "Transpose::RunInPlaceSquare, " + to_string(_width) + "x" + to_string(_height) + ", block "
+        + to_string(blockDimension) + ", padding " + to_string(padding);
+
+    // the matrix is restored before every iteration, only the transpose is timed
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            events.resize(1);
+            status = queue.enqueueCopyBuffer(*_inputBuffer, *_outputBuffer, 0, 0, bytes);
+            if (status == CL_SUCCESS)
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+            if (status != CL_SUCCESS)
+                events.clear();
         }, testName, ITERATIONS);
+    CHECK(status);
+
+    PrintBandwidth(testName);
+    ValidateOutput(testName);
 }
 
-void Transpose::RunOptimized() {
+void Transpose::RunInPlaceCycles() {
     cl::CommandQueue& queue = _controller->Queue();
-    cl::Event event;
+    const int64_t elements = static_cast<int64_t>(_width) * _height;
+    const size_t bytes = elements * sizeof(cl_int);
+    string testName = "Transpose::RunInPlaceCycles, " + to_string(_width) + "x" + to_string(_height);
 
-    cl::NDRange local(16, 16);
-    cl::NDRange global(MATRIX_WIDTH, MATRIX_HEIGHT);
+    if (elements > MAX_CYCLE_ELEMENTS) {
+        cout << "  " << testName << ": skipped, more than " << MAX_CYCLE_ELEMENTS << " elements" << endl;
+        return;
+    }
 
-    string testName = "Transpose::RunOptimized";
+    // the first and the last element stay in place, the smallest index of every other cycle is its leader
+    vector<cl_uint> leaders;
+    vector<bool> visited(elements, false);
+    const int64_t modulus = elements - 1;
+    int64_t longestCycle = 0;
+    for (int64_t i = 1; i < modulus; ++i) {
+        if (visited[i])
+            continue;
+
+        leaders.push_back(static_cast<cl_uint>(i));
+        int64_t length = 0;
+        int64_t index = i;
+        do {
+            visited[index] = true;
+            index = index * _height % modulus;
+            ++length;
+        } while (index != i);
+        longestCycle = max(longestCycle, length);
+    }
+    visited.clear();
 
-    PerformTest([&](cl::Event &event) -> void {
-            queue.enqueueNDRangeKernel(*_transposeOptimizedKernel, cl::NullRange, global, local, nullptr, &event);
+    // a single work-item moves all elements of a cycle, long cycles serialize the whole transpose
+    if (longestCycle > MAX_CYCLE_LENGTH) {
+        cout << "  " << testName << ": skipped, " << leaders.size() << " cycles, the longest one has "
+            << longestCycle << " elements" << endl;
+        return;
+    }
+
+    cl_int status = CL_SUCCESS;
+    _leaderBuffer = make_shared<cl::Buffer>(_controller->Context(), CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR,
+        leaders.size() * sizeof(cl_uint), &leaders[0], &status);
+    CHECK(status);
+
+    const int cycles = static_cast<int>(leaders.size());
+    cl::Kernel kernel(*_programs[0], "transpose_inplace_cycles", &status);
+    CHECK(status);
+    kernel.setArg(0, *_outputBuffer);
+    kernel.setArg(1, *_leaderBuffer);
+    kernel.setArg(2, cycles);
+    kernel.setArg(3, _height);
+    kernel.setArg(4, _width);
+
+    cl::NDRange global(RoundToMultipleOf(cycles, CYCLE_WORK_GROUP_SIZE));
+    cl::NDRange local(CYCLE_WORK_GROUP_SIZE);
+
+    testName += ", " + to_string(cycles) + " cycles, longest " + to_string(longestCycle);
+
+    PerformMultiPassTest([&](vector<cl::Event>& events) -> void {
+            events.resize(1);
+            status = queue.enqueueCopyBuffer(*_inputBuffer, *_outputBuffer, 0, 0, bytes);
+            if (status == CL_SUCCESS)
+                status = queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &events[0]);
+            if (status != CL_SUCCESS)
+                events.clear();
         }, testName, ITERATIONS);
+    CHECK(status);
+
+    PrintBandwidth(testName);
+    ValidateOutput(testName);
+
+    _leaderBuffer.reset();
 }
 
+void Transpose::ReleaseData() {
+    _inputBuffer.reset();
+    _outputBuffer.reset();
+    _leaderBuffer.reset();
+    _results.clear();
+    _results.shrink_to_fit();
+}
+
+void Transpose::Cleanup() {
+    ReleaseData();
+    _programs.clear();
+}
 
 void Transpose::Run() {
     cout << "Transpose-Tests: " << endl;
 
     if (InitContext() == 0) {
-        RunSimple();
-        RunOptimized();
-        Validate();
+        for (const auto& size : MATRIX_SIZES) {
+            if (InitData(size[0], size[1]) != 0) {
+                cout << "  " << size[0] << "x" << size[1] << ": skipped, the matrix does not fit into the device memory" << endl;
+                ReleaseData();
+                continue;
+            }
+
+            RunSimple();
+            for (size_t config = 0; config < _programs.size(); ++config) {
+                RunOptimized(static_cast<int>(config));
+                if (_width == _height)
+                    RunInPlaceSquare(static_cast<int>(config));
+            }
+            if (_width != _height)
+                RunInPlaceCycles();
+
+            ReleaseData();
+        }
     }
+    Cleanup();
 
     cout << endl;
-}
\ No newline at end of file
+}
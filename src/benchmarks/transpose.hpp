@@ -3,34 +3,53 @@
 
 #include "../benchmarkbase.hpp"
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace benchmarks {
 
 /**
- * Transposes a matrix on an OpenCL device.
+ * Transposes matrices of up to several GiB on an OpenCL device. The tiled kernels are compiled for every
+ * combination of block size and local memory padding, the padding avoids bank conflicts when the columns
+ * of a tile are read. Besides the out-of-place kernels (naive, tiled, tiled with vector loads) square
+ * matrices are transposed in-place by swapping tiles and non-square matrices by following the cycles
+ * of the permutation. The bandwidth (read and write) is reported relative to a device copy of the same size.
  */
 class Transpose : public BenchmarkBase {
 private:
     std::shared_ptr<cl::Buffer> _inputBuffer = nullptr;
-    std::shared_ptr<cl::Buffer> _outputBuffer1 = nullptr;
-    std::shared_ptr<cl::Buffer> _outputBuffer2 = nullptr;
-    std::shared_ptr<cl::Kernel> _transposeSimpleKernel = nullptr;
-    std::shared_ptr<cl::Kernel> _transposeOptimizedKernel = nullptr;
-    std::shared_ptr<cl::Program> _program = nullptr;
+    std::shared_ptr<cl::Buffer> _outputBuffer = nullptr;
+    std::shared_ptr<cl::Buffer> _leaderBuffer = nullptr;
+    std::vector<std::shared_ptr<cl::Program>> _programs;
 
-    template <typename TItem>
-    void GenerateInputData(int width, int height, TItem *buffer);
+    int _width = 0;
+    int _height = 0;
+    double _copyBandwidth = 0.0;
+    std::vector<int32_t> _results;
 
     /**
-     * Compile kernel, create buffers, initialize data.
+     * Compile the program once for every block size and padding.
      */
     int InitContext();
 
     /**
-     * Compare the result of both Run*() methods.
+     * Create the buffers for a width x height matrix and fill the input with the index of every element.
+     *
+     * @return 0 on success, otherwise the matrix does not fit into the device memory
      */
-    void Validate();
+    int InitData(int width, int height);
+
+    /**
+     * Compare the output buffer with the transposed input.
+     */
+    void ValidateOutput(const std::string& testName);
+
+    /**
+     * Print the bandwidth of the last test relative to the copy bandwidth.
+     */
+    void PrintBandwidth(const std::string& testName);
 
     /**
      * Execute a naive implementation of transpose.
@@ -38,10 +57,35 @@ private:
     void RunSimple();
 
     /**
-     * Execute an optimized version of tranpose. 
-     * (It uses local memory and work-group barriers).
+     * Execute the tiled versions of transpose with scalar and vector loads.
+     * (They use local memory and work-group barriers).
+     *
+     * @param config index of the program (block size and padding)
+     */
+    void RunOptimized(int config);
+
+    /**
+     * Transpose a square matrix in-place, every work-group swaps two tiles.
+     *
+     * @param config index of the program (block size and padding)
+     */
+    void RunInPlaceSquare(int config);
+
+    /**
+     * Transpose a non-square matrix in-place, every work-item follows one cycle of the permutation.
+     * The cycles are determined on the host once per matrix size.
+     */
+    void RunInPlaceCycles();
+
+    /**
+     * Release the buffers of the current matrix.
+     */
+    void ReleaseData();
+
+    /**
+     * Release the buffers and the programs.
      */
-    void RunOptimized();
+    void Cleanup();
 
 public:
     explicit Transpose(std::shared_ptr<ComputeController> controller);
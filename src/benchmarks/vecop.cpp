@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <random>
+#include <type_traits>
 #include <vector>
 
 #include "../clglobal.hpp"
@@ -10,6 +11,25 @@
 using namespace benchmarks;
 using namespace std;
 
+// host reference of the vecadd.cl kernels, integer overflow wraps around like on the device
+template <typename TItem>
+static TItem ReferenceOperation(const string& vectorOperation, TItem a, TItem b, true_type /* integral */) {
+    if (vectorOperation == "vecadd")
+        return static_cast<TItem>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    if (vectorOperation == "vecmul")
+        return static_cast<TItem>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    return a / b;
+}
+
+template <typename TItem>
+static TItem ReferenceOperation(const string& vectorOperation, TItem a, TItem b, false_type /* integral */) {
+    if (vectorOperation == "vecadd")
+        return a + b;
+    if (vectorOperation == "vecmul")
+        return a * b;
+    return a / b;
+}
+
 template<typename TItem>
 void Vecop::RunInternal(const string& vectorOperation) {
     string compilerParams = GetCompilerFlags<TItem>();
@@ -68,6 +88,10 @@ void Vecop::RunInternal(const string& vectorOperation) {
     event.getProfilingInfo(CL_PROFILING_COMMAND_END, &endTime);
 
     cout << "CPU: " << timeCPU << ", GPU: " << (endTime - startTime) << endl;
+
+    ValidateResults(vectorOperation, &output[0], elements, [&](int64_t i) -> TItem {
+            return ReferenceOperation(vectorOperation, inputA[i], inputB[i], is_integral<TItem>());
+        });
 }
 
 void Vecop::Run() {
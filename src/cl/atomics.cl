@@ -0,0 +1,92 @@
+#ifdef VTYPE_INT
+#define VTYPE int
+#elif VTYPE_LONG
+#pragma OPENCL EXTENSION cl_khr_int64_base_atomics: enable
+#define VTYPE long
+#elif VTYPE_FLOAT
+#define VTYPE float
+#else
+#error No data type defined.
+#endif
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+#ifdef VTYPE_FLOAT
+// OpenCL 1.2 has no float atomics, the addition is emulated with a compare-and-swap loop on the bit pattern
+inline void AtomicAddFloatGlobal(volatile __global float* p, float value) {
+    int old = as_int(*p);
+    int assumed;
+    do {
+        assumed = old;
+        old = atomic_cmpxchg((volatile __global int*)p, assumed, as_int(as_float(assumed) + value));
+    } while (old != assumed);
+}
+
+inline void AtomicAddFloatLocal(volatile __local float* p, float value) {
+    int old = as_int(*p);
+    int assumed;
+    do {
+        assumed = old;
+        old = atomic_cmpxchg((volatile __local int*)p, assumed, as_int(as_float(assumed) + value));
+    } while (old != assumed);
+}
+
+#define ADD_GLOBAL(p, value) AtomicAddFloatGlobal(p, value)
+#define ADD_LOCAL(p, value) AtomicAddFloatLocal(p, value)
+#elif VTYPE_LONG
+#define ADD_GLOBAL(p, value) atom_add(p, value)
+#define ADD_LOCAL(p, value) atom_add(p, value)
+#define INC(p) atom_inc(p)
+#define CMPXCHG(p, compare, value) atom_cmpxchg(p, compare, value)
+#else
+#define ADD_GLOBAL(p, value) atomic_add(p, value)
+#define ADD_LOCAL(p, value) atomic_add(p, value)
+#define INC(p) atomic_inc(p)
+#define CMPXCHG(p, compare, value) atomic_cmpxchg(p, compare, value)
+#endif
+
+// increment with a compare-and-swap loop, retries until no other work-item changed the value in between
+#define CAS_INCREMENT(p) { \
+    VTYPE old = *(p); \
+    VTYPE assumed; \
+    do { \
+        assumed = old; \
+        old = CMPXCHG(p, assumed, assumed + 1); \
+    } while (old != assumed); \
+}
+
+// Every work-item executes operations atomic increments on counters[id % addresses]. The number of
+// addresses controls the contention: one address means all work-items update the same counter.
+//   NAME##Global: the counters in global memory are updated directly
+//   NAME##Local:  privatization, every work-group updates its own copy of the counters in local memory
+//                 and adds it to the global counters at the end (addresses <= WORK_GROUP_SIZE)
+#define ATOMIC_KERNELS(NAME, GLOBAL_OPERATION, LOCAL_OPERATION) \
+__kernel void NAME##Global(volatile __global VTYPE* counters, const int addresses, const int operations) { \
+    volatile __global VTYPE* counter = counters + get_global_id(0) % addresses; \
+    for (int i = 0; i < operations; ++i) \
+        GLOBAL_OPERATION; \
+} \
+\
+__kernel void NAME##Local(volatile __global VTYPE* counters, const int addresses, const int operations) { \
+    __local VTYPE privateCounters[WORK_GROUP_SIZE]; \
+    int lid = get_local_id(0); \
+    privateCounters[lid] = 0; \
+    barrier(CLK_LOCAL_MEM_FENCE); \
+\
+    volatile __local VTYPE* counter = privateCounters + lid % addresses; \
+    for (int i = 0; i < operations; ++i) \
+        LOCAL_OPERATION; \
+    barrier(CLK_LOCAL_MEM_FENCE); \
+\
+    if (lid < addresses) \
+        ADD_GLOBAL(counters + lid, privateCounters[lid]); \
+}
+
+ATOMIC_KERNELS(AtomicAdd, ADD_GLOBAL(counter, (VTYPE)1), ADD_LOCAL(counter, (VTYPE)1))
+
+#ifndef VTYPE_FLOAT
+ATOMIC_KERNELS(AtomicInc, INC(counter), INC(counter))
+ATOMIC_KERNELS(AtomicCmpxchg, CAS_INCREMENT(counter), CAS_INCREMENT(counter))
+#endif
@@ -4,7 +4,7 @@ Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
 Redistribution and use in source and binary forms, with or without modification,
 are permitted provided that the following conditions are met:
 
-* Redistributions of source code must retain the above copyright notice, 
+* Redistributions of source code must retain the above copyright notice,
   this list of conditions and the following disclaimer.
 * Redistributions in binary form must reproduce the above copyright notice,
   this list of conditions and the following disclaimer in the documentation and/or
@@ -27,188 +27,100 @@ POSSIBILITY OF SUCH DAMAGE.
  * documentation for this sample.
  *
  * On invocation of kernel blackScholes, each work thread calculates call price
- * and put price values for given stoke price, option strike price, 
+ * and put price values for given stoke price, option strike price,
  * time to expiration date, risk free interest and volatility factor.
+ *
+ * The options are stored as structure of arrays, the kernels are compiled for float or double (VTYPE).
  */
 
-#define S_LOWER_LIMIT 10.0f
-#define S_UPPER_LIMIT 100.0f
-#define K_LOWER_LIMIT 10.0f
-#define K_UPPER_LIMIT 100.0f
-#define T_LOWER_LIMIT 1.0f
-#define T_UPPER_LIMIT 10.0f
-#define R_LOWER_LIMIT 0.01f
-#define R_UPPER_LIMIT 0.05f
-#define SIGMA_LOWER_LIMIT 0.01f
-#define SIGMA_UPPER_LIMIT 0.10f
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#define VTYPE4 float4
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#define VTYPE4 double4
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#define VTYPE4 double4
+#endif
 
 /**
- * @brief   Abromowitz Stegun approxmimation for PHI (Cumulative Normal Distribution Function)
- * @param   X input value
- * @param   phi pointer to store calculated CND of X
+ * @brief   Cumulative normal distribution function
+ *          erfc is accurate to a few ulp in both precisions, unlike the Abramowitz Stegun polynomial
+ *          (absolute error 7.5e-8) which limits double precision results.
  */
-void phi(float4 X, float4* phi)
-{
-    float4 y;
-    float4 absX;
-    float4 t;
-    float4 result;
-
-    const float4 c1 = (float4)0.319381530f;
-    const float4 c2 = (float4)-0.356563782f;
-    const float4 c3 = (float4)1.781477937f;
-    const float4 c4 = (float4)-1.821255978f;
-    const float4 c5 = (float4)1.330274429f;
-
-    const float4 zero = (float4)0.0f;
-    const float4 one = (float4)1.0f;
-    const float4 two = (float4)2.0f;
-    const float4 temp4 = (float4)0.2316419f;
-
-    const float4 oneBySqrt2pi = (float4)0.398942280f;
-
-    absX = fabs(X);
-    t = one/(one + temp4 * absX);
-
-    y = one - oneBySqrt2pi * exp(-X*X/two) * t 
-        * (c1 + t
-              * (c2 + t
-                    * (c3 + t
-                          * (c4 + t * c5))));
-
-    result = (X < zero)? (one - y) : y;
+#define CND(X) ((VTYPE)0.5 * erfc((X) * (VTYPE)-0.70710678118654752440))
 
-    *phi = result;
-}
+/*
+ * @brief   Calculates the call and put price of option i, TYPE is VTYPE or VTYPE4
+ */
+#define BLACK_SCHOLES(TYPE, i)                                                      \
+    {                                                                               \
+        TYPE S = spot[i];                                                           \
+        TYPE K = strike[i];                                                         \
+        TYPE T = time[i];                                                           \
+        TYPE R = rate[i];                                                           \
+        TYPE sigmaVal = volatility[i];                                              \
+                                                                                    \
+        TYPE sigmaSqrtT = sigmaVal * sqrt(T);                                       \
+        TYPE d1 = (log(S / K) + (R + (VTYPE)0.5 * sigmaVal * sigmaVal) * T)         \
+            / sigmaSqrtT;                                                           \
+        TYPE d2 = d1 - sigmaSqrtT;                                                  \
+        TYPE KexpMinusRT = K * exp(-R * T);                                         \
+                                                                                    \
+        call[i] = S * CND(d1) - KexpMinusRT * CND(d2);                              \
+        put[i] = KexpMinusRT * CND(-d2) - S * CND(-d1);                             \
+    }
 
 /*
- * @brief   Calculates the call and put prices by using Black Scholes model
- * @param   s       Array of random values of current option price
- * @param   sigma   Array of random values sigma
- * @param   k       Array of random values strike price
- * @param   t       Array of random values of expiration time
- * @param   r       Array of random values of risk free interest rate
- * @param   width   Width of call price or put price array
- * @param   call    Array of calculated call price values
- * @param   put     Array of calculated put price values
+ * @brief   Calculates the call and put prices by using Black Scholes model, four options per work-item
+ * @param   spot        Array of current prices of the underlying
+ * @param   strike      Array of strike prices
+ * @param   time        Array of times to expiration in years
+ * @param   rate        Array of risk free interest rates
+ * @param   volatility  Array of volatilities
+ * @param   call        Array of calculated call price values
+ * @param   put         Array of calculated put price values
+ * @param   n           Number of vectors (options / 4)
  */
-__kernel 
+__kernel
 void
-blackScholes(const __global float4 *randArray,
-             int width,
-             __global float4 *call,
-             __global float4 *put)
+blackScholes(const __global VTYPE4 *spot,
+             const __global VTYPE4 *strike,
+             const __global VTYPE4 *time,
+             const __global VTYPE4 *rate,
+             const __global VTYPE4 *volatility,
+             __global VTYPE4 *call,
+             __global VTYPE4 *put,
+             int n)
 {
-    float4 d1, d2;
-    float4 phiD1, phiD2;
-    float4 sigmaSqrtT;
-    float4 KexpMinusRT;
-    
-    size_t xPos = get_global_id(0);
-    size_t yPos = get_global_id(1);
-    float4 two = (float4)2.0f;
-    float4 inRand = randArray[yPos * width + xPos];
-    float4 S = S_LOWER_LIMIT * inRand + S_UPPER_LIMIT * (1.0f - inRand);
-    float4 K = K_LOWER_LIMIT * inRand + K_UPPER_LIMIT * (1.0f - inRand);
-    float4 T = T_LOWER_LIMIT * inRand + T_UPPER_LIMIT * (1.0f - inRand);
-    float4 R = R_LOWER_LIMIT * inRand + R_UPPER_LIMIT * (1.0f - inRand);
-    float4 sigmaVal = SIGMA_LOWER_LIMIT * inRand + SIGMA_UPPER_LIMIT * (1.0f - inRand);
-
+    int i = get_global_id(0);
+    if (i >= n)
+        return;
 
-    sigmaSqrtT = sigmaVal * sqrt(T);
-
-    d1 = (log(S/K) + (R + sigmaVal * sigmaVal / two)* T)/ sigmaSqrtT;
-    d2 = d1 - sigmaSqrtT;
-
-    KexpMinusRT = K * exp(-R * T);
-    phi(d1, &phiD1);
-    phi(d2, &phiD2);
-    call[yPos * width + xPos] = S * phiD1 - KexpMinusRT * phiD2;
-    phi(-d1, &phiD1);
-    phi(-d2, &phiD2);
-    put[yPos * width + xPos]  = KexpMinusRT * phiD2 - S * phiD1;
-}
-
-void phi_scalar(float X, float* phi)
-{
-    float y;
-    float absX;
-    float t;
-    float result;
-
-    const float c1 = (float)0.319381530f;
-    const float c2 = (float)-0.356563782f;
-    const float c3 = (float)1.781477937f;
-    const float c4 = (float)-1.821255978f;
-    const float c5 = (float)1.330274429f;
-
-    const float zero = (float)0.0f;
-    const float one = (float)1.0f;
-    const float two = (float)2.0f;
-    const float temp4 = (float)0.2316419f;
-
-    const float oneBySqrt2pi = (float)0.398942280f;
-
-    absX = fabs(X);
-    t = one/(one + temp4 * absX);
-
-    y = one - oneBySqrt2pi * exp(-X*X/two) * t 
-        * (c1 + t
-              * (c2 + t
-                    * (c3 + t
-                          * (c4 + t * c5))));
-
-    result = (X < zero)? (one - y) : y;
-
-    *phi = result;
+    BLACK_SCHOLES(VTYPE4, i)
 }
 
 /*
- * @brief   Calculates the call and put prices by using Black Scholes model
- * @param   s       Array of random values of current option price
- * @param   sigma   Array of random values sigma
- * @param   k       Array of random values strike price
- * @param   t       Array of random values of expiration time
- * @param   r       Array of random values of risk free interest rate
- * @param   width   Width of call price or put price array
- * @param   call    Array of calculated call price values
- * @param   put     Array of calculated put price values
+ * @brief   Calculates the call and put prices by using Black Scholes model, one option per work-item
+ * @param   n           Number of options
  */
-__kernel 
+__kernel
 void
-blackScholes_scalar(const __global float *randArray,
-             int width,
-             __global float *call,
-             __global float *put)
+blackScholes_scalar(const __global VTYPE *spot,
+                    const __global VTYPE *strike,
+                    const __global VTYPE *time,
+                    const __global VTYPE *rate,
+                    const __global VTYPE *volatility,
+                    __global VTYPE *call,
+                    __global VTYPE *put,
+                    int n)
 {
-    float d1, d2;
-    float phiD1, phiD2;
-    float sigmaSqrtT;
-    float KexpMinusRT;
-    
-    size_t xPos = get_global_id(0);
-    size_t yPos = get_global_id(1);
-    float two = (float)2.0f;
-    float inRand = randArray[yPos * width + xPos];
-    float S = S_LOWER_LIMIT * inRand + S_UPPER_LIMIT * (1.0f - inRand);
-    float K = K_LOWER_LIMIT * inRand + K_UPPER_LIMIT * (1.0f - inRand);
-    float T = T_LOWER_LIMIT * inRand + T_UPPER_LIMIT * (1.0f - inRand);
-    float R = R_LOWER_LIMIT * inRand + R_UPPER_LIMIT * (1.0f - inRand);
-    float sigmaVal = SIGMA_LOWER_LIMIT * inRand + SIGMA_UPPER_LIMIT * (1.0f - inRand);
-
-
-    sigmaSqrtT = sigmaVal * sqrt(T);
+    int i = get_global_id(0);
+    if (i >= n)
+        return;
 
-    d1 = (log(S/K) + (R + sigmaVal * sigmaVal / two)* T)/ sigmaSqrtT;
-    d2 = d1 - sigmaSqrtT;
-
-    KexpMinusRT = K * exp(-R * T);
-    phi_scalar(d1, &phiD1);
-    phi_scalar(d2, &phiD2);
-    call[yPos * width + xPos] = S * phiD1 - KexpMinusRT * phiD2;
-    phi_scalar(-d1, &phiD1);
-    phi_scalar(-d2, &phiD2);
-    put[yPos * width + xPos]  = KexpMinusRT * phiD2 - S * phiD1;
+    BLACK_SCHOLES(VTYPE, i)
 }
-
-
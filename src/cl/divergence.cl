@@ -0,0 +1,93 @@
+// Control flow divergence: every element takes one of two paths of equal cost, flags[i] != 0 selects the taken path.
+// The host controls the fraction of taken branches and their spatial coherence (random or clustered flags).
+//   DivergenceBranchy:    if/else, work-items of a SIMD unit with different flags execute both paths
+//   DivergencePredicated: both paths are computed by every work-item, the result is selected (no divergence)
+//   PartitionByBranch + DivergenceSorted: the indices are partitioned by their flag first, only the SIMD unit
+//                         at the border between the two partitions diverges
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+// two different dependency chains of the same length, both stay within [0, 1) for inputs in [0, 1)
+inline float PathTaken(float x, const int work) {
+    for (int i = 0; i < work; ++i)
+        x = mad(x, 0.75f, 0.125f);
+    return x;
+}
+
+inline float PathNotTaken(float x, const int work) {
+    for (int i = 0; i < work; ++i)
+        x = mad(x, -0.5f, 0.75f);
+    return x;
+}
+
+__kernel void DivergenceBranchy(__global const float* values, __global const int* flags, __global float* output,
+                const int n, const int work) {
+    int i = get_global_id(0);
+    if (i >= n)
+        return;
+
+    float x = values[i];
+    if (flags[i])
+        x = PathTaken(x, work);
+    else
+        x = PathNotTaken(x, work);
+    output[i] = x;
+}
+
+__kernel void DivergencePredicated(__global const float* values, __global const int* flags, __global float* output,
+                const int n, const int work) {
+    int i = get_global_id(0);
+    if (i >= n)
+        return;
+
+    float x = values[i];
+    float taken = PathTaken(x, work);
+    float notTaken = PathNotTaken(x, work);
+    output[i] = select(notTaken, taken, flags[i] != 0);
+}
+
+// Writes the indices of the taken elements to the front of indices and the others to the back (in reverse order).
+// counters[0] and counters[1] count the elements which were not taken and taken, they have to be zero initially.
+// Every work-group reserves its ranges with one atomic operation per partition.
+__kernel void PartitionByBranch(__global const int* flags, __global int* indices, volatile __global int* counters, const int n) {
+    __local int localCounts[2];
+    __local int localBase[2];
+
+    int i = get_global_id(0);
+    int lid = get_local_id(0);
+
+    if (lid < 2)
+        localCounts[lid] = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int flag = i < n ? (flags[i] != 0) : -1;
+    int position = flag >= 0 ? atomic_inc(localCounts + flag) : 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (lid < 2)
+        localBase[lid] = atomic_add(counters + lid, localCounts[lid]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (flag == 1)
+        indices[localBase[1] + position] = i;
+    else if (flag == 0)
+        indices[n - 1 - (localBase[0] + position)] = i;
+}
+
+// processes the elements in the order of PartitionByBranch, the first counters[1] of them are taken
+__kernel void DivergenceSorted(__global const float* values, __global const int* indices, __global const int* counters,
+                __global float* output, const int n, const int work) {
+    int i = get_global_id(0);
+    if (i >= n)
+        return;
+
+    int index = indices[i];
+    float x = values[index];
+    if (i < counters[1])
+        x = PathTaken(x, work);
+    else
+        x = PathNotTaken(x, work);
+    output[index] = x;
+}
@@ -17,7 +17,7 @@ __kernel void find_edge_pixels(__global float *image, __global int *steepnessBuf
 
 	unsigned int bufferPos = (y + 1) * width + 1 + x;
 
-	if (bufferPos >= widthReduced * heightReduced)
+	if (pixelId >= widthReduced * heightReduced)
 		return;
 
 	float pixelValue = image[bufferPos];
@@ -65,7 +65,7 @@ __kernel void find_edge_pixels_optimized(__global float *image, __global int *st
 
 	unsigned int bufferPos = (y + 1) * width + 1 + x;
 
-	if (bufferPos >= widthReduced * heightReduced)
+	if (pixelId >= widthReduced * heightReduced)
 		return;
 
 	float pixelValue = image[bufferPos];
@@ -0,0 +1,234 @@
+// Stockham autosort FFT for power-of-two sizes.
+// Every pass of radix R reads the elements j + k * n / R (k < R), applies the twiddle factors,
+// computes a R-point DFT and writes the results to (j / ns) * ns * R + j % ns + k * ns, where ns
+// is the product of the radices of all previous passes. The output is naturally ordered, no
+// bit-reversal step is required. sign is -1 for forward and +1 for inverse transforms (unscaled).
+
+#ifdef VTYPE_FLOAT
+#define T float
+#define T2 float2
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define T double
+#define T2 double2
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define T double
+#define T2 double2
+#else
+#error No precision defined.
+#endif
+
+#ifndef LOCAL_FFT_MAX
+#define LOCAL_FFT_MAX 1024
+#endif
+
+#define TRANSPOSE_TILE 16
+
+#define PI_VALUE ((T)3.14159265358979323846)
+#define SQRT1_2_VALUE ((T)0.70710678118654752440)
+
+inline T2 ComplexMul(T2 a, T2 b) {
+    return (T2)(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+}
+
+// a * (sign * i)
+inline T2 MulI(T2 a, T sign) {
+    return (T2)(-sign * a.y, sign * a.x);
+}
+
+inline void Fft2(T2* v) {
+    T2 t = v[0];
+    v[0] = t + v[1];
+    v[1] = t - v[1];
+}
+
+inline void Fft4(T2* v0, T2* v1, T2* v2, T2* v3, T sign) {
+    T2 t0 = *v0 + *v2;
+    T2 t1 = *v0 - *v2;
+    T2 t2 = *v1 + *v3;
+    T2 t3 = MulI(*v1 - *v3, sign);
+    *v0 = t0 + t2;
+    *v1 = t1 + t3;
+    *v2 = t0 - t2;
+    *v3 = t1 - t3;
+}
+
+inline void Fft8(T2* v, T sign) {
+    // two 4-point DFTs on the even and odd elements, combined with the 8th roots of unity
+    T2 e0 = v[0], e1 = v[2], e2 = v[4], e3 = v[6];
+    T2 o0 = v[1], o1 = v[3], o2 = v[5], o3 = v[7];
+    Fft4(&e0, &e1, &e2, &e3, sign);
+    Fft4(&o0, &o1, &o2, &o3, sign);
+
+    o1 = (T2)(SQRT1_2_VALUE * (o1.x - sign * o1.y), SQRT1_2_VALUE * (o1.y + sign * o1.x));
+    o2 = MulI(o2, sign);
+    o3 = (T2)(SQRT1_2_VALUE * (-o3.x - sign * o3.y), SQRT1_2_VALUE * (-o3.y + sign * o3.x));
+
+    v[0] = e0 + o0; v[4] = e0 - o0;
+    v[1] = e1 + o1; v[5] = e1 - o1;
+    v[2] = e2 + o2; v[6] = e2 - o2;
+    v[3] = e3 + o3; v[7] = e3 - o3;
+}
+
+inline void Butterfly(T2* v, const int radix, T sign) {
+    if (radix == 8)
+        Fft8(v, sign);
+    else if (radix == 4)
+        Fft4(&v[0], &v[1], &v[2], &v[3], sign);
+    else
+        Fft2(v);
+}
+
+inline void Twiddle(T2* v, const int radix, int j, int ns, T sign) {
+    T angle = sign * 2 * PI_VALUE * (j % ns) / (ns * radix);
+    for (int k = 1; k < radix; ++k) {
+        T c;
+        T s = sincos(k * angle, &c);
+        v[k] = ComplexMul(v[k], (T2)(c, s));
+    }
+}
+
+// one pass over global memory, dimension 0 enumerates the butterflies, dimension 1 the batch
+inline void StockhamPass(__global const T2* in, __global T2* out, const int radix, const int n, const int ns, T sign) {
+    int j = get_global_id(0);
+    if (j >= n / radix)
+        return;
+
+    in += get_global_id(1) * n;
+    out += get_global_id(1) * n;
+
+    T2 v[8];
+    for (int k = 0; k < radix; ++k)
+        v[k] = in[j + k * (n / radix)];
+
+    Twiddle(v, radix, j, ns, sign);
+    Butterfly(v, radix, sign);
+
+    int idxD = (j / ns) * ns * radix + (j % ns);
+    for (int k = 0; k < radix; ++k)
+        out[idxD + k * ns] = v[k];
+}
+
+__kernel void StockhamRadix2(__global const T2* in, __global T2* out, const int n, const int ns, T sign) {
+    StockhamPass(in, out, 2, n, ns, sign);
+}
+
+__kernel void StockhamRadix4(__global const T2* in, __global T2* out, const int n, const int ns, T sign) {
+    StockhamPass(in, out, 4, n, ns, sign);
+}
+
+__kernel void StockhamRadix8(__global const T2* in, __global T2* out, const int n, const int ns, T sign) {
+    StockhamPass(in, out, 8, n, ns, sign);
+}
+
+// complete transform of n <= LOCAL_FFT_MAX elements in local memory, one work-group per transform
+__kernel void StockhamLocal(__global const T2* in, __global T2* out, const int n, T sign) {
+    __local T2 buffers[2 * LOCAL_FFT_MAX];
+    __local T2* src = buffers;
+    __local T2* dst = buffers + LOCAL_FFT_MAX;
+
+    int lid = get_local_id(0);
+    int lsz = get_local_size(0);
+    in += get_group_id(0) * n;
+    out += get_group_id(0) * n;
+
+    for (int i = lid; i < n; i += lsz)
+        src[i] = in[i];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int ns = 1; ns < n; ) {
+        int radix = ((n / ns) % 8 == 0) ? 8 : (((n / ns) % 4 == 0) ? 4 : 2);
+
+        for (int j = lid; j < n / radix; j += lsz) {
+            T2 v[8];
+            for (int k = 0; k < radix; ++k)
+                v[k] = src[j + k * (n / radix)];
+
+            Twiddle(v, radix, j, ns, sign);
+            Butterfly(v, radix, sign);
+
+            int idxD = (j / ns) * ns * radix + (j % ns);
+            for (int k = 0; k < radix; ++k)
+                dst[idxD + k * ns] = v[k];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        __local T2* tmp = src;
+        src = dst;
+        dst = tmp;
+        ns *= radix;
+    }
+
+    for (int i = lid; i < n; i += lsz)
+        out[i] = src[i];
+}
+
+// out = transpose(in), in is a rows x cols matrix in row-major order
+__kernel void TransposeComplex(__global const T2* in, __global T2* out, const int rows, const int cols) {
+    __local T2 tile[TRANSPOSE_TILE][TRANSPOSE_TILE + 1];
+
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int column = get_global_id(0);
+    int row = get_global_id(1);
+
+    if (row < rows && column < cols)
+        tile[ly][lx] = in[row * cols + column];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // the output tile is the mirrored tile, its rows correspond to the input columns
+    int outColumn = get_group_id(1) * TRANSPOSE_TILE + lx;
+    int outRow = get_group_id(0) * TRANSPOSE_TILE + ly;
+
+    if (outRow < cols && outColumn < rows)
+        out[outRow * rows + outColumn] = tile[lx][ly];
+}
+
+// Real transforms of length n = 2 * m: the real input is read as m complex values z[k] = x[2k] + i x[2k + 1]
+// and transformed with a complex FFT of length m. The post-processing step untangles the spectra of the
+// even and odd elements and produces the m + 1 non-redundant values of the Hermitian spectrum:
+//   X[k] = (Z[k] + conj(Z[m - k])) / 2 - i/2 * W^k * (Z[k] - conj(Z[m - k])),  W = exp(-2 pi i / n), Z[m] = Z[0]
+// dimension 0 enumerates k (0..m), dimension 1 the batch
+__kernel void RealPostProcess(__global const T2* z, __global T2* spectrum, const int m) {
+    int k = get_global_id(0);
+    if (k > m)
+        return;
+
+    z += get_global_id(1) * m;
+    spectrum += get_global_id(1) * (m + 1);
+
+    T2 a = z[k % m];
+    T2 b = z[(m - k) % m];
+    b.y = -b.y;
+
+    T2 even = (T)0.5 * (a + b);
+    T2 odd = (T)0.5 * (a - b);
+
+    T c;
+    T s = sincos(-PI_VALUE * k / m, &c);
+    spectrum[k] = even + MulI(ComplexMul(odd, (T2)(c, s)), (T)-1);
+}
+
+// Inverse of RealPostProcess: builds the m complex values Z[k] = E[k] + i O[k] from the Hermitian spectrum
+//   E[k] = X[k] + conj(X[m - k]),  O[k] = (X[k] - conj(X[m - k])) * W^-k
+// An unscaled inverse FFT of length m then yields n * x in the packed layout (same scaling as the complex path).
+__kernel void RealPreProcess(__global const T2* spectrum, __global T2* z, const int m) {
+    int k = get_global_id(0);
+    if (k >= m)
+        return;
+
+    spectrum += get_global_id(1) * (m + 1);
+    z += get_global_id(1) * m;
+
+    T2 a = spectrum[k];
+    T2 b = spectrum[m - k];
+    b.y = -b.y;
+
+    T c;
+    T s = sincos(PI_VALUE * k / m, &c);
+    z[k] = (a + b) + MulI(ComplexMul(a - b, (T2)(c, s)), (T)1);
+}
@@ -0,0 +1,98 @@
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+#ifndef PRIVATE_BINS
+#define PRIVATE_BINS 256
+#endif
+
+// The input values are mapped to bins with min(value >> shift, bins - 1): for keys with a known number of bits
+// the shift keeps the most significant bits, with shift = 0 the values are bin indices and large values saturate
+// in the last bin. All kernels process the input with a grid-stride loop over dimension 0.
+inline uint BinOf(uint value, int shift, int bins) {
+    return min(value >> shift, (uint)(bins - 1));
+}
+
+// every work-item increments the bins directly in global memory, the histogram has to be zeroed before
+__kernel void HistogramGlobal(__global const uint* values, const int n, const int shift, const int bins,
+                volatile __global uint* histogram) {
+    for (int i = get_global_id(0); i < n; i += get_global_size(0))
+        atomic_inc(histogram + BinOf(values[i], shift, bins));
+}
+
+// Privatization: every work-group counts into its own histogram in local memory and writes it to its row of
+// partials (groups x bins), HistogramMerge adds up the rows. If the bins do not fit into local memory, dimension 1
+// splits them into chunks of chunkBins: every chunk reads the complete input and counts only the values of its bins.
+__kernel void HistogramLocal(__global const uint* values, const int n, const int shift, const int bins,
+                volatile __local uint* localBins, const int chunkBins, __global uint* partials) {
+    int lid = get_local_id(0);
+    uint offset = get_group_id(1) * chunkBins;
+
+    for (int i = lid; i < chunkBins; i += WORK_GROUP_SIZE)
+        localBins[i] = 0;
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int i = get_global_id(0); i < n; i += get_global_size(0)) {
+        uint bin = BinOf(values[i], shift, bins) - offset;
+        if (bin < (uint)chunkBins)
+            atomic_inc(localBins + bin);
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    partials += get_group_id(0) * bins + offset;
+    for (int i = lid; i < chunkBins; i += WORK_GROUP_SIZE)
+        partials[i] = localBins[i];
+}
+
+// Every work-item counts into a sub-histogram of PRIVATE_BINS in private memory, no atomics are required while
+// the input is processed. The sub-histograms are added up in local memory and written to the partials like in
+// HistogramLocal. The array is indexed dynamically, most compilers place it in (cached) scratch memory.
+// Bin counts above PRIVATE_BINS are split into chunks over dimension 1.
+__kernel void HistogramPrivate(__global const uint* values, const int n, const int shift, const int bins,
+                __global uint* partials) {
+    volatile __local uint groupBins[PRIVATE_BINS];
+    uint counts[PRIVATE_BINS];
+
+    int lid = get_local_id(0);
+    uint offset = get_group_id(1) * PRIVATE_BINS;
+
+    for (int i = 0; i < PRIVATE_BINS; ++i)
+        counts[i] = 0;
+    for (int i = lid; i < PRIVATE_BINS; i += WORK_GROUP_SIZE)
+        groupBins[i] = 0;
+
+    for (int i = get_global_id(0); i < n; i += get_global_size(0)) {
+        uint bin = BinOf(values[i], shift, bins) - offset;
+        if (bin < PRIVATE_BINS)
+            ++counts[bin];
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int i = 0; i < PRIVATE_BINS; ++i) {
+        // start at different bins to spread the work-items over the local memory banks
+        int bin = (i + lid) % PRIVATE_BINS;
+        if (counts[bin] > 0)
+            atomic_add(groupBins + bin, counts[bin]);
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    partials += get_group_id(0) * bins + offset;
+    for (int i = lid; i < PRIVATE_BINS; i += WORK_GROUP_SIZE)
+        partials[i] = groupBins[i];
+}
+
+// histogram[bin] = sum of partials[group * bins + bin] over all groups, one work-item per bin
+__kernel void HistogramMerge(__global const uint* partials, const int groups, const int bins, __global uint* histogram) {
+    int bin = get_global_id(0);
+    if (bin >= bins)
+        return;
+
+    uint sum = 0;
+    for (int group = 0; group < groups; ++group)
+        sum += partials[group * bins + bin];
+    histogram[bin] = sum;
+}
@@ -0,0 +1,256 @@
+// Image filters on single channel float images of width x height pixels, stored row by row.
+// Every filter exists in two variants:
+//   *Image: the input is an image object read through a sampler (texture cache, hardware border handling)
+//   *Tiled: the input is a buffer, every work-group loads its tile including the halo into local memory
+// Pixels outside of the image are clamped to the nearest border pixel in both variants.
+// The work-groups are BLOCK_X x BLOCK_Y work-items, one work-item per output pixel.
+
+#ifndef BLOCK_X
+#define BLOCK_X 16
+#endif
+
+#ifndef BLOCK_Y
+#define BLOCK_Y 16
+#endif
+
+#ifndef MAX_RADIUS
+#define MAX_RADIUS 4
+#endif
+
+#define TILE_SIZE_MAX ((BLOCK_X + 2 * MAX_RADIUS) * (BLOCK_Y + 2 * MAX_RADIUS))
+
+// the four gradient directions of the non-maximum suppression
+#define DIRECTION_HORIZONTAL 0
+#define DIRECTION_DIAGONAL 1      // gx and gy have the same sign
+#define DIRECTION_VERTICAL 2
+#define DIRECTION_ANTIDIAGONAL 3  // gx and gy have different signs
+
+// tan(22.5 degrees) and tan(67.5 degrees)
+#define TAN_22_5 0.41421356f
+#define TAN_67_5 2.41421356f
+
+#define CLASS_NONE 0
+#define CLASS_WEAK 1
+#define CLASS_STRONG 2
+
+// ---------------------------------------------------------------------------------------------------
+// filter definitions, FETCH(dx, dy) returns the input pixel at the offset (dx, dy) of the current pixel
+
+#define SOBEL(FETCH, gx, gy) \
+    gx = (FETCH(1, -1) + 2.0f * FETCH(1, 0) + FETCH(1, 1)) - (FETCH(-1, -1) + 2.0f * FETCH(-1, 0) + FETCH(-1, 1)); \
+    gy = (FETCH(-1, 1) + 2.0f * FETCH(0, 1) + FETCH(1, 1)) - (FETCH(-1, -1) + 2.0f * FETCH(0, -1) + FETCH(1, -1));
+
+#define ROWS(FETCH, weights, radius, result) \
+    result = 0.0f; \
+    for (int d = -radius; d <= radius; ++d) \
+        result += weights[d + radius] * FETCH(d, 0);
+
+#define COLUMNS(FETCH, weights, radius, result) \
+    result = 0.0f; \
+    for (int d = -radius; d <= radius; ++d) \
+        result += weights[d + radius] * FETCH(0, d);
+
+#define CONVOLUTION(FETCH, filter, radius, result) \
+    result = 0.0f; \
+    for (int dy = -radius; dy <= radius; ++dy) \
+        for (int dx = -radius; dx <= radius; ++dx) \
+            result += filter[(dy + radius) * (2 * radius + 1) + dx + radius] * FETCH(dx, dy);
+
+inline uchar GradientDirection(float gx, float gy) {
+    float ax = fabs(gx);
+    float ay = fabs(gy);
+    if (ay <= TAN_22_5 * ax)
+        return DIRECTION_HORIZONTAL;
+    if (ay >= TAN_67_5 * ax)
+        return DIRECTION_VERTICAL;
+    return (gx > 0.0f) == (gy > 0.0f) ? DIRECTION_DIAGONAL : DIRECTION_ANTIDIAGONAL;
+}
+
+// ---------------------------------------------------------------------------------------------------
+// local memory tiles
+
+inline float ClampedPixel(__global const float* image, int x, int y, int width, int height) {
+    return image[clamp(y, 0, height - 1) * width + clamp(x, 0, width - 1)];
+}
+
+// loads the pixels of the work-group with a halo of rx columns and ry rows on each side,
+// all work-items have to call it (including the ones beyond the image border)
+inline void LoadTile(__local float* tile, __global const float* image, int width, int height, int rx, int ry) {
+    int tileWidth = BLOCK_X + 2 * rx;
+    int tileSize = tileWidth * (BLOCK_Y + 2 * ry);
+    int x0 = get_group_id(0) * BLOCK_X - rx;
+    int y0 = get_group_id(1) * BLOCK_Y - ry;
+
+    for (int i = get_local_id(1) * BLOCK_X + get_local_id(0); i < tileSize; i += BLOCK_X * BLOCK_Y)
+        tile[i] = ClampedPixel(image, x0 + i % tileWidth, y0 + i / tileWidth, width, height);
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+#define TILE_FETCH(dx, dy) tile[(ty + (dy)) * tileWidth + tx + (dx)]
+
+// declares the tile and loads it, returns for work-items beyond the image
+#define TILED_PROLOGUE(rx, ry) \
+    __local float tile[TILE_SIZE_MAX]; \
+    int x = get_global_id(0); \
+    int y = get_global_id(1); \
+    int tileWidth = BLOCK_X + 2 * (rx); \
+    int tx = get_local_id(0) + (rx); \
+    int ty = get_local_id(1) + (ry); \
+    LoadTile(tile, input, width, height, rx, ry); \
+    if (x >= width || y >= height) \
+        return;
+
+__kernel void SobelTiled(__global const float* input, __global float* output, const int width, const int height) {
+    TILED_PROLOGUE(1, 1)
+
+    float gx, gy;
+    SOBEL(TILE_FETCH, gx, gy)
+    output[y * width + x] = sqrt(gx * gx + gy * gy);
+}
+
+__kernel void GaussianRowsTiled(__global const float* input, __global float* output, __constant float* weights,
+                const int radius, const int width, const int height) {
+    TILED_PROLOGUE(radius, 0)
+
+    float result;
+    ROWS(TILE_FETCH, weights, radius, result)
+    output[y * width + x] = result;
+}
+
+__kernel void GaussianColumnsTiled(__global const float* input, __global float* output, __constant float* weights,
+                const int radius, const int width, const int height) {
+    TILED_PROLOGUE(0, radius)
+
+    float result;
+    COLUMNS(TILE_FETCH, weights, radius, result)
+    output[y * width + x] = result;
+}
+
+__kernel void ConvolutionTiled(__global const float* input, __global float* output, __constant float* filter,
+                const int radius, const int width, const int height) {
+    TILED_PROLOGUE(radius, radius)
+
+    float result;
+    CONVOLUTION(TILE_FETCH, filter, radius, result)
+    output[y * width + x] = result;
+}
+
+__kernel void CannyGradientTiled(__global const float* input, __global float* magnitude, __global uchar* direction,
+                const int width, const int height) {
+    TILED_PROLOGUE(1, 1)
+
+    float gx, gy;
+    SOBEL(TILE_FETCH, gx, gy)
+    magnitude[y * width + x] = sqrt(gx * gx + gy * gy);
+    direction[y * width + x] = GradientDirection(gx, gy);
+}
+
+// ---------------------------------------------------------------------------------------------------
+// image objects, only available if the device supports images
+
+#ifdef __IMAGE_SUPPORT__
+
+__constant sampler_t clampSampler = CLK_NORMALIZED_COORDS_FALSE | CLK_ADDRESS_CLAMP_TO_EDGE | CLK_FILTER_NEAREST;
+
+#define IMAGE_FETCH(dx, dy) read_imagef(input, clampSampler, (int2)(x + (dx), y + (dy))).x
+
+#define IMAGE_PROLOGUE \
+    int x = get_global_id(0); \
+    int y = get_global_id(1); \
+    if (x >= width || y >= height) \
+        return;
+
+#define IMAGE_STORE(value) write_imagef(output, (int2)(x, y), (float4)(value, 0.0f, 0.0f, 1.0f))
+
+__kernel void SobelImage(__read_only image2d_t input, __write_only image2d_t output, const int width, const int height) {
+    IMAGE_PROLOGUE
+
+    float gx, gy;
+    SOBEL(IMAGE_FETCH, gx, gy)
+    IMAGE_STORE(sqrt(gx * gx + gy * gy));
+}
+
+__kernel void GaussianRowsImage(__read_only image2d_t input, __write_only image2d_t output, __constant float* weights,
+                const int radius, const int width, const int height) {
+    IMAGE_PROLOGUE
+
+    float result;
+    ROWS(IMAGE_FETCH, weights, radius, result)
+    IMAGE_STORE(result);
+}
+
+__kernel void GaussianColumnsImage(__read_only image2d_t input, __write_only image2d_t output, __constant float* weights,
+                const int radius, const int width, const int height) {
+    IMAGE_PROLOGUE
+
+    float result;
+    COLUMNS(IMAGE_FETCH, weights, radius, result)
+    IMAGE_STORE(result);
+}
+
+__kernel void ConvolutionImage(__read_only image2d_t input, __write_only image2d_t output, __constant float* filter,
+                const int radius, const int width, const int height) {
+    IMAGE_PROLOGUE
+
+    float result;
+    CONVOLUTION(IMAGE_FETCH, filter, radius, result)
+    IMAGE_STORE(result);
+}
+
+__kernel void CannyGradientImage(__read_only image2d_t input, __global float* magnitude, __global uchar* direction,
+                const int width, const int height) {
+    IMAGE_PROLOGUE
+
+    float gx, gy;
+    SOBEL(IMAGE_FETCH, gx, gy)
+    magnitude[y * width + x] = sqrt(gx * gx + gy * gy);
+    direction[y * width + x] = GradientDirection(gx, gy);
+}
+
+#endif // __IMAGE_SUPPORT__
+
+// ---------------------------------------------------------------------------------------------------
+// remaining Canny stages, shared by both variants
+
+// non-maximum suppression along the gradient direction and double threshold
+__kernel void CannySuppress(__global const float* magnitude, __global const uchar* direction, __global uchar* classes,
+                const float lowThreshold, const float highThreshold, const int width, const int height) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    if (x >= width || y >= height)
+        return;
+
+    int dx = 1, dy = 0;
+    switch (direction[y * width + x]) {
+        case DIRECTION_DIAGONAL: dx = 1; dy = 1; break;
+        case DIRECTION_VERTICAL: dx = 0; dy = 1; break;
+        case DIRECTION_ANTIDIAGONAL: dx = 1; dy = -1; break;
+    }
+
+    float m = magnitude[y * width + x];
+    float before = ClampedPixel(magnitude, x - dx, y - dy, width, height);
+    float after = ClampedPixel(magnitude, x + dx, y + dy, width, height);
+
+    uchar result = CLASS_NONE;
+    if (m >= before && m >= after)
+        result = m >= highThreshold ? CLASS_STRONG : (m >= lowThreshold ? CLASS_WEAK : CLASS_NONE);
+    classes[y * width + x] = result;
+}
+
+// single hysteresis step: strong pixels and weak pixels next to a strong pixel are edges (1.0)
+__kernel void CannyHysteresis(__global const uchar* classes, __global float* edges, const int width, const int height) {
+    int x = get_global_id(0);
+    int y = get_global_id(1);
+    if (x >= width || y >= height)
+        return;
+
+    uchar c = classes[y * width + x];
+    bool edge = c == CLASS_STRONG;
+    if (c == CLASS_WEAK) {
+        for (int ny = max(y - 1, 0); ny <= min(y + 1, height - 1); ++ny)
+            for (int nx = max(x - 1, 0); nx <= min(x + 1, width - 1); ++nx)
+                edge = edge || classes[ny * width + nx] == CLASS_STRONG;
+    }
+    edges[y * width + x] = edge ? 1.0f : 0.0f;
+}
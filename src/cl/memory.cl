@@ -119,4 +119,36 @@ void read_from_buffer_row_major(__global VTYPE *buffer, __global VTYPE *target,
     }
 
     target[displacement] = sum;
-}
\ No newline at end of file
+}
+// Copy with a strided read: work-item i reads element (i * stride) mod length + (i * stride) / length.
+// For power of two strides and lengths this is a permutation, every element is read exactly once.
+__kernel
+void read_strided(__global const VTYPE *buffer, __global VTYPE *target, uint stride, uint length, uint lengthBits) {
+    __private ulong position = (ulong)get_global_id(0) * stride;
+    __private uint index = (uint)(position & (length - 1)) + (uint)(position >> lengthBits);
+
+    target[get_global_id(0)] = buffer[index];
+}
+
+__kernel
+void gather(__global const VTYPE *buffer, __global const uint *indices, __global VTYPE *target) {
+    target[get_global_id(0)] = buffer[indices[get_global_id(0)]];
+}
+
+__kernel
+void scatter(__global const VTYPE *source, __global const uint *indices, __global VTYPE *target) {
+    target[indices[get_global_id(0)]] = source[get_global_id(0)];
+}
+
+// Dependent loads over a cyclic list, chain[i] is the index of the next element. A single work-item
+// follows the list so that every load has to wait for the previous one: time / steps is the latency.
+__kernel
+void pointer_chase(__global const uint *chain, __global uint *result, int steps) {
+    __private uint index = 0;
+
+    for (int i = 0; i < steps; ++i) {
+        index = chain[index];
+    }
+
+    result[0] = index;
+}
@@ -0,0 +1,170 @@
+// Monte Carlo pricing of European and arithmetic Asian call options.
+//   Random numbers: Philox4x32-10 (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3"), a counter-based
+//                   generator, the counter is (path, block of four normals, 0, 0) and the key (seed, option). Every
+//                   path can be generated independently of all others, no generator state is stored.
+//   Normal transform: Box-Muller, four uniforms give four standard normals.
+//   Reduction: every work-group reduces the payoffs and their squares of its paths, ReducePartials sums the
+//              partial results of an option.
+// The options are stored as structure of arrays, dimension 1 of the NDRange is the option.
+
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#endif
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+#define PHILOX_M0 0xD2511F53u
+#define PHILOX_M1 0xCD9E8D57u
+#define PHILOX_W0 0x9E3779B9u
+#define PHILOX_W1 0xBB67AE85u
+
+#define TWO_PI ((VTYPE)6.28318530717958647693)
+
+inline uint4 Philox4x32(uint4 counter, uint2 key) {
+    for (int round = 0; round < 10; ++round) {
+        if (round > 0) {
+            key.x += PHILOX_W0;
+            key.y += PHILOX_W1;
+        }
+
+        uint hi0 = mul_hi(PHILOX_M0, counter.x);
+        uint lo0 = PHILOX_M0 * counter.x;
+        uint hi1 = mul_hi(PHILOX_M1, counter.z);
+        uint lo1 = PHILOX_M1 * counter.z;
+        counter = (uint4)(hi1 ^ counter.y ^ key.x, lo1, hi0 ^ counter.w ^ key.y, lo0);
+    }
+    return counter;
+}
+
+// maps 32 random bits to (0, 1], zero would break the logarithm of Box-Muller
+inline VTYPE Uniform(uint bits) {
+    return (VTYPE)bits * (VTYPE)2.3283064365386963e-10 + (VTYPE)1.1641532182693481e-10;
+}
+
+inline void BoxMuller(uint4 bits, VTYPE* normals) {
+    VTYPE radius = sqrt((VTYPE)-2.0 * log(Uniform(bits.x)));
+    VTYPE angle = TWO_PI * Uniform(bits.y);
+    normals[0] = radius * cos(angle);
+    normals[1] = radius * sin(angle);
+
+    radius = sqrt((VTYPE)-2.0 * log(Uniform(bits.z)));
+    angle = TWO_PI * Uniform(bits.w);
+    normals[2] = radius * cos(angle);
+    normals[3] = radius * sin(angle);
+}
+
+// reduces sum and sumOfSquares of the work-group, partials[2 * i] and partials[2 * i + 1] with
+// i = option * groups + group receive the result
+inline void StorePartials(VTYPE sum, VTYPE sumOfSquares, __local VTYPE* localSums, __local VTYPE* localSquares,
+                __global VTYPE* partials) {
+    int lid = get_local_id(0);
+    localSums[lid] = sum;
+    localSquares[lid] = sumOfSquares;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = WORK_GROUP_SIZE / 2; offset > 0; offset >>= 1) {
+        if (lid < offset) {
+            localSums[lid] += localSums[lid + offset];
+            localSquares[lid] += localSquares[lid + offset];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (lid == 0) {
+        int index = get_global_id(1) * get_num_groups(0) + get_group_id(0);
+        partials[2 * index] = localSums[0];
+        partials[2 * index + 1] = localSquares[0];
+    }
+}
+
+// payoff max(S_T - K, 0) of a European call, S_T is drawn directly from the lognormal distribution
+__kernel void MonteCarloEuropean(__global const VTYPE* spot, __global const VTYPE* strike, __global const VTYPE* time,
+                __global const VTYPE* rate, __global const VTYPE* volatility, const int paths, const uint seed,
+                __global VTYPE* partials) {
+    __local VTYPE localSums[WORK_GROUP_SIZE];
+    __local VTYPE localSquares[WORK_GROUP_SIZE];
+
+    int option = get_global_id(1);
+    VTYPE S = spot[option];
+    VTYPE K = strike[option];
+    VTYPE T = time[option];
+    VTYPE sigma = volatility[option];
+    VTYPE drift = (rate[option] - (VTYPE)0.5 * sigma * sigma) * T;
+    VTYPE diffusion = sigma * sqrt(T);
+    uint2 key = (uint2)(seed, (uint)option);
+
+    VTYPE sum = 0, sumOfSquares = 0;
+    for (int path = get_global_id(0); path < paths; path += get_global_size(0)) {
+        VTYPE normals[4];
+        BoxMuller(Philox4x32((uint4)((uint)path, 0, 0, 0), key), normals);
+
+        VTYPE payoff = fmax(S * exp(drift + diffusion * normals[0]) - K, (VTYPE)0);
+        sum += payoff;
+        sumOfSquares += payoff * payoff;
+    }
+
+    StorePartials(sum, sumOfSquares, localSums, localSquares, partials);
+}
+
+// payoff max(A - K, 0) of an Asian call, A is the arithmetic average of the prices at steps equidistant times
+__kernel void MonteCarloAsian(__global const VTYPE* spot, __global const VTYPE* strike, __global const VTYPE* time,
+                __global const VTYPE* rate, __global const VTYPE* volatility, const int paths, const uint seed,
+                const int steps, __global VTYPE* partials) {
+    __local VTYPE localSums[WORK_GROUP_SIZE];
+    __local VTYPE localSquares[WORK_GROUP_SIZE];
+
+    int option = get_global_id(1);
+    VTYPE S = spot[option];
+    VTYPE K = strike[option];
+    VTYPE dt = time[option] / steps;
+    VTYPE sigma = volatility[option];
+    VTYPE drift = (rate[option] - (VTYPE)0.5 * sigma * sigma) * dt;
+    VTYPE diffusion = sigma * sqrt(dt);
+    uint2 key = (uint2)(seed, (uint)option);
+
+    VTYPE sum = 0, sumOfSquares = 0;
+    for (int path = get_global_id(0); path < paths; path += get_global_size(0)) {
+        VTYPE price = S;
+        VTYPE average = 0;
+
+        for (int step = 0; step < steps; step += 4) {
+            VTYPE normals[4];
+            BoxMuller(Philox4x32((uint4)((uint)path, (uint)(step / 4), 0, 0), key), normals);
+
+            for (int i = 0; i < 4 && step + i < steps; ++i) {
+                price *= exp(drift + diffusion * normals[i]);
+                average += price;
+            }
+        }
+
+        VTYPE payoff = fmax(average / steps - K, (VTYPE)0);
+        sum += payoff;
+        sumOfSquares += payoff * payoff;
+    }
+
+    StorePartials(sum, sumOfSquares, localSums, localSquares, partials);
+}
+
+// one work-group per option sums the count partial results of the option, results holds sum and sum of squares
+__kernel void ReducePartials(__global const VTYPE* partials, const int count, __global VTYPE* results) {
+    __local VTYPE localSums[WORK_GROUP_SIZE];
+    __local VTYPE localSquares[WORK_GROUP_SIZE];
+
+    __global const VTYPE* optionPartials = partials + 2 * get_global_id(1) * count;
+
+    VTYPE sum = 0, sumOfSquares = 0;
+    for (int i = get_local_id(0); i < count; i += WORK_GROUP_SIZE) {
+        sum += optionPartials[2 * i];
+        sumOfSquares += optionPartials[2 * i + 1];
+    }
+
+    StorePartials(sum, sumOfSquares, localSums, localSquares, results);
+}
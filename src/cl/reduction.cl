@@ -0,0 +1,83 @@
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#elif VTYPE_INT
+#define VTYPE int
+#elif VTYPE_LONG
+#define VTYPE long
+#else
+#error No data type defined.
+#endif
+
+#ifdef SUB_GROUP_FUNCTIONS
+#ifdef cl_khr_subgroups
+#pragma OPENCL EXTENSION cl_khr_subgroups: enable
+#endif
+#endif
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+// All kernels compute one partial sum per work-group: every work-item first adds up the elements
+// i = global id + k * global size (coalesced), then the values of the work-group are combined.
+// A second launch with a single work-group reduces the partial sums.
+
+inline VTYPE GridStrideSum(__global const VTYPE* input, const int n) {
+    VTYPE sum = 0;
+    for (int i = get_global_id(0); i < n; i += get_global_size(0))
+        sum += input[i];
+    return sum;
+}
+
+// tree reduction in local memory, the number of active work-items halves in every step
+__kernel void ReduceLocal(__global const VTYPE* input, __global VTYPE* partials, const int n) {
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    int lid = get_local_id(0);
+
+    scratch[lid] = GridStrideSum(input, n);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = WORK_GROUP_SIZE / 2; offset > 0; offset >>= 1) {
+        if (lid < offset)
+            scratch[lid] += scratch[lid + offset];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (lid == 0)
+        partials[get_group_id(0)] = scratch[0];
+}
+
+#ifdef WORK_GROUP_FUNCTIONS
+// OpenCL 2.0 work-group built-in
+__kernel void ReduceWorkGroup(__global const VTYPE* input, __global VTYPE* partials, const int n) {
+    VTYPE sum = work_group_reduce_add(GridStrideSum(input, n));
+
+    if (get_local_id(0) == 0)
+        partials[get_group_id(0)] = sum;
+}
+#endif
+
+#ifdef SUB_GROUP_FUNCTIONS
+// every sub-group reduces its values without local memory, only the sub-group sums are combined in local memory
+__kernel void ReduceSubGroup(__global const VTYPE* input, __global VTYPE* partials, const int n) {
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+
+    VTYPE sum = sub_group_reduce_add(GridStrideSum(input, n));
+
+    if (get_sub_group_local_id() == 0)
+        scratch[get_sub_group_id()] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (get_local_id(0) == 0) {
+        for (int i = 1; i < get_num_sub_groups(); ++i)
+            sum += scratch[i];
+        partials[get_group_id(0)] = sum;
+    }
+}
+#endif
@@ -0,0 +1,316 @@
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#elif VTYPE_INT
+#define VTYPE int
+#elif VTYPE_LONG
+#define VTYPE long
+#else
+#error No data type defined.
+#endif
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+#ifndef ITEMS_PER_WORK_ITEM
+#define ITEMS_PER_WORK_ITEM 8
+#endif
+
+// every work-group scans one tile, every work-item ITEMS_PER_WORK_ITEM consecutive elements of it
+#define TILE_SIZE (WORK_GROUP_SIZE * ITEMS_PER_WORK_ITEM)
+
+#define FLAG_AGGREGATE 1
+#define FLAG_PREFIX 2
+
+// All scans are inclusive sums. A segmented scan restarts at every element with a head flag.
+
+// Exclusive scan of one value per work-item (Hillis-Steele), total is set to the sum of the work-group.
+inline VTYPE WorkGroupExclusiveScan(VTYPE value, __local VTYPE* scratch, VTYPE* total) {
+    int lid = get_local_id(0);
+
+    scratch[lid] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = 1; offset < WORK_GROUP_SIZE; offset <<= 1) {
+        VTYPE addend = lid >= offset ? scratch[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        scratch[lid] += addend;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    VTYPE exclusive = lid > 0 ? scratch[lid - 1] : 0;
+    *total = scratch[WORK_GROUP_SIZE - 1];
+
+    // scratch may be reused by the caller
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return exclusive;
+}
+
+// Segmented version of WorkGroupExclusiveScan, every value comes with a head flag. The operator is
+// (fa, a) + (fb, b) = (fa | fb, fb ? b : a + b). The exclusive flag tells whether a head precedes the work-item.
+inline VTYPE WorkGroupExclusiveSegmentedScan(VTYPE value, int flag, __local VTYPE* scratch, __local int* flagScratch,
+                int* exclusiveFlag, VTYPE* total, int* totalFlag) {
+    int lid = get_local_id(0);
+
+    scratch[lid] = value;
+    flagScratch[lid] = flag;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = 1; offset < WORK_GROUP_SIZE; offset <<= 1) {
+        VTYPE addend = lid >= offset ? scratch[lid - offset] : 0;
+        int addendFlag = lid >= offset ? flagScratch[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        if (!flagScratch[lid])
+            scratch[lid] += addend;
+        flagScratch[lid] |= addendFlag;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    VTYPE exclusive = lid > 0 ? scratch[lid - 1] : 0;
+    *exclusiveFlag = lid > 0 ? flagScratch[lid - 1] : 0;
+    *total = scratch[WORK_GROUP_SIZE - 1];
+    *totalFlag = flagScratch[WORK_GROUP_SIZE - 1];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return exclusive;
+}
+
+// coalesced load of a tile into local memory, elements beyond n are zero
+inline void LoadTile(__global const VTYPE* input, __local VTYPE* tile, int tileStart, int n) {
+    for (int i = get_local_id(0); i < TILE_SIZE; i += WORK_GROUP_SIZE)
+        tile[i] = tileStart + i < n ? input[tileStart + i] : 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+inline void LoadHeads(__global const uchar* heads, __local int* headTile, int tileStart, int n) {
+    for (int i = get_local_id(0); i < TILE_SIZE; i += WORK_GROUP_SIZE)
+        headTile[i] = tileStart + i < n ? heads[tileStart + i] : 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+inline void StoreTile(__global VTYPE* output, __local VTYPE* tile, int tileStart, int n, VTYPE carry) {
+    for (int i = get_local_id(0); i < TILE_SIZE && tileStart + i < n; i += WORK_GROUP_SIZE)
+        output[tileStart + i] = tile[i] + carry;
+}
+
+// inclusive scan of a tile in local memory, carry is added to every element, returns the sum of the tile (without carry)
+inline VTYPE ScanTile(__local VTYPE* tile, __local VTYPE* scratch, VTYPE carry) {
+    __local VTYPE* items = tile + get_local_id(0) * ITEMS_PER_WORK_ITEM;
+
+    VTYPE sum = 0;
+    for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k)
+        sum += items[k];
+
+    VTYPE total;
+    VTYPE prefix = carry + WorkGroupExclusiveScan(sum, scratch, &total);
+
+    for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k) {
+        prefix += items[k];
+        items[k] = prefix;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    return total;
+}
+
+// segmented inclusive scan of a tile, carry continues the segment of the previous tile until the first head
+inline void SegmentedScanTile(__local VTYPE* tile, __local int* headTile, __local VTYPE* scratch, __local int* flagScratch,
+                VTYPE carry, VTYPE* total, int* totalFlag) {
+    __local VTYPE* items = tile + get_local_id(0) * ITEMS_PER_WORK_ITEM;
+    __local int* itemHeads = headTile + get_local_id(0) * ITEMS_PER_WORK_ITEM;
+
+    VTYPE sum = 0;
+    int flag = 0;
+    for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k) {
+        sum = itemHeads[k] ? items[k] : sum + items[k];
+        flag |= itemHeads[k];
+    }
+
+    int exclusiveFlag;
+    VTYPE prefix = WorkGroupExclusiveSegmentedScan(sum, flag, scratch, flagScratch, &exclusiveFlag, total, totalFlag);
+    if (!exclusiveFlag)
+        prefix += carry;
+
+    for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k) {
+        prefix = itemHeads[k] ? items[k] : prefix + items[k];
+        items[k] = prefix;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Two-pass scan (reduce-then-scan): the tiles are reduced, the tile sums are scanned by a single
+// work-group and the tiles are scanned with the sum of all previous tiles as carry.
+// The input is read twice, the output written once.
+
+__kernel void ScanReduceTiles(__global const VTYPE* input, __global VTYPE* tileSums, const int n) {
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    int tileStart = get_group_id(0) * TILE_SIZE;
+
+    VTYPE sum = 0;
+    for (int i = get_local_id(0); i < TILE_SIZE && tileStart + i < n; i += WORK_GROUP_SIZE)
+        sum += input[tileStart + i];
+
+    VTYPE total;
+    WorkGroupExclusiveScan(sum, scratch, &total);
+
+    if (get_local_id(0) == 0)
+        tileSums[get_group_id(0)] = total;
+}
+
+// inclusive scan of the tile sums in place, launched with a single work-group
+__kernel void ScanTileSums(__global VTYPE* tileSums, const int tileCount) {
+    __local VTYPE tile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+
+    VTYPE carry = 0;
+    for (int tileStart = 0; tileStart < tileCount; tileStart += TILE_SIZE) {
+        LoadTile(tileSums, tile, tileStart, tileCount);
+        ScanTile(tile, scratch, carry);
+        StoreTile(tileSums, tile, tileStart, tileCount, 0);
+
+        carry = tile[TILE_SIZE - 1];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
+
+__kernel void ScanTiles(__global const VTYPE* input, __global VTYPE* output, __global const VTYPE* tileSums, const int n) {
+    __local VTYPE tile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    int tileStart = get_group_id(0) * TILE_SIZE;
+
+    LoadTile(input, tile, tileStart, n);
+    ScanTile(tile, scratch, get_group_id(0) > 0 ? tileSums[get_group_id(0) - 1] : 0);
+    StoreTile(output, tile, tileStart, n, 0);
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Single-pass scan with decoupled look-back: every tile publishes its sum (FLAG_AGGREGATE) as soon as it is known
+// and its inclusive prefix (FLAG_PREFIX) once the look-back over the previous tiles is done. The look-back
+// stops at the first tile with a prefix. The tile ids are assigned in launch order with an atomic counter,
+// so all tiles a work-group waits for have already been started. flags and tileCounter have to be zero.
+// OpenCL 1.2 has no inter work-group memory model, the values are published with volatile stores and fences
+// and the flags are read atomically, which is sufficient on current hardware.
+
+__kernel void ScanSinglePass(__global const VTYPE* input, __global VTYPE* output, volatile __global int* tileCounter,
+                volatile __global int* flags, volatile __global VTYPE* aggregates, volatile __global VTYPE* prefixes, const int n) {
+    __local VTYPE tile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    __local int tileIdLocal;
+    __local VTYPE carryLocal;
+
+    if (get_local_id(0) == 0)
+        tileIdLocal = atomic_inc(tileCounter);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int tileId = tileIdLocal;
+    int tileStart = tileId * TILE_SIZE;
+
+    LoadTile(input, tile, tileStart, n);
+    VTYPE total = ScanTile(tile, scratch, 0);
+
+    if (get_local_id(0) == 0) {
+        VTYPE exclusive = 0;
+
+        if (tileId > 0) {
+            aggregates[tileId] = total;
+            write_mem_fence(CLK_GLOBAL_MEM_FENCE);
+            atomic_xchg(&flags[tileId], FLAG_AGGREGATE);
+
+            for (int predecessor = tileId - 1; ; ) {
+                int flag = atomic_or(&flags[predecessor], 0);
+                read_mem_fence(CLK_GLOBAL_MEM_FENCE);
+
+                if (flag == FLAG_PREFIX) {
+                    exclusive += prefixes[predecessor];
+                    break;
+                } else if (flag == FLAG_AGGREGATE) {
+                    exclusive += aggregates[predecessor];
+                    --predecessor;
+                }
+            }
+        }
+
+        prefixes[tileId] = exclusive + total;
+        write_mem_fence(CLK_GLOBAL_MEM_FENCE);
+        atomic_xchg(&flags[tileId], FLAG_PREFIX);
+
+        carryLocal = exclusive;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    StoreTile(output, tile, tileStart, n, carryLocal);
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Segmented scan, structured like the two-pass scan. Every tile sum carries a flag which tells whether
+// the tile contains a head, the carry of a tile only reaches up to its first head.
+
+__kernel void SegmentedScanReduceTiles(__global const VTYPE* input, __global const uchar* heads,
+                __global VTYPE* tileSums, __global int* tileFlags, const int n) {
+    __local VTYPE tile[TILE_SIZE];
+    __local int headTile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    __local int flagScratch[WORK_GROUP_SIZE];
+    int tileStart = get_group_id(0) * TILE_SIZE;
+
+    LoadTile(input, tile, tileStart, n);
+    LoadHeads(heads, headTile, tileStart, n);
+
+    VTYPE total;
+    int totalFlag;
+    SegmentedScanTile(tile, headTile, scratch, flagScratch, 0, &total, &totalFlag);
+
+    if (get_local_id(0) == 0) {
+        tileSums[get_group_id(0)] = total;
+        tileFlags[get_group_id(0)] = totalFlag;
+    }
+}
+
+// segmented inclusive scan of the tile sums in place, launched with a single work-group
+__kernel void SegmentedScanTileSums(__global VTYPE* tileSums, __global const int* tileFlags, const int tileCount) {
+    __local VTYPE tile[TILE_SIZE];
+    __local int headTile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    __local int flagScratch[WORK_GROUP_SIZE];
+
+    VTYPE carry = 0;
+    for (int tileStart = 0; tileStart < tileCount; tileStart += TILE_SIZE) {
+        LoadTile(tileSums, tile, tileStart, tileCount);
+        for (int i = get_local_id(0); i < TILE_SIZE; i += WORK_GROUP_SIZE)
+            headTile[i] = tileStart + i < tileCount ? tileFlags[tileStart + i] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        VTYPE total;
+        int totalFlag;
+        SegmentedScanTile(tile, headTile, scratch, flagScratch, carry, &total, &totalFlag);
+        StoreTile(tileSums, tile, tileStart, tileCount, 0);
+
+        carry = tile[TILE_SIZE - 1];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
+
+__kernel void SegmentedScanTiles(__global const VTYPE* input, __global const uchar* heads, __global VTYPE* output,
+                __global const VTYPE* tileSums, const int n) {
+    __local VTYPE tile[TILE_SIZE];
+    __local int headTile[TILE_SIZE];
+    __local VTYPE scratch[WORK_GROUP_SIZE];
+    __local int flagScratch[WORK_GROUP_SIZE];
+    int tileStart = get_group_id(0) * TILE_SIZE;
+
+    LoadTile(input, tile, tileStart, n);
+    LoadHeads(heads, headTile, tileStart, n);
+
+    VTYPE total;
+    int totalFlag;
+    SegmentedScanTile(tile, headTile, scratch, flagScratch, get_group_id(0) > 0 ? tileSums[get_group_id(0) - 1] : 0,
+        &total, &totalFlag);
+    StoreTile(output, tile, tileStart, n, 0);
+}
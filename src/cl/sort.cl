@@ -0,0 +1,206 @@
+#if KEY_BITS == 64
+#define KEY ulong
+#else
+#define KEY uint
+#endif
+
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
+
+#ifndef ITEMS_PER_WORK_ITEM
+#define ITEMS_PER_WORK_ITEM 4
+#endif
+
+#ifndef RADIX_BITS
+#define RADIX_BITS 4
+#endif
+
+#define RADIX (1 << RADIX_BITS)
+#define TILE_SIZE (WORK_GROUP_SIZE * ITEMS_PER_WORK_ITEM)
+#define DIGIT(key, shift) ((int)(((key) >> (shift)) & (RADIX - 1)))
+
+// ---------------------------------------------------------------------------------------------------
+// LSD radix sort, RADIX_BITS per pass. Every pass consists of three kernels:
+//   RadixHistogram: every work-group counts the digits of its tile, stored digit-major: counts[digit * groups + group]
+//   RadixScan:      exclusive scan of the counts (single work-group), the global offset of every digit and tile
+//   RadixScatter:   every work-group sorts its tile by the digit in local memory (stable 1-bit splits) and
+//                   writes the runs of equal digits to their offsets
+// If KEY_VALUE is defined the values are moved together with the keys.
+
+// exclusive scan of one value per work-item (Hillis-Steele), total is set to the sum of the work-group
+inline uint WorkGroupExclusiveScan(uint value, __local uint* scratch, uint* total) {
+    int lid = get_local_id(0);
+
+    scratch[lid] = value;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = 1; offset < WORK_GROUP_SIZE; offset <<= 1) {
+        uint addend = lid >= offset ? scratch[lid - offset] : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+        scratch[lid] += addend;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    uint exclusive = lid > 0 ? scratch[lid - 1] : 0;
+    *total = scratch[WORK_GROUP_SIZE - 1];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return exclusive;
+}
+
+__kernel void RadixHistogram(__global const KEY* keys, __global uint* counts, const int n, const int shift) {
+    __local uint localCounts[RADIX];
+    int lid = get_local_id(0);
+    int tileStart = get_group_id(0) * TILE_SIZE;
+
+    if (lid < RADIX)
+        localCounts[lid] = 0;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int i = lid; i < TILE_SIZE && tileStart + i < n; i += WORK_GROUP_SIZE)
+        atomic_inc(&localCounts[DIGIT(keys[tileStart + i], shift)]);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    if (lid < RADIX)
+        counts[lid * get_num_groups(0) + get_group_id(0)] = localCounts[lid];
+}
+
+// launched with a single work-group
+__kernel void RadixScan(__global uint* counts, const int length) {
+    __local uint scratch[WORK_GROUP_SIZE];
+    uint carry = 0;
+
+    for (int start = 0; start < length; start += WORK_GROUP_SIZE) {
+        int i = start + get_local_id(0);
+        uint value = i < length ? counts[i] : 0;
+
+        uint total;
+        uint exclusive = WorkGroupExclusiveScan(value, scratch, &total);
+        if (i < length)
+            counts[i] = carry + exclusive;
+        carry += total;
+    }
+}
+
+__kernel void RadixScatter(__global const KEY* keysIn, __global const uint* valuesIn, __global KEY* keysOut,
+                __global uint* valuesOut, __global const uint* offsets, const int n, const int shift) {
+    __local KEY keys[TILE_SIZE];
+#ifdef KEY_VALUE
+    __local uint values[TILE_SIZE];
+#endif
+    __local uint scratch[WORK_GROUP_SIZE];
+    __local int digitStart[RADIX];
+
+    int lid = get_local_id(0);
+    int tileStart = get_group_id(0) * TILE_SIZE;
+    int validCount = min(TILE_SIZE, n - tileStart);
+
+    // the padding has the largest digit and stays behind the valid keys, the splits are stable
+    for (int i = lid; i < TILE_SIZE; i += WORK_GROUP_SIZE) {
+        keys[i] = i < validCount ? keysIn[tileStart + i] : (KEY)-1;
+#ifdef KEY_VALUE
+        values[i] = i < validCount ? valuesIn[tileStart + i] : 0;
+#endif
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int bit = shift; bit < shift + RADIX_BITS; ++bit) {
+        KEY itemKeys[ITEMS_PER_WORK_ITEM];
+#ifdef KEY_VALUE
+        uint itemValues[ITEMS_PER_WORK_ITEM];
+#endif
+        uint zeros = 0;
+        for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k) {
+            itemKeys[k] = keys[lid * ITEMS_PER_WORK_ITEM + k];
+#ifdef KEY_VALUE
+            itemValues[k] = values[lid * ITEMS_PER_WORK_ITEM + k];
+#endif
+            zeros += ((itemKeys[k] >> bit) & 1) == 0;
+        }
+
+        uint totalZeros;
+        uint zerosBefore = WorkGroupExclusiveScan(zeros, scratch, &totalZeros);
+        uint onesBefore = lid * ITEMS_PER_WORK_ITEM - zerosBefore;
+
+        for (int k = 0; k < ITEMS_PER_WORK_ITEM; ++k) {
+            uint target = ((itemKeys[k] >> bit) & 1) == 0 ? zerosBefore++ : totalZeros + onesBefore++;
+            keys[target] = itemKeys[k];
+#ifdef KEY_VALUE
+            values[target] = itemValues[k];
+#endif
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // the tile is sorted by the digit, find the first element of every run
+    for (int i = lid; i < TILE_SIZE; i += WORK_GROUP_SIZE) {
+        int digit = DIGIT(keys[i], shift);
+        if (i == 0 || DIGIT(keys[i - 1], shift) != digit)
+            digitStart[digit] = i;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int i = lid; i < validCount; i += WORK_GROUP_SIZE) {
+        int digit = DIGIT(keys[i], shift);
+        uint target = offsets[digit * get_num_groups(0) + get_group_id(0)] + i - digitStart[digit];
+        keysOut[target] = keys[i];
+#ifdef KEY_VALUE
+        valuesOut[target] = values[i];
+#endif
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------
+// Bitonic sort of a power of two number of keys. In stage k the sequences of length k are merged,
+// step j compares the elements i and i + j. Blocks of length k are sorted ascending if (i & k) == 0.
+// BitonicGlobal executes one step in global memory, BitonicLocal all steps with j < BITONIC_TILE
+// in local memory (one work-item per compared pair).
+
+#define BITONIC_TILE (2 * WORK_GROUP_SIZE)
+
+inline void CompareAndSwap(KEY* a, KEY* b, bool ascending) {
+    if ((*a > *b) == ascending) {
+        KEY tmp = *a;
+        *a = *b;
+        *b = tmp;
+    }
+}
+
+__kernel void BitonicGlobal(__global KEY* keys, const int j, const int k) {
+    int pair = get_global_id(0);
+    int low = ((pair & ~(j - 1)) << 1) | (pair & (j - 1));
+
+    KEY a = keys[low];
+    KEY b = keys[low + j];
+    CompareAndSwap(&a, &b, (low & k) == 0);
+    keys[low] = a;
+    keys[low + j] = b;
+}
+
+// executes the stages kStart to kEnd, the first stage starts with step jStart, all others with k / 2
+__kernel void BitonicLocal(__global KEY* keys, const int kStart, const int kEnd, const int jStart) {
+    __local KEY tile[BITONIC_TILE];
+    int lid = get_local_id(0);
+    int tileStart = get_group_id(0) * BITONIC_TILE;
+
+    tile[lid] = keys[tileStart + lid];
+    tile[lid + WORK_GROUP_SIZE] = keys[tileStart + lid + WORK_GROUP_SIZE];
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int k = kStart; k <= kEnd; k <<= 1) {
+        for (int j = (k == kStart ? jStart : k / 2); j > 0; j >>= 1) {
+            int low = ((lid & ~(j - 1)) << 1) | (lid & (j - 1));
+
+            KEY a = tile[low];
+            KEY b = tile[low + j];
+            CompareAndSwap(&a, &b, ((tileStart + low) & k) == 0);
+            tile[low] = a;
+            tile[low + j] = b;
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+    }
+
+    keys[tileStart + lid] = tile[lid];
+    keys[tileStart + lid + WORK_GROUP_SIZE] = tile[lid + WORK_GROUP_SIZE];
+}
@@ -34,10 +34,6 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
                 VTYPE wCenter, VTYPE wCardinal, VTYPE wDiagonal) {
     __local VTYPE sh[(LOCAL_ROWS + 2) * (LOCAL_COLUMNS + 2)];
 
-    if ((get_global_id(1) >= (GLOBAL_COLUMNS - 2)) || (get_global_id(0) >= ((GLOBAL_ROWS - 2)/LOCAL_ROWS))) {
-        return;
-    }
-
     // determine our location in the OpenCL coordinate system
     // To match with the row-major ordering used to store the 2D
     // array in both the host and on the device, we use:
@@ -45,8 +41,6 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
     //   dimension 1 == columns
     int gidRow = get_group_id(0);
     int gidCol = get_group_id(1);
-    int gszRow = get_num_groups(0);
-    int gszCol = get_num_groups(1);
     int lidRow = get_local_id(0);
     int lidCol = get_local_id(1);
     int lszRow = LOCAL_ROWS;
@@ -56,17 +50,17 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
     int gRow = ToGlobalRow( gidRow, lszRow, lidRow );
     int gCol = ToGlobalCol( gidCol, lszCol, lidCol );
 
-    // determine pitch of rows (without halo)
-    int nCols = gszCol * lszCol + 2;     // num columns including halo
-    int nPaddedCols = nCols;// + (((nCols % alignment) == 0) ? 0 : (alignment - (nCols % alignment)));
-    int gRowWidth = nPaddedCols - 2;    // remove the halo
+    // logical size of the matrix (without halo), the work-items beyond it only take part in the barrier
+    int gRowWidth = GLOBAL_COLUMNS - 2;
+    int gRowCount = GLOBAL_ROWS - 2;
+    bool validColumn = gCol < gRowWidth;
 
     // Copy my global data item to a shared local buffer.
     // That local buffer is passed to us as a parameter.
     // We assume it is large enough to hold all the data computed by
     // our block, plus a halo of width 1.
     int lRowWidth = lszCol;          // logical, not haloed
-    for( int i = 0; i < (lszRow + 2); i++ )
+    for( int i = 0; validColumn && i < (lszRow + 2) && (gRow - 1 + i) <= gRowCount; i++ )
     {
         int lidx = ToFlatHaloedIdx( lidRow - 1 + i, lidCol, lRowWidth );
         int gidx = ToFlatHaloedIdx( gRow - 1 + i, gCol, gRowWidth );
@@ -74,19 +68,19 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
     }
 
     // Copy the "left" and "right" halo rows into our local memory buffer.
-    // Only two threads are involved (first column and last column).
-    if( lidCol == 0 )
+    // Only two threads are involved (first column and last valid column).
+    if( validColumn && lidCol == 0 )
     {
-        for( int i = 0; i < (lszRow + 2); i++ )
+        for( int i = 0; i < (lszRow + 2) && (gRow - 1 + i) <= gRowCount; i++ )
         {
             int lidx = ToFlatHaloedIdx(lidRow - 1 + i, lidCol - 1, lRowWidth );
             int gidx = ToFlatHaloedIdx(gRow - 1 + i, gCol - 1, gRowWidth );
             sh[lidx] = data[gidx];
         }
     }
-    else if( lidCol == (lszCol - 1) )
+    if( validColumn && (lidCol == (lszCol - 1) || gCol == (gRowWidth - 1)) )
     {
-        for( int i = 0; i < (lszRow + 2); i++ )
+        for( int i = 0; i < (lszRow + 2) && (gRow - 1 + i) <= gRowCount; i++ )
         {
             int lidx = ToFlatHaloedIdx(lidRow - 1 + i, lidCol + 1, lRowWidth );
             int gidx = ToFlatHaloedIdx(gRow - 1 + i, gCol + 1, gRowWidth );
@@ -98,7 +92,7 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
     barrier( CLK_LOCAL_MEM_FENCE );
 
     // do my part of the smoothing operation
-    for( int i = 0; i < lszRow; i++ )
+    for( int i = 0; validColumn && i < lszRow && (gRow + i) < gRowCount; i++ )
     {
         int cidx  = ToFlatHaloedIdx( lidRow     + i, lidCol    , lRowWidth );
         int nidx  = ToFlatHaloedIdx( lidRow - 1 + i, lidCol    , lRowWidth );
@@ -120,3 +114,79 @@ __kernel void StencilKernel( __global VTYPE* data, __global VTYPE* newData, cons
     }
 }
 
+// Temporally blocked version of StencilKernel.
+// Every work-group loads a tile of TB_TILE * TB_TILE cells plus a halo of TB_STEPS cells into
+// local memory and advances it by TB_STEPS time steps before writing the tile back. The region
+// which holds valid values shrinks by one cell per step, the halo cells are computed redundantly.
+#ifdef TB_STEPS
+
+#define TB_EXTENT (TB_TILE + 2 * TB_STEPS)
+
+__kernel void StencilKernelTemporal( __global const VTYPE* data, __global VTYPE* newData,
+                VTYPE wCenter, VTYPE wCardinal, VTYPE wDiagonal) {
+    __local VTYPE tiles[2][TB_EXTENT * TB_EXTENT];
+
+    // global coordinates of the upper left cell of the haloed tile, the tiles cover the matrix without its border
+    int originRow = 1 + get_group_id(0) * TB_TILE - TB_STEPS;
+    int originCol = 1 + get_group_id(1) * TB_TILE - TB_STEPS;
+
+    int lid = get_local_id(0) * get_local_size(1) + get_local_id(1);
+    int lsz = get_local_size(0) * get_local_size(1);
+
+    for( int i = lid; i < TB_EXTENT * TB_EXTENT; i += lsz )
+    {
+        int row = originRow + i / TB_EXTENT;
+        int col = originCol + i % TB_EXTENT;
+        bool inside = row >= 0 && row < GLOBAL_ROWS && col >= 0 && col < GLOBAL_COLUMNS;
+        tiles[0][i] = inside ? data[row * GLOBAL_COLUMNS + col] : (VTYPE)0;
+    }
+
+    barrier( CLK_LOCAL_MEM_FENCE );
+
+    for( int t = 1; t <= TB_STEPS; t++ )
+    {
+        __local VTYPE* src = tiles[(t - 1) & 1];
+        __local VTYPE* dst = tiles[t & 1];
+        int extent = TB_EXTENT - 2 * t;
+
+        for( int i = lid; i < extent * extent; i += lsz )
+        {
+            int lRow = t + i / extent;
+            int lCol = t + i % extent;
+            int row = originRow + lRow;
+            int col = originCol + lCol;
+            int idx = lRow * TB_EXTENT + lCol;
+
+            // the border of the matrix is constant (cells outside of the matrix are never used)
+            if( row <= 0 || row >= (GLOBAL_ROWS - 1) || col <= 0 || col >= (GLOBAL_COLUMNS - 1) )
+            {
+                dst[idx] = src[idx];
+                continue;
+            }
+
+            VTYPE centerValue = src[idx];
+            VTYPE cardinalValueSum = src[idx - TB_EXTENT] + src[idx + TB_EXTENT] + src[idx + 1] + src[idx - 1];
+            VTYPE diagonalValueSum = src[idx - TB_EXTENT + 1] + src[idx + TB_EXTENT + 1] + src[idx - TB_EXTENT - 1] + src[idx + TB_EXTENT - 1];
+
+            dst[idx] = wCenter * centerValue +
+                wCardinal * cardinalValueSum +
+                wDiagonal * diagonalValueSum;
+        }
+
+        barrier( CLK_LOCAL_MEM_FENCE );
+    }
+
+    __local VTYPE* result = tiles[TB_STEPS & 1];
+    for( int i = lid; i < TB_TILE * TB_TILE; i += lsz )
+    {
+        int lRow = TB_STEPS + i / TB_TILE;
+        int lCol = TB_STEPS + i % TB_TILE;
+        int row = originRow + lRow;
+        int col = originCol + lCol;
+
+        if( row < (GLOBAL_ROWS - 1) && col < (GLOBAL_COLUMNS - 1) )
+            newData[row * GLOBAL_COLUMNS + col] = result[lRow * TB_EXTENT + lCol];
+    }
+}
+
+#endif
@@ -0,0 +1,148 @@
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#else
+#error No precision defined.
+#endif
+
+// The grid is stored in x-major order: index = (z * ny + y) * nx + x.
+// All kernels update the interior cells only, the border of the grid is constant.
+// Dimension 0 of the NDRange maps to x, dimension 1 to y (and dimension 2 to z for the naive kernel).
+
+#define TILE_WIDTH (BLOCK_X + 2)
+#define TILE_SIZE ((BLOCK_X + 2) * (BLOCK_Y + 2))
+
+// one work-item per cell, every neighbour is read from global memory
+__kernel void Stencil7Naive(__global const VTYPE* in, __global VTYPE* out,
+                const int nx, const int ny, const int nz,
+                VTYPE wCenter, VTYPE wNeighbor) {
+    int x = get_global_id(0) + 1;
+    int y = get_global_id(1) + 1;
+    int z = get_global_id(2) + 1;
+
+    if (x >= nx - 1 || y >= ny - 1 || z >= nz - 1)
+        return;
+
+    int stride = nx * ny;
+    int idx = (z * ny + y) * nx + x;
+
+    out[idx] = wCenter * in[idx] +
+        wNeighbor * (in[idx - 1] + in[idx + 1] + in[idx - nx] + in[idx + nx] + in[idx - stride] + in[idx + stride]);
+}
+
+// 2.5D blocking: a work-group covers a BLOCK_X x BLOCK_Y column of the grid and streams along z.
+// The z neighbours are kept in registers (below, current, above), the current plane is shared
+// through local memory for the x/y neighbours.
+__kernel void Stencil7Streaming(__global const VTYPE* in, __global VTYPE* out,
+                const int nx, const int ny, const int nz,
+                VTYPE wCenter, VTYPE wNeighbor) {
+    __local VTYPE plane[TILE_SIZE];
+
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int x = get_global_id(0) + 1;
+    int y = get_global_id(1) + 1;
+
+    // work-items outside of the grid load clamped values so that all of them reach the barriers
+    bool inside = x < nx - 1 && y < ny - 1;
+    int stride = nx * ny;
+    int idx = min(y, ny - 1) * nx + min(x, nx - 1);
+    int t = (ly + 1) * TILE_WIDTH + lx + 1;
+
+    VTYPE below = in[idx];
+    VTYPE current = in[idx + stride];
+
+    for (int z = 1; z < nz - 1; ++z) {
+        int cidx = idx + z * stride;
+        VTYPE above = in[cidx + stride];
+
+        // wait until everybody is done with the previous plane
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        plane[t] = current;
+        if (inside && lx == 0)
+            plane[t - 1] = in[cidx - 1];
+        if (inside && (lx == BLOCK_X - 1 || x == nx - 2))
+            plane[t + 1] = in[cidx + 1];
+        if (inside && ly == 0)
+            plane[t - TILE_WIDTH] = in[cidx - nx];
+        if (inside && (ly == BLOCK_Y - 1 || y == ny - 2))
+            plane[t + TILE_WIDTH] = in[cidx + nx];
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (inside) {
+            out[cidx] = wCenter * current +
+                wNeighbor * (plane[t - 1] + plane[t + 1] + plane[t - TILE_WIDTH] + plane[t + TILE_WIDTH] + below + above);
+        }
+
+        below = current;
+        current = above;
+    }
+}
+
+// loads the haloed tile of one plane, cells beyond the grid are set to zero (they are never used)
+inline void LoadTile(__local VTYPE* tile, __global const VTYPE* plane, int x0, int y0, int nx, int ny, int lid, int lsz) {
+    for (int i = lid; i < TILE_SIZE; i += lsz) {
+        int x = x0 + i % TILE_WIDTH;
+        int y = y0 + i / TILE_WIDTH;
+        tile[i] = (x < nx && y < ny) ? plane[y * nx + x] : (VTYPE)0;
+    }
+}
+
+// 2.5D blocking for the 27-point stencil: the three planes z-1, z and z+1 are kept
+// in a ring of local memory tiles, only one new plane is loaded per step.
+__kernel void Stencil27Streaming(__global const VTYPE* in, __global VTYPE* out,
+                const int nx, const int ny, const int nz,
+                VTYPE wCenter, VTYPE wFace, VTYPE wEdge, VTYPE wCorner) {
+    __local VTYPE planes[3 * TILE_SIZE];
+
+    int lx = get_local_id(0);
+    int ly = get_local_id(1);
+    int lid = ly * BLOCK_X + lx;
+    int lsz = BLOCK_X * BLOCK_Y;
+
+    // upper left halo cell of the tile
+    int x0 = get_group_id(0) * BLOCK_X;
+    int y0 = get_group_id(1) * BLOCK_Y;
+    int x = x0 + lx + 1;
+    int y = y0 + ly + 1;
+
+    bool inside = x < nx - 1 && y < ny - 1;
+    int stride = nx * ny;
+    int t = (ly + 1) * TILE_WIDTH + lx + 1;
+
+    LoadTile(planes, in, x0, y0, nx, ny, lid, lsz);
+    LoadTile(planes + TILE_SIZE, in + stride, x0, y0, nx, ny, lid, lsz);
+
+    for (int z = 1; z < nz - 1; ++z) {
+        __local VTYPE* b = planes + ((z - 1) % 3) * TILE_SIZE;
+        __local VTYPE* c = planes + (z % 3) * TILE_SIZE;
+        __local VTYPE* a = planes + ((z + 1) % 3) * TILE_SIZE;
+
+        LoadTile(a, in + (z + 1) * stride, x0, y0, nx, ny, lid, lsz);
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (inside) {
+            const int n = -TILE_WIDTH, s = TILE_WIDTH;
+
+            VTYPE faces = c[t - 1] + c[t + 1] + c[t + n] + c[t + s] + b[t] + a[t];
+            VTYPE edges = c[t + n - 1] + c[t + n + 1] + c[t + s - 1] + c[t + s + 1] +
+                b[t - 1] + b[t + 1] + b[t + n] + b[t + s] +
+                a[t - 1] + a[t + 1] + a[t + n] + a[t + s];
+            VTYPE corners = b[t + n - 1] + b[t + n + 1] + b[t + s - 1] + b[t + s + 1] +
+                a[t + n - 1] + a[t + n + 1] + a[t + s - 1] + a[t + s + 1];
+
+            out[(z * ny + y) * nx + x] = wCenter * c[t] + wFace * faces + wEdge * edges + wCorner * corners;
+        }
+
+        // the oldest plane gets overwritten in the next step
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+}
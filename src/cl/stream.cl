@@ -0,0 +1,54 @@
+#ifdef VTYPE_FLOAT
+#define VTYPE float
+#elif VTYPE_DOUBLE_KHR
+#pragma OPENCL EXTENSION cl_khr_fp64: enable
+#define VTYPE double
+#elif VTYPE_DOUBLE_AMD
+#pragma OPENCL EXTENSION cl_amd_fp64: enable
+#define VTYPE double
+#else
+#error No precision defined.
+#endif
+
+#ifndef VECTOR_WIDTH
+#define VECTOR_WIDTH 1
+#endif
+
+// VTYPEN is the vector type with VECTOR_WIDTH components (e.g. float4), width 1 is the scalar type
+#if VECTOR_WIDTH == 1
+#define VTYPEN VTYPE
+#else
+#define CONCAT(a, b) a ## b
+#define VECTOR_TYPE(type, width) CONCAT(type, width)
+#define VTYPEN VECTOR_TYPE(VTYPE, VECTOR_WIDTH)
+#endif
+
+// The STREAM kernels, n is the number of vectors per array:
+//   copy:  c = a
+//   scale: b = scalar * c
+//   add:   c = a + b
+//   triad: a = b + scalar * c
+//
+// Every operation exists in two variants:
+//   grid-stride: a fixed number of work-items walks over the arrays with a stride of the global size,
+//                consecutive work-items access consecutive elements in every iteration
+//   blocked:     every work-group streams over its own contiguous chunk of the arrays,
+//                the work-items of a group stride through the chunk with the local size
+#define STREAM_KERNELS(NAME, STATEMENT) \
+__kernel void NAME(__global VTYPEN* a, __global VTYPEN* b, __global VTYPEN* c, const VTYPE scalar, const int n) { \
+    for (int i = get_global_id(0); i < n; i += get_global_size(0)) \
+        STATEMENT; \
+} \
+\
+__kernel void NAME##Blocked(__global VTYPEN* a, __global VTYPEN* b, __global VTYPEN* c, const VTYPE scalar, const int n) { \
+    int chunk = (n + get_num_groups(0) - 1) / get_num_groups(0); \
+    int begin = get_group_id(0) * chunk; \
+    int end = min(begin + chunk, n); \
+    for (int i = begin + get_local_id(0); i < end; i += get_local_size(0)) \
+        STATEMENT; \
+}
+
+STREAM_KERNELS(StreamCopy, c[i] = a[i])
+STREAM_KERNELS(StreamScale, b[i] = scalar * c[i])
+STREAM_KERNELS(StreamAdd, c[i] = a[i] + b[i])
+STREAM_KERNELS(StreamTriad, a[i] = b[i] + scalar * c[i])
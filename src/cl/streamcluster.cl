@@ -12,7 +12,9 @@
 #define VTYPE long
 #endif
 
-#define POINT_DIMENSION 3
+#ifndef WORK_GROUP_SIZE
+#define WORK_GROUP_SIZE 256
+#endif
 
 /* ============================================================
 //--cambine: kernel funtion of pgain
@@ -20,53 +22,132 @@
 //--date:   02/03/2011
 ============================================================ */
 
-typedef struct {
-    VTYPE weight;
-    int assign;  /* number of point where this one is assigned */
-    VTYPE cost;  /* cost of that assignment, weight*distance */
-} Point;
+// pgain(x) is split into three kernels:
+//   PGain:        cost of every point if it was assigned to x, the savings are reduced per work-group and center slot
+//   EvaluateGain: sums the partial results of all work-groups, decides which centers are closed and computes the
+//                 cost of opening x (negative if opening x saves)
+//   ApplyGain:    only if x is opened, reassigns the points which are cheaper with x and the points of closed centers
+// The centers are identified by slots, centerTable maps a center (point index) to its slot.
+// The coordinates are stored dimension by dimension (coordinates[d * num + i]).
 
-__kernel void pgain_kernel( __global Point *p, __global VTYPE *coord_d,
-                __global VTYPE * work_mem_d, __global int *center_table_d,
-                __global char *switch_membership_d, int num, long x, int K) {
-    __local VTYPE coord_s[POINT_DIMENSION];
+__kernel void PGain(__global const VTYPE *coordinates, __global const VTYPE *weights, __global const VTYPE *costs,
+                __global const int *assignments, __global const int *centerTable, __global VTYPE *xCosts,
+                __global char *switchMembership, __global VTYPE *partials, __local VTYPE *xCoordinates,
+                int num, int dimension, int x, int slotCount) {
+    __local VTYPE contributions[WORK_GROUP_SIZE];
+    __local int slots[WORK_GROUP_SIZE];
 
-    /* block ID and global thread ID */
     const int thread_id = get_global_id(0);
     const int local_id = get_local_id(0);
 
-    if(thread_id >= num)
-        return;
+    // coordinates of point[x] to local memory
+    for (int d = local_id; d < dimension; d += WORK_GROUP_SIZE)
+        xCoordinates[d] = coordinates[d * num + x];
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    VTYPE contribution = 0;
+    int slot = -1;
+
+    if (thread_id < num) {
+        // cost between this point and point[x]: squared euclidean distance multiplied by weight
+        VTYPE x_cost = 0;
+        for (int d = 0; d < dimension; ++d) {
+            VTYPE difference = coordinates[d * num + thread_id] - xCoordinates[d];
+            x_cost += difference * difference;
+        }
+        x_cost *= weights[thread_id];
+
+        VTYPE current_cost = costs[thread_id];
+        xCosts[thread_id] = x_cost;
 
-     // coordinate mapping of point[x] to shared mem
-    if(local_id == 0) {
-        coord_s[0] = coord_d[x];
-        coord_s[1] = coord_d[num + x];
-        coord_s[2] = coord_d[num + num + x];
+        // if computed cost is less then original (it saves), mark it as to reassign
+        if (x_cost < current_cost) {
+            switchMembership[thread_id] = 1;
+            contribution = x_cost - current_cost;
+            slot = slotCount;
+        }
+        // if computed cost is larger, the difference counts against closing the current center
+        else {
+            switchMembership[thread_id] = 0;
+            contribution = current_cost - x_cost;
+            slot = centerTable[assignments[thread_id]];
+        }
     }
 
+    contributions[local_id] = contribution;
+    slots[local_id] = slot;
     barrier(CLK_LOCAL_MEM_FENCE);
-   
-    // cost between this point and point[x]: euclidean distance multiplied by weight
-    VTYPE x_cost = 0.0;
-    for (int i=0; i<POINT_DIMENSION; i++)
-        x_cost += (coord_d[(i*num)+thread_id]-coord_s[i]) * (coord_d[(i*num)+thread_id]-coord_s[i]);
-    x_cost = x_cost * p[thread_id].weight;
-   
-    VTYPE current_cost = p[thread_id].cost;
-
-    int base = thread_id*(K+1);
-    // if computed cost is less then original (it saves), mark it as to reassign
-    if ( x_cost < current_cost ){
-        switch_membership_d[thread_id] = '1';
-        int addr_1 = base + K;
-        work_mem_d[addr_1] = x_cost - current_cost;
+
+    // every work-item sums the contributions of one slot, all work-items read the same element at the same time
+    for (int s = local_id; s <= slotCount; s += WORK_GROUP_SIZE) {
+        VTYPE sum = 0;
+        for (int j = 0; j < WORK_GROUP_SIZE; ++j)
+            sum += slots[j] == s ? contributions[j] : 0;
+        partials[get_group_id(0) * (slotCount + 1) + s] = sum;
     }
-    // if computed cost is larger, save the difference
-    else {
-        int assign = p[thread_id].assign;
-        int addr_2 = base + center_table_d[assign];
-        work_mem_d[addr_2] += current_cost - x_cost;
+}
+
+// executed by a single work-group, result[0] is the cost of opening x and result[1] the number of closed centers
+__kernel void EvaluateGain(__global const VTYPE *partials, int groups, int slotCount, __global const int *slotCenters,
+                VTYPE z, __global char *closeCenters, __global VTYPE *result) {
+    __local VTYPE closedLower[WORK_GROUP_SIZE];
+    __local int closedCount[WORK_GROUP_SIZE];
+    __local VTYPE switchSaving;
+
+    const int local_id = get_local_id(0);
+
+    VTYPE lowerSum = 0;
+    int count = 0;
+
+    // one column of partials per work-item, consecutive work-items read consecutive slots
+    for (int s = local_id; s <= slotCount; s += WORK_GROUP_SIZE) {
+        VTYPE sum = 0;
+        for (int g = 0; g < groups; ++g)
+            sum += partials[g * (slotCount + 1) + s];
+
+        if (s == slotCount) {
+            switchSaving = sum;
+        } else {
+            // closing the center saves z, its points are moved to x at the accumulated extra cost
+            VTYPE lower = z + sum;
+            char close = slotCenters[s] >= 0 && lower > 0;
+            closeCenters[s] = close;
+            if (close) {
+                lowerSum += lower;
+                ++count;
+            }
+        }
+    }
+
+    closedLower[local_id] = lowerSum;
+    closedCount[local_id] = count;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int offset = WORK_GROUP_SIZE / 2; offset > 0; offset >>= 1) {
+        if (local_id < offset) {
+            closedLower[local_id] += closedLower[local_id + offset];
+            closedCount[local_id] += closedCount[local_id + offset];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (local_id == 0) {
+        result[0] = z + switchSaving - closedLower[0];
+        result[1] = (VTYPE)closedCount[0];
     }
 }
 
+__kernel void ApplyGain(__global VTYPE *costs, __global int *assignments, __global const int *centerTable,
+                __global const VTYPE *xCosts, __global const char *switchMembership,
+                __global const char *closeCenters, int num, int x) {
+    const int thread_id = get_global_id(0);
+
+    if (thread_id >= num)
+        return;
+
+    if (switchMembership[thread_id] || closeCenters[centerTable[assignments[thread_id]]]) {
+        costs[thread_id] = xCosts[thread_id];
+        assignments[thread_id] = x;
+    }
+}
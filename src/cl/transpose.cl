@@ -17,41 +17,173 @@
 #define VTYPE4 long4
 #endif
 
-#define BLOCK_DIMENSION 16
+// edge length of the square tiles
+#ifndef BLOCK_DIMENSION
+#define BLOCK_DIMENSION 32
+#endif
+
+// work-items in dimension 1 of a work-group, every work-item moves BLOCK_DIMENSION / BLOCK_ROWS rows of a tile
+#ifndef BLOCK_ROWS
+#define BLOCK_ROWS 8
+#endif
+
+// additional columns in local memory, the columns of a tile are read in the second step and
+// without padding all elements of a column are in the same local memory bank
+#ifndef PADDING
+#define PADDING 1
+#endif
+
+#define TILE_STRIDE (BLOCK_DIMENSION + PADDING)
+
+// The input is a height x width matrix in row-major order, the output a width x height matrix.
+
+__kernel void
+fill_index(__global VTYPE *destination, ulong n) {
+    size_t i = get_global_id(0);
+    if (i < n)
+        destination[i] = (VTYPE)i;
+}
 
-// based on nvidia sample code
 __kernel void
-transpose_optimized(__global VTYPE  *source, __global VTYPE  *destination, int height, int width){
-    __local VTYPE buffer[BLOCK_DIMENSION * BLOCK_DIMENSION];
+transpose_simple(__global VTYPE  *source, __global VTYPE  *destination, int height, int width) {
+    __private size_t sourceId = get_global_id(0);
 
-    uint columnIndex = get_global_id(0);
-    uint rowIndex = get_global_id(1);
+    if (sourceId >= (size_t)width * height)
+        return;
 
-    if ((columnIndex < width) && (rowIndex < height)) {
-        uint index = rowIndex * width + columnIndex;
-        buffer[get_local_id(1) * BLOCK_DIMENSION + get_local_id(0)] = source[index];
+    __private size_t sourceRow = sourceId / width;
+    __private size_t sourceColumn = sourceId % width;
+
+    destination[sourceColumn * height + sourceRow] = source[sourceId];
+}
+
+// based on nvidia sample code, a work-group of BLOCK_DIMENSION x BLOCK_ROWS work-items transposes one tile
+__kernel void
+transpose_optimized(__global VTYPE  *source, __global VTYPE  *destination, int height, int width) {
+    __local VTYPE buffer[BLOCK_DIMENSION * TILE_STRIDE];
+
+    int localColumn = get_local_id(0);
+    int columnIndex = get_group_id(0) * BLOCK_DIMENSION + localColumn;
+    int firstRow = get_group_id(1) * BLOCK_DIMENSION;
+
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        int rowIndex = firstRow + r;
+        if ((columnIndex < width) && (rowIndex < height))
+            buffer[r * TILE_STRIDE + localColumn] = source[(size_t)rowIndex * width + columnIndex];
     }
 
     barrier(CLK_LOCAL_MEM_FENCE);
 
-    columnIndex = get_group_id(1) * BLOCK_DIMENSION + get_local_id(0);
-    rowIndex = get_group_id(0) * BLOCK_DIMENSION + get_local_id(1);
+    // the rows of the output tile are the columns of the input tile
+    columnIndex = firstRow + localColumn;
+    firstRow = get_group_id(0) * BLOCK_DIMENSION;
 
-    if ((rowIndex < width) && (columnIndex < height)) {
-        uint index = rowIndex * height + columnIndex;
-        destination[index] = buffer[get_local_id(0) * BLOCK_DIMENSION + get_local_id(1)];
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        int rowIndex = firstRow + r;
+        if ((rowIndex < width) && (columnIndex < height))
+            destination[(size_t)rowIndex * height + columnIndex] = buffer[localColumn * TILE_STRIDE + r];
     }
 }
 
+// like transpose_optimized with vector loads and stores, a work-group has BLOCK_DIMENSION / 4 x BLOCK_ROWS work-items
+// width and height have to be multiples of 4
 __kernel void
-transpose_simple(__global VTYPE  *source, __global VTYPE  *destination, int height, int width) {
-    __private uint sourceId = get_global_id(0);
+transpose_vector(__global VTYPE4 *source, __global VTYPE4 *destination, int height, int width) {
+    __local VTYPE buffer[BLOCK_DIMENSION * TILE_STRIDE];
+
+    int localColumn = 4 * get_local_id(0);
+    int columnIndex = get_group_id(0) * BLOCK_DIMENSION + localColumn;
+    int firstRow = get_group_id(1) * BLOCK_DIMENSION;
+
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        int rowIndex = firstRow + r;
+        if ((columnIndex < width) && (rowIndex < height)) {
+            VTYPE4 value = source[((size_t)rowIndex * width + columnIndex) / 4];
+            __local VTYPE *tileRow = buffer + r * TILE_STRIDE + localColumn;
+            tileRow[0] = value.s0;
+            tileRow[1] = value.s1;
+            tileRow[2] = value.s2;
+            tileRow[3] = value.s3;
+        }
+    }
 
-    if (sourceId >= width * height)
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    columnIndex = firstRow + localColumn;
+    firstRow = get_group_id(0) * BLOCK_DIMENSION;
+
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        int rowIndex = firstRow + r;
+        if ((rowIndex < width) && (columnIndex < height)) {
+            __local VTYPE *tileColumn = buffer + localColumn * TILE_STRIDE + r;
+            destination[((size_t)rowIndex * height + columnIndex) / 4] =
+                (VTYPE4)(tileColumn[0], tileColumn[TILE_STRIDE], tileColumn[2 * TILE_STRIDE], tileColumn[3 * TILE_STRIDE]);
+        }
+    }
+}
+
+// In-place transpose of a size x size matrix: the work-group (x, y) with x > y swaps the tiles (y, x) and (x, y)
+// and transposes both of them, the work-groups on the diagonal transpose their tile, the others return.
+__kernel void
+transpose_inplace_square(__global VTYPE *data, int size) {
+    __local VTYPE upper[BLOCK_DIMENSION * TILE_STRIDE];
+    __local VTYPE lower[BLOCK_DIMENSION * TILE_STRIDE];
+
+    int tileX = get_group_id(0);
+    int tileY = get_group_id(1);
+    if (tileX < tileY)
         return;
 
-    __private uint sourceRow = sourceId / width;
-    __private uint sourceColumn = sourceId % width;
+    int localColumn = get_local_id(0);
+    bool diagonal = tileX == tileY;
 
-    destination[sourceColumn * height + sourceRow] = source[sourceId];
+    // upper: rows of tileY, columns of tileX; lower: the mirrored tile
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        int upperRow = tileY * BLOCK_DIMENSION + r;
+        int upperColumn = tileX * BLOCK_DIMENSION + localColumn;
+        if (upperRow < size && upperColumn < size)
+            upper[r * TILE_STRIDE + localColumn] = data[(size_t)upperRow * size + upperColumn];
+
+        int lowerRow = tileX * BLOCK_DIMENSION + r;
+        int lowerColumn = tileY * BLOCK_DIMENSION + localColumn;
+        if (!diagonal && lowerRow < size && lowerColumn < size)
+            lower[r * TILE_STRIDE + localColumn] = data[(size_t)lowerRow * size + lowerColumn];
+    }
+
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int r = get_local_id(1); r < BLOCK_DIMENSION; r += BLOCK_ROWS) {
+        // the transposed upper tile goes to the position of the lower one
+        int lowerRow = tileX * BLOCK_DIMENSION + r;
+        int lowerColumn = tileY * BLOCK_DIMENSION + localColumn;
+        if (lowerRow < size && lowerColumn < size)
+            data[(size_t)lowerRow * size + lowerColumn] = upper[localColumn * TILE_STRIDE + r];
+
+        int upperRow = tileY * BLOCK_DIMENSION + r;
+        int upperColumn = tileX * BLOCK_DIMENSION + localColumn;
+        if (!diagonal && upperRow < size && upperColumn < size)
+            data[(size_t)upperRow * size + upperColumn] = lower[localColumn * TILE_STRIDE + r];
+    }
+}
+
+// In-place transpose of a non-square height x width matrix by following the cycles of the permutation:
+// the element at index i (0 < i < n - 1) moves to (i * height) mod (n - 1), n = width * height.
+// Every work-item moves the elements of one cycle, leaders holds the smallest index of every cycle.
+__kernel void
+transpose_inplace_cycles(__global VTYPE *data, __global const uint *leaders, int cycles, int height, int width) {
+    int cycle = get_global_id(0);
+    if (cycle >= cycles)
+        return;
+
+    ulong modulus = (ulong)width * height - 1;
+    ulong start = leaders[cycle];
+    ulong index = start;
+    VTYPE value = data[index];
+
+    do {
+        index = (index * height) % modulus;
+        VTYPE next = data[index];
+        data[index] = value;
+        value = next;
+    } while (index != start);
 }
@@ -1,6 +1,7 @@
 #include "computecontroller.hpp"
 
 #include <algorithm>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -127,6 +128,13 @@ bool ComputeController::SupportsDoublePrecision() {
     return HasExtension("cl_khr_fp64") || HasExtension("cl_amd_fp64");
 }
 
+bool ComputeController::SupportsOpenCLC20() {
+    // format: "OpenCL C <major>.<minor> <vendor specific information>"
+    string version;
+    _selectedDevice.getInfo(CL_DEVICE_OPENCL_C_VERSION, &version);
+    return version.size() > 9 && version.compare(0, 9, "OpenCL C ") == 0 && atoi(version.c_str() + 9) >= 2;
+}
+
 shared_ptr<cl::Program> ComputeController::BuildCommon(shared_ptr<cl::Program> program, const string& compilerParams) {
     cl_int buildResult = CL_SUCCESS;
     if ((buildResult = program->build(_devices, compilerParams.c_str())) != CL_SUCCESS) {
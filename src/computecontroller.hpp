@@ -79,6 +79,13 @@ public:
      */
     bool SupportsDoublePrecision();
 
+    /**
+     * Checks whether kernels can be compiled with -cl-std=CL2.0 (work-group functions, generic address space).
+     *
+     * @return true if CL_DEVICE_OPENCL_C_VERSION is 2.0 or newer
+     */
+    bool SupportsOpenCLC20();
+
     /**
      * Checks whether the device supports the extension given by the name.
      *
@@ -0,0 +1,222 @@
+#include "imageloader.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const size_t DECODE_CHUNK_BYTES = 4 * 1024 * 1024;
+
+// skips whitespace and comments in the header of a Netpbm file and reads the next number
+static bool ReadHeaderValue(istream& stream, int& value) {
+    char c;
+    while (stream.get(c)) {
+        if (c == '#') {
+            stream.ignore(numeric_limits<streamsize>::max(), '\n');
+        } else if (!isspace(static_cast<unsigned char>(c))) {
+            stream.unget();
+            break;
+        }
+    }
+
+    stream >> value;
+    return !stream.fail() && value > 0;
+}
+
+static string Extension(const string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == string::npos)
+        return "";
+
+    string extension = path.substr(dot + 1);
+    transform(extension.begin(), extension.end(), extension.begin(), [](char c) -> char {
+            return static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        });
+    return extension;
+}
+
+ImageLoader::ImageLoader()
+    : _width(0)
+    , _height(0)
+    , _pixels()
+    , _mappedPixels(nullptr)
+    , _mappedSize(0)
+#ifdef _WIN32
+    , _fileHandle(INVALID_HANDLE_VALUE)
+    , _mappingHandle(nullptr)
+#else
+    , _fileDescriptor(-1)
+#endif
+{
+
+}
+
+ImageLoader::~ImageLoader() {
+    Unmap();
+}
+
+bool ImageLoader::Load(const string& path) {
+    Release();
+
+    // missing files are not reported, the callers fall back to other inputs
+    if (!ifstream(path, ios::in | ios::binary))
+        return false;
+
+    const string extension = Extension(path);
+    if (extension == "pgm" || extension == "ppm")
+        return LoadNetpbm(path);
+    if (extension == "raw")
+        return LoadRaw(path);
+
+    cerr << "Unsupported image format: " << path << endl;
+    return false;
+}
+
+void ImageLoader::Release() {
+    Unmap();
+    _pixels.clear();
+    _pixels.shrink_to_fit();
+    _width = 0;
+    _height = 0;
+}
+
+const float* ImageLoader::Pixels() const {
+    if (_mappedPixels != nullptr)
+        return _mappedPixels;
+    return _pixels.empty() ? nullptr : &_pixels[0];
+}
+
+bool ImageLoader::LoadNetpbm(const string& path) {
+    ifstream stream(path, ios::in | ios::binary);
+
+    string magic;
+    int width = 0, height = 0, maxValue = 0;
+    stream >> magic;
+    if ((magic != "P5" && magic != "P6") || !ReadHeaderValue(stream, width) || !ReadHeaderValue(stream, height)
+            || !ReadHeaderValue(stream, maxValue) || maxValue > 65535) {
+        cerr << "Unsupported or corrupt Netpbm header (only binary P5/P6 are supported): " << path << endl;
+        return false;
+    }
+
+    // exactly one whitespace character separates the header from the pixel data
+    stream.get();
+
+    const int channels = magic == "P6" ? 3 : 1;
+    const int bytesPerSample = maxValue > 255 ? 2 : 1;
+    const size_t rowBytes = static_cast<size_t>(width) * channels * bytesPerSample;
+    const int rowsPerChunk = static_cast<int>(max<size_t>(1, DECODE_CHUNK_BYTES / rowBytes));
+
+    _pixels.resize(static_cast<size_t>(width) * height);
+    vector<unsigned char> chunk(rowsPerChunk * rowBytes);
+
+    // 16 bit samples are stored most significant byte first
+    auto sample = [&](size_t i) -> float {
+        return bytesPerSample == 1 ? chunk[i] : static_cast<float>((chunk[2 * i] << 8) | chunk[2 * i + 1]);
+    };
+
+    for (int y = 0; y < height; y += rowsPerChunk) {
+        const int rows = min(rowsPerChunk, height - y);
+        stream.read(reinterpret_cast<char*>(&chunk[0]), rows * rowBytes);
+        if (static_cast<size_t>(stream.gcount()) != rows * rowBytes) {
+            cerr << "Truncated Netpbm file: " << path << endl;
+            _pixels.clear();
+            return false;
+        }
+
+        float* pixels = &_pixels[static_cast<size_t>(y) * width];
+        const size_t count = static_cast<size_t>(rows) * width;
+        for (size_t i = 0; i < count; ++i) {
+            // luminance according to ITU-R BT.601
+            pixels[i] = channels == 1 ? sample(i)
+                : 0.299f * sample(3 * i) + 0.587f * sample(3 * i + 1) + 0.114f * sample(3 * i + 2);
+        }
+    }
+
+    _width = width;
+    _height = height;
+    return true;
+}
+
+bool ImageLoader::LoadRaw(const string& path) {
+    // <name>_<width>x<height>.raw
+    const size_t separator = path.find_last_of('_');
+    int width = 0, height = 0;
+    if (separator == string::npos || sscanf(path.c_str() + separator + 1, "%dx%d.", &width, &height) != 2
+            || width <= 0 || height <= 0) {
+        cerr << "The size of a raw image has to be part of the file name (e.g. scene_7680x4320.raw): " << path << endl;
+        return false;
+    }
+
+    const size_t expectedSize = static_cast<size_t>(width) * height * sizeof(float);
+    const void* mapping = nullptr;
+    size_t fileSize = 0;
+
+#ifdef _WIN32
+    _fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (_fileHandle != INVALID_HANDLE_VALUE && GetFileSizeEx(_fileHandle, &size)) {
+        fileSize = static_cast<size_t>(size.QuadPart);
+        _mappingHandle = CreateFileMappingA(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mappingHandle != nullptr)
+            mapping = MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    }
+#else
+    _fileDescriptor = open(path.c_str(), O_RDONLY);
+    struct stat fileStatus;
+    if (_fileDescriptor >= 0 && fstat(_fileDescriptor, &fileStatus) == 0) {
+        fileSize = static_cast<size_t>(fileStatus.st_size);
+        void* address = fileSize > 0 ? mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, _fileDescriptor, 0) : MAP_FAILED;
+        if (address != MAP_FAILED)
+            mapping = address;
+    }
+#endif
+
+    _mappedPixels = static_cast<const float*>(mapping);
+    _mappedSize = fileSize;
+
+    if (mapping == nullptr || fileSize != expectedSize) {
+        cerr << "Failed to map the raw image or its size does not match " << width << "x" << height << " floats: " << path << endl;
+        Unmap();
+        return false;
+    }
+
+    _width = width;
+    _height = height;
+    return true;
+}
+
+void ImageLoader::Unmap() {
+#ifdef _WIN32
+    if (_mappedPixels != nullptr)
+        UnmapViewOfFile(_mappedPixels);
+    if (_mappingHandle != nullptr)
+        CloseHandle(_mappingHandle);
+    if (_fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(_fileHandle);
+    _mappingHandle = nullptr;
+    _fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (_mappedPixels != nullptr)
+        munmap(const_cast<float*>(_mappedPixels), _mappedSize);
+    if (_fileDescriptor >= 0)
+        close(_fileDescriptor);
+    _fileDescriptor = -1;
+#endif
+    _mappedPixels = nullptr;
+    _mappedSize = 0;
+}
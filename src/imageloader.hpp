@@ -0,0 +1,66 @@
+#ifndef __BENCH_IMAGELOADER_HPP
+#define __BENCH_IMAGELOADER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/**
+ * Loads grayscale images with float pixels, color images are converted to luminance.
+ * Supported formats (selected by the file extension):
+ *   - .pgm/.ppm: binary Netpbm (P5/P6) with 8 or 16 bit samples. The pixel data is decoded in chunks of rows
+ *     while it is read, only one chunk of encoded data is held in memory besides the result.
+ *   - .raw: 32 bit floats in host byte order without header, the size is part of the file name
+ *     (e.g. scene_7680x4320.raw). The file is memory mapped and used in place.
+ * The pixel values are the samples (0 to maxval), they are not normalized.
+ */
+class ImageLoader {
+private:
+    int _width;
+    int _height;
+    std::vector<float> _pixels;
+
+    // memory mapped raw image
+    const float* _mappedPixels;
+    size_t _mappedSize;
+#ifdef _WIN32
+    void* _fileHandle;
+    void* _mappingHandle;
+#else
+    int _fileDescriptor;
+#endif
+
+    bool LoadNetpbm(const std::string& path);
+    bool LoadRaw(const std::string& path);
+    void Unmap();
+
+public:
+    explicit ImageLoader();
+    virtual ~ImageLoader();
+
+    /**
+     * Loads an image, a previously loaded image is released.
+     *
+     * @return false if the file does not exist or can not be loaded (the reason is printed to cerr,
+     *         missing files are not reported)
+     */
+    bool Load(const std::string& path);
+
+    /**
+     * Frees the pixels or unmaps the file.
+     */
+    void Release();
+
+    int Width() const { return _width; }
+    int Height() const { return _height; }
+
+    /**
+     * @return Width() * Height() pixels row by row, valid until the next Load() or the destruction of the loader
+     */
+    const float* Pixels() const;
+
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+};
+
+#endif // __BENCH_IMAGELOADER_HPP